@@ -8,6 +8,9 @@
 #include "CollisionQueryParams.h"
 #include "WorldCollision.h"
 #include "Engine/World.h"
+#include "CameraStats.h"
+#include "CameraProject.h"
+#include "CameraCharacter/CameraArmSubsystem.h"
 
 // Sets default values for this component's properties
 UCameraArmComponent::UCameraArmComponent()
@@ -15,7 +18,7 @@ UCameraArmComponent::UCameraArmComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	PrimaryComponentTick.TickGroup = CameraTickGroup;
 
 	bAutoActivate = true;
 
@@ -33,9 +36,20 @@ void UCameraArmComponent::BeginPlay()
 
 	OurOwner = GetOwner();
 
+	CameraQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(CameraArm), false, OurOwner);
+
 	OurCamera = Cast<UCameraComponent>(GetChildComponent(0)); //Cast<UCameraComponent>(GetChildComponent(0));
+
+	// Arms added in Blueprint still exist on dedicated servers, where there's no camera to place
+	if (!OurCamera || GetNetMode() == NM_DedicatedServer)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
 	OurCamera->RegisterComponent();
 
+	AddCameraTickPrerequisites(PrimaryComponentTick, OurOwner);
+
 	DesiredLocalLocation = GetComponentLocation() - OurOwner->GetActorLocation();
 	DesiredLocalRotation = GetComponentRotation() - OurOwner->GetActorRotation();
 
@@ -49,7 +63,7 @@ void UCameraArmComponent::TickComponent(float DeltaTime, ELevelTick TickType, FA
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-
+	FCameraBudgetScope BudgetScope(this);
 	PositionOurCamera();
 
 
@@ -78,27 +92,14 @@ void UCameraArmComponent::PositionOurCamera()
 	//if (bDoTrace && (TargetArmLength != 0.0f))
 	//{
 		//bIsCameraFixed = true;
-		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SpringArm), false, GetOwner());
-
-		FCollisionQueryParams CameraQueryParams;
+		{
+			CAMERA_STAGE_SCOPE(Collision);
 
-		CameraQueryParams.AddIgnoredActor(GetOwner());
-		CameraQueryParams.bTraceComplex = false;
-
-		FHitResult CameraHitResult;
-
-		FHitResult SweepResult;
-
-		GetWorld()->LineTraceSingleByChannel(CameraHitResult, GetComponentLocation(), DesiredCameraLocation, ECollisionChannel::ECC_Camera, CameraQueryParams);
-
-		GetWorld()->SweepSingleByChannel(SweepResult, GetComponentLocation(), DesiredCameraLocation, FQuat::Identity, ECollisionChannel::ECC_Camera, FCollisionShape::MakeSphere(12), CameraQueryParams);
+			GetWorld()->LineTraceSingleByChannel(CameraHitResult, GetComponentLocation(), DesiredCameraLocation, ECollisionChannel::ECC_Camera, CameraQueryParams);
+		}
 
 		//FVector DesiredLocalOffset = CameraHitResult. - GetComponentLocation();
 
-		DrawDebugSphere(GetWorld(), SweepResult.TraceStart, 40, 16, FColor(0, 255, 0), false, -1, 0, 10);
-		DrawDebugSphere(GetWorld(), SweepResult.TraceEnd, 50, 12, FColor(255, 0, 0), false, -1, 0, 10);
-		DrawDebugSphere(GetWorld(), SweepResult.ImpactPoint, 60, 8, FColor(0, 0, 255), false, -1, 0, 10);
-
 		OurCamera->SetWorldLocation(CameraHitResult.TraceEnd);
 
 		//ResultLoc = BlendLocations(DesiredLoc, Result.Location, Result.bBlockingHit, DeltaTime);
@@ -111,11 +112,19 @@ void UCameraArmComponent::PositionOurCamera()
 
 
 
-	UE_LOG(LogTemp, Warning, TEXT("%s"), *DesiredCameraLocation.ToString());
-	UE_LOG(LogTemp, Error, TEXT("%s"), *OurCamera->GetComponentLocation().ToString());
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	if (bDrawDebugTrace)
+	{
+		GetWorld()->SweepSingleByChannel(SweepResult, GetComponentLocation(), DesiredCameraLocation, FQuat::Identity, ECollisionChannel::ECC_Camera, FCollisionShape::MakeSphere(12), CameraQueryParams);
+
+		DrawDebugSphere(GetWorld(), SweepResult.TraceStart, 40, 16, FColor(0, 255, 0), false, -1, 0, 10);
+		DrawDebugSphere(GetWorld(), SweepResult.TraceEnd, 50, 12, FColor(255, 0, 0), false, -1, 0, 10);
+		DrawDebugSphere(GetWorld(), SweepResult.ImpactPoint, 60, 8, FColor(0, 0, 255), false, -1, 0, 10);
 
-	DrawDebugLine(GetWorld(), GetComponentLocation(), DesiredCameraLocation, FColor(255, 0, 0), false, -1, 0, 10);
-	DrawDebugLine(GetWorld(), GetComponentLocation(), CameraHitResult.Location, FColor(0, 0, 255), false, -1, 0, 10);
+		DrawDebugLine(GetWorld(), GetComponentLocation(), DesiredCameraLocation, FColor(255, 0, 0), false, -1, 0, 10);
+		DrawDebugLine(GetWorld(), GetComponentLocation(), CameraHitResult.Location, FColor(0, 0, 255), false, -1, 0, 10);
+	}
+#endif
 	//DrawDebugLine(GetWorld(), GetComponentLocation(), CameraHitResult.ImpactPoint, FColor(0, 255, 0), false, -1, 0, 10);
 
 
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
 #include "Camera/CameraComponent.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
 #include "CameraArmComponent.generated.h"
 
 
@@ -33,6 +35,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (AllowPrivateAccess = "true"))
 		float DesiredCameraDistance = 200;
 
+	/** Draws the camera trace and probe sweep every frame. The sweep is only run for this. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+		bool bDrawDebugTrace = false;
+
 private:
 	UCameraComponent* OurCamera;
 
@@ -42,5 +48,10 @@ private:
 
 	FVector DesiredLocalLocation;
 	FRotator DesiredLocalRotation;
+
+	// Kept between frames so positioning the camera doesn't allocate
+	FCollisionQueryParams CameraQueryParams;
+	FHitResult CameraHitResult;
+	FHitResult SweepResult;
 		
 };
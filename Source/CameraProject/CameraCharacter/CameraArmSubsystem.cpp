@@ -0,0 +1,428 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraArmSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "CameraProject.h"
+#include "GameFramework/PlayerController.h"
+#include "CameraCollisionProxy.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraArm, Log, All);
+
+static TAutoConsoleVariable<int32> CVarCameraParallelUpdate(
+	TEXT("Camera.ParallelUpdate"),
+	0,
+	TEXT("0: every spring arm updates in its own component tick.\n")
+	TEXT("1: spring arms are solved together across worker threads and committed on the game thread.\n")
+	TEXT("2: every stage of every spring arm is its own task, scheduled by its dependencies so stages of different arms overlap."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCameraParallelWorkers(
+	TEXT("Camera.ParallelWorkers"),
+	0,
+	TEXT("Number of chunks the parallel camera update is split into. 0 uses every task graph worker plus the game thread."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCameraBudgetMs(
+	TEXT("Camera.BudgetMs"),
+	0.f,
+	TEXT("Milliseconds per frame all camera work should fit in. Over it, arms drop lag substeps, then reuse collision results, ")
+	TEXT("then update arms nobody is viewing through less often, and get quality back once there is room again. 0 disables."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCameraStaleTransformCheck(
+	TEXT("Camera.StaleTransformCheck"),
+	1,
+	TEXT("Warns once for each spring arm whose owner moved after the arm updated in the same frame, which leaves its view a frame behind."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCameraCollisionProxies(
+	TEXT("Camera.CollisionProxies"),
+	1,
+	TEXT("0: camera probes sweep the level's own collision.\n")
+	TEXT("1: in levels with generated camera collision proxies, the proxies block ECC_Camera in place of the static meshes they cover. ")
+	TEXT("Other levels, landscape, BSP and movable geometry keep blocking it themselves."),
+	ECVF_Default);
+
+FCameraBudgetScope::FCameraBudgetScope(const UObject* WorldContext)
+	: ArmSubsystem(nullptr)
+	, StartTime(FPlatformTime::Seconds())
+{
+	const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	if (World && World->IsGameWorld())
+	{
+		ArmSubsystem = World->GetSubsystem<UCameraArmSubsystem>();
+	}
+}
+
+FCameraBudgetScope::~FCameraBudgetScope()
+{
+	if (ArmSubsystem)
+	{
+		ArmSubsystem->AddFrameCost(FPlatformTime::Seconds() - StartTime);
+	}
+}
+
+void FCameraArmBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Subsystem->TickBatch(DeltaTime);
+	}
+}
+
+FString FCameraArmBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FCameraArmBatchTickFunction");
+}
+
+bool UCameraArmSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return ShouldCreateCameraComponents();
+}
+
+void UCameraArmSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCameraArmSubsystem::OnWorldPostActorTick);
+}
+
+void UCameraArmSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+	Arms.Reset();
+	ArmsWithSuspendedTick.Reset();
+	CollisionProxies.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCameraArmSubsystem::RegisterArm(UCameraSpringArm* Arm)
+{
+	if (!BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.Subsystem = this;
+		BatchTickFunction.bCanEverTick = true;
+		BatchTickFunction.TickGroup = CameraTickGroup;
+		BatchTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+	}
+
+	// The batch reads every arm's owner, so it has to wait for all of them to move
+	AddCameraTickPrerequisites(BatchTickFunction, Arm->GetOwner());
+
+	// An arm registered while the batch runs waits for the next frame, since UpdatingArms was already copied
+	Arms.AddUnique(Arm);
+	if (IsBatching())
+	{
+		SuspendArmTick(Arm);
+	}
+}
+
+void UCameraArmSubsystem::UnregisterArm(UCameraSpringArm* Arm)
+{
+	Arms.RemoveSingleSwap(Arm);
+	RestoreArmTick(Arm);
+
+	// Arms later in the batch than the one running may still go away; their slot is skipped from then on
+	if (bUpdatingArms)
+	{
+		const int32 UpdateIndex = UpdatingArms.IndexOfByKey(Arm);
+		if (UpdateIndex != INDEX_NONE)
+		{
+			UpdatingArms[UpdateIndex] = nullptr;
+			ArmActive[UpdateIndex] = false;
+		}
+	}
+
+	// Other arms on the same owner still need the prerequisites removing this arm's took away
+	AActor* Owner = Arm->GetOwner();
+	RemoveCameraTickPrerequisites(BatchTickFunction, Owner);
+	if (Arms.ContainsByPredicate([Owner](const UCameraSpringArm* Other) { return Other->GetOwner() == Owner; }))
+	{
+		AddCameraTickPrerequisites(BatchTickFunction, Owner);
+	}
+}
+
+int32 UCameraArmSubsystem::GetNumWorkers()
+{
+	const int32 RequestedWorkers = CVarCameraParallelWorkers.GetValueOnGameThread();
+	return RequestedWorkers > 0 ? RequestedWorkers : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+}
+
+void UCameraArmSubsystem::TickBatch(float DeltaTime)
+{
+	const ECameraArmUpdateMode WantedMode = (ECameraArmUpdateMode)FMath::Clamp(CVarCameraParallelUpdate.GetValueOnGameThread(), 0, (int32)ECameraArmUpdateMode::Pipelined);
+	if (WantedMode != UpdateMode)
+	{
+		SetUpdateMode(WantedMode);
+	}
+
+	switch (UpdateMode)
+	{
+	case ECameraArmUpdateMode::ParallelFor:	UpdateArms(DeltaTime); break;
+	case ECameraArmUpdateMode::Pipelined:	UpdateArmsPipelined(DeltaTime); break;
+	default: break;
+	}
+}
+
+void UCameraArmSubsystem::SetUpdateMode(ECameraArmUpdateMode NewMode)
+{
+	UpdateMode = NewMode;
+	for (UCameraSpringArm* Arm : Arms)
+	{
+		if (IsBatching())
+		{
+			SuspendArmTick(Arm);
+		}
+		else
+		{
+			RestoreArmTick(Arm);
+		}
+	}
+}
+
+void UCameraArmSubsystem::SuspendArmTick(UCameraSpringArm* Arm)
+{
+	// Arms whose tick was already off were switched off on purpose, and neither tick nor batch them
+	if (Arm->IsComponentTickEnabled())
+	{
+		Arm->SetComponentTickEnabled(false);
+		ArmsWithSuspendedTick.Add(Arm);
+	}
+}
+
+void UCameraArmSubsystem::RestoreArmTick(UCameraSpringArm* Arm)
+{
+	if (ArmsWithSuspendedTick.Remove(Arm) > 0)
+	{
+		Arm->SetComponentTickEnabled(true);
+	}
+}
+
+void UCameraArmSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld()) { return; }
+
+	const bool bUseCollisionProxies = CVarCameraCollisionProxies.GetValueOnGameThread() != 0;
+	for (ACameraCollisionProxy* Proxy : CollisionProxies)
+	{
+		Proxy->SetProxiesActive(bUseCollisionProxies);
+	}
+
+	{
+		// The direct view component is placed from the committed pose and moved only when read; anything else
+		// attached to the arm may be read by code that doesn't know to flush, so it catches up once a frame
+		FCameraBudgetScope BudgetScope(this);
+		for (UCameraSpringArm* Arm : Arms)
+		{
+			if (Arm->HasChildrenBesideDirectView())
+			{
+				Arm->FlushChildTransforms();
+			}
+		}
+	}
+
+	BudgetGovernor.EndFrame(CVarCameraBudgetMs.GetValueOnGameThread());
+
+	if (CVarCameraStaleTransformCheck.GetValueOnGameThread() != 0)
+	{
+		CheckStaleTransforms();
+	}
+
+	ViewTargets.Reset();
+	if (BudgetGovernor.GetLevel() >= ECameraBudgetLevel::ThrottleArms)
+	{
+		for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		{
+			const APlayerController* PlayerController = Iterator->Get();
+			if (PlayerController && PlayerController->IsLocalController())
+			{
+				ViewTargets.AddUnique(PlayerController->GetViewTarget());
+			}
+		}
+	}
+}
+
+void UCameraArmSubsystem::CheckStaleTransforms()
+{
+	for (const UCameraSpringArm* Arm : Arms)
+	{
+		if (!Arm->ReadStaleTransform()) { continue; }
+
+		INC_DWORD_STAT(STAT_CameraStaleReads);
+
+		bool bAlreadyReported = false;
+		StaleArmsReported.Add(FObjectKey(Arm), &bAlreadyReported);
+		if (!bAlreadyReported)
+		{
+			UE_LOG(LogCameraArm, Warning, TEXT("%s updated before its owner %s finished moving this frame; something moves the owner after the camera phase"),
+				*Arm->GetPathName(), *GetNameSafe(Arm->GetOwner()));
+		}
+	}
+}
+
+bool UCameraArmSubsystem::ShouldThrottle(const AActor* Owner, uint32 StaggerKey) const
+{
+	if (BudgetGovernor.GetLevel() < ECameraBudgetLevel::ThrottleArms || ViewTargets.Contains(Owner)) { return false; }
+
+	// Stagger the arms so a similar number of them update every frame
+	return (GFrameCounter + StaggerKey) % FCameraBudgetGovernor::ThrottleInterval != 0;
+}
+
+void UCameraArmSubsystem::RegisterCollisionProxy(ACameraCollisionProxy* Proxy)
+{
+	CollisionProxies.AddUnique(Proxy);
+	Proxy->SetProxiesActive(CVarCameraCollisionProxies.GetValueOnGameThread() != 0);
+}
+
+void UCameraArmSubsystem::UnregisterCollisionProxy(ACameraCollisionProxy* Proxy)
+{
+	CollisionProxies.RemoveSingleSwap(Proxy, false);
+}
+
+int32 UCameraArmSubsystem::BeginUpdate(float DeltaTime)
+{
+	check(!bUpdatingArms);
+	bUpdatingArms = true;
+
+	UpdatingArms = Arms;
+	const int32 NumArms = UpdatingArms.Num();
+
+	Frames.SetNum(NumArms, false);
+	ArmActive.SetNum(NumArms, false);
+	ArmDeltaTimes.SetNum(NumArms, false);
+	for (int32 ArmIndex = 0; ArmIndex < NumArms; ++ArmIndex)
+	{
+		UCameraSpringArm* Arm = UpdatingArms[ArmIndex];
+		ArmDeltaTimes[ArmIndex] = DeltaTime;
+		ArmActive[ArmIndex] = ArmsWithSuspendedTick.Contains(Arm) && Arm->IsActive() && !Arm->SkipForBudget(ArmDeltaTimes[ArmIndex]);
+	}
+
+	return NumArms;
+}
+
+void UCameraArmSubsystem::EndUpdate()
+{
+	bUpdatingArms = false;
+	UpdatingArms.Reset();
+}
+
+void UCameraArmSubsystem::UpdateArms(float DeltaTime)
+{
+	CAMERA_FRAME_SCOPE();
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumArms = BeginUpdate(DeltaTime);
+	if (NumArms == 0)
+	{
+		EndUpdate();
+		LastUpdateSeconds = 0.0;
+		return;
+	}
+
+	// Owners change arm inputs in here, so it has to finish on the game thread before any arm is solved
+	for (int32 ArmIndex = 0; ArmIndex < NumArms; ++ArmIndex)
+	{
+		if (ArmActive[ArmIndex])
+		{
+			UpdatingArms[ArmIndex]->PrepareFrame(ArmDeltaTimes[ArmIndex]);
+		}
+	}
+
+	// Split into one contiguous chunk per worker rather than one task per arm, so the worker count caps the parallelism
+	const int32 NumChunks = FMath::Clamp(GetNumWorkers(), 1, NumArms);
+	const int32 ArmsPerChunk = FMath::DivideAndRoundUp(NumArms, NumChunks);
+
+	ParallelFor(NumChunks, [this, NumArms, ArmsPerChunk](int32 ChunkIndex)
+	{
+		const int32 FirstArm = ChunkIndex * ArmsPerChunk;
+		const int32 LastArm = FMath::Min(FirstArm + ArmsPerChunk, NumArms);
+		for (int32 ArmIndex = FirstArm; ArmIndex < LastArm; ++ArmIndex)
+		{
+			if (ArmActive[ArmIndex])
+			{
+				UpdatingArms[ArmIndex]->SolveFrame(Frames[ArmIndex], ArmDeltaTimes[ArmIndex]);
+			}
+		}
+	}, NumChunks == 1);
+
+	// Moving the children touches the scene graph, so that part stays on the game thread
+	for (int32 ArmIndex = 0; ArmIndex < NumArms; ++ArmIndex)
+	{
+		if (ArmActive[ArmIndex])
+		{
+			UpdatingArms[ArmIndex]->CommitFrame(Frames[ArmIndex]);
+		}
+	}
+
+	EndUpdate();
+	LastUpdateSeconds = FPlatformTime::Seconds() - StartTime;
+	BudgetGovernor.AddCost(LastUpdateSeconds);
+}
+
+void UCameraArmSubsystem::UpdateArmsPipelined(float DeltaTime)
+{
+	CAMERA_FRAME_SCOPE();
+	const double StartTime = FPlatformTime::Seconds();
+
+	const int32 NumArms = BeginUpdate(DeltaTime);
+	ResolveEvents.Reset();
+	ResolveEvents.SetNum(NumArms);
+
+	// Frames must not move once tasks hold pointers into it, which BeginUpdate guarantees by sizing it up front
+	for (int32 ArmIndex = 0; ArmIndex < NumArms; ++ArmIndex)
+	{
+		if (!ArmActive[ArmIndex]) { continue; }
+
+		UCameraSpringArm* Arm = UpdatingArms[ArmIndex];
+		FCameraArmFrame* Frame = &Frames[ArmIndex];
+
+		// Gather on the game thread, since preparing the frame runs owner code that moves the arm
+		Arm->PrepareFrame(ArmDeltaTimes[ArmIndex]);
+		if (!ArmActive[ArmIndex]) { continue; }
+
+		Arm->GatherRigFrame(*Frame, ArmDeltaTimes[ArmIndex]);
+
+		const FGraphEventRef LagEvent = FFunctionGraphTask::CreateAndDispatchWhenReady(
+			[Arm, Frame]() { Arm->SolveFrameLag(*Frame); },
+			TStatId(), nullptr, ENamedThreads::AnyHiPriThreadNormalTask);
+
+		const FGraphEventArray CollisionPrerequisites = { LagEvent };
+		const FGraphEventRef CollisionEvent = FFunctionGraphTask::CreateAndDispatchWhenReady(
+			[Arm, Frame]() { Arm->QueryFrameCollision(*Frame); },
+			TStatId(), &CollisionPrerequisites, ENamedThreads::AnyHiPriThreadNormalTask);
+
+		const FGraphEventArray ResolvePrerequisites = { CollisionEvent };
+		ResolveEvents[ArmIndex] = FFunctionGraphTask::CreateAndDispatchWhenReady(
+			[Arm, Frame]() { Arm->ResolveFrame(*Frame); },
+			TStatId(), &ResolvePrerequisites, ENamedThreads::AnyHiPriThreadNormalTask);
+	}
+
+	// Commit in order; later arms keep running on the workers while earlier ones are committed.
+	// Arms unregistered since their tasks were dispatched are still waited for, just not committed.
+	for (int32 ArmIndex = 0; ArmIndex < NumArms; ++ArmIndex)
+	{
+		if (!ResolveEvents[ArmIndex].IsValid()) { continue; }
+
+		FTaskGraphInterface::Get().WaitUntilTaskCompletes(ResolveEvents[ArmIndex], ENamedThreads::GameThread);
+		if (ArmActive[ArmIndex])
+		{
+			UpdatingArms[ArmIndex]->CommitFrame(Frames[ArmIndex]);
+		}
+	}
+
+	ResolveEvents.Reset();
+	EndUpdate();
+	LastUpdateSeconds = FPlatformTime::Seconds() - StartTime;
+	BudgetGovernor.AddCost(LastUpdateSeconds);
+}
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CameraSpringArm.h"
+#include "CameraBudgetGovernor.h"
+#include "UObject/ObjectKey.h"
+#include "CameraArmSubsystem.generated.h"
+
+class UCameraArmSubsystem;
+class AActor;
+class ACameraCollisionProxy;
+
+/** Tick function running the batched update of every spring arm in a world */
+USTRUCT()
+struct FCameraArmBatchTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UCameraArmSubsystem* Subsystem = nullptr;
+
+	// FTickFunction interface
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	// End of FTickFunction interface
+};
+
+template<>
+struct TStructOpsTypeTraits<FCameraArmBatchTickFunction> : public TStructOpsTypeTraitsBase2<FCameraArmBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+
+/**
+ * Charges the game thread time spent in its scope to the camera budget of WorldContext's world, for camera work that
+ * doesn't run inside a spring arm update. Does nothing in worlds without a UCameraArmSubsystem.
+ */
+struct CAMERAPROJECT_API FCameraBudgetScope
+{
+	explicit FCameraBudgetScope(const UObject* WorldContext);
+	~FCameraBudgetScope();
+
+private:
+	UCameraArmSubsystem* ArmSubsystem;
+	double StartTime;
+};
+
+
+/** How the spring arms of a world are updated, from Camera.ParallelUpdate */
+enum class ECameraArmUpdateMode : uint8
+{
+	/** Each arm runs every stage in its own component tick */
+	PerComponent,
+	/** Arms are solved together with ParallelFor, then committed on the game thread */
+	ParallelFor,
+	/** Each arm's stages are tasks chained by their dependencies, so stages of different arms overlap */
+	Pipelined,
+};
+
+
+/**
+ * Keeps track of the spring arms in a game world. With Camera.ParallelUpdate set, the arms stop ticking themselves
+ * and are updated here as one batch: everything up to the commit is solved for many arms at once on worker threads,
+ * then each arm commits its socket transform back on the game thread.
+ *
+ * Also keeps all camera work within Camera.BudgetMs: arms charge what their updates cost, including owner delegates and
+ * group framing run from PrepareFrame, and other camera work charges itself through FCameraBudgetScope. At the end of
+ * every frame the budget governor decides how much quality the arms give up next frame.
+ */
+UCLASS()
+class CAMERAPROJECT_API UCameraArmSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	void RegisterArm(UCameraSpringArm* Arm);
+	void UnregisterArm(UCameraSpringArm* Arm);
+
+	/** Is the batch currently driving the registered arms instead of their own ticks? */
+	bool IsBatching() const { return UpdateMode != ECameraArmUpdateMode::PerComponent; }
+
+	ECameraArmUpdateMode GetUpdateMode() const { return UpdateMode; }
+
+	/** Solves every active arm across GetNumWorkers() chunks, then commits them all on the game thread */
+	void UpdateArms(float DeltaTime);
+
+	/**
+	 * Runs each arm as a chain of tasks: gather on the game thread, then solve lag, query collision and resolve
+	 * on workers, each waiting only on the previous stage of the same arm. The game thread keeps gathering the
+	 * next arms while earlier ones sweep, and commits each arm as soon as its chain finishes.
+	 */
+	void UpdateArmsPipelined(float DeltaTime);
+
+	/** Seconds the last batched update took, used by the stress benchmarks */
+	double GetLastUpdateSeconds() const { return LastUpdateSeconds; }
+
+	const TArray<UCameraSpringArm*>& GetArms() const { return Arms; }
+
+	/** Number of chunks the batch is split into, from Camera.ParallelWorkers */
+	static int32 GetNumWorkers();
+
+	/** Quality level arms update at this frame; safe to read from the batch's worker threads */
+	ECameraBudgetLevel GetBudgetLevel() const { return BudgetGovernor.GetLevel(); }
+
+	/** Charges camera work done on the game thread to this frame's budget */
+	void AddFrameCost(double Seconds) { BudgetGovernor.AddCost(Seconds); }
+
+	/** Should Owner's arm skip this frame's update to save budget? Arms a local player views through never do. */
+	bool ShouldThrottle(const AActor* Owner, uint32 StaggerKey) const;
+
+	const FCameraBudgetGovernor& GetBudgetGovernor() const { return BudgetGovernor; }
+
+	/** Called by ACameraCollisionProxy as it begins and ends play; registered proxies are active while Camera.CollisionProxies is set */
+	void RegisterCollisionProxy(ACameraCollisionProxy* Proxy);
+	void UnregisterCollisionProxy(ACameraCollisionProxy* Proxy);
+
+private:
+	friend struct FCameraArmBatchTickFunction;
+
+	/** Runs once a frame from the tick function; picks up changes to Camera.ParallelUpdate */
+	void TickBatch(float DeltaTime);
+
+	void SetUpdateMode(ECameraArmUpdateMode NewMode);
+
+	/** Turns Arm's own tick off while the batch drives it, remembering to turn it back on only if it was on */
+	void SuspendArmTick(UCameraSpringArm* Arm);
+
+	/** Gives Arm back the tick SuspendArmTick took away */
+	void RestoreArmTick(UCameraSpringArm* Arm);
+
+	/** Snapshots which arms update this frame and how much time each covers, and sizes the frame buffers */
+	int32 BeginUpdate(float DeltaTime);
+
+	/** Ends the update BeginUpdate started; arms registered or unregistered in between only change the live list */
+	void EndUpdate();
+
+	/**
+	 * Once every actor has ticked: moves children bDirectViewOutput left behind other than the direct view, ends the governor's frame and
+	 * picks up changes to Camera.CollisionProxies
+	 */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+
+	/** Counts, and warns once about, arms whose owner moved after they were committed this frame */
+	void CheckStaleTransforms();
+
+	TArray<UCameraSpringArm*> Arms;
+
+	/**
+	 * Arms being updated, copied from Arms by BeginUpdate. PrepareFrame runs owner delegates that may register or
+	 * unregister arms, so the update walks this copy, and an arm unregistered mid-update is nulled out of it.
+	 */
+	TArray<UCameraSpringArm*> UpdatingArms;
+
+	/** Arms whose own tick the batch turned off, and that get it back when batching stops */
+	TSet<UCameraSpringArm*> ArmsWithSuspendedTick;
+
+	bool bUpdatingArms = false;
+
+	/** One frame per arm, reused every update */
+	TArray<FCameraArmFrame> Frames;
+
+	/** Whether each arm was active when the batch started, so solving and committing agree */
+	TArray<bool> ArmActive;
+
+	/** Time each arm's update covers, longer than the frame for arms that were throttled */
+	TArray<float> ArmDeltaTimes;
+
+	/** Completion of each arm's last pipelined stage, reused every update */
+	FGraphEventArray ResolveEvents;
+
+	FCameraArmBatchTickFunction BatchTickFunction;
+
+	ECameraArmUpdateMode UpdateMode = ECameraArmUpdateMode::PerComponent;
+
+	FCameraBudgetGovernor BudgetGovernor;
+
+	/** Actors local players were viewing through at the end of the last frame */
+	TArray<const AActor*, TInlineAllocator<4>> ViewTargets;
+
+	FDelegateHandle PostActorTickHandle;
+
+	/** Arms CheckStaleTransforms has already warned about */
+	TSet<FObjectKey> StaleArmsReported;
+
+	/** Collision proxies of the levels in play, each swapped in for its own level's meshes only */
+	TArray<ACameraCollisionProxy*> CollisionProxies;
+
+	double LastUpdateSeconds = 0.0;
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraBudgetGovernor.h"
+#include "CameraStats.h"
+
+const float FCameraBudgetGovernor::RecoverFraction = 0.7f;
+
+void FCameraBudgetGovernor::EndFrame(float BudgetMs)
+{
+	LastFrameCost = FrameCost;
+	FrameCost = 0.0;
+
+	SET_FLOAT_STAT(STAT_CameraFrameCost, (float)(LastFrameCost * 1000.0));
+
+	if (BudgetMs <= 0.f)
+	{
+		SetLevel(ECameraBudgetLevel::Full);
+		return;
+	}
+
+	const double Budget = BudgetMs * 0.001;
+
+	if (bSettling)
+	{
+		SettledCost[(int32)Level] = LastFrameCost;
+		bSettling = false;
+	}
+
+	if (LastFrameCost > Budget)
+	{
+		FramesUnderBudget = 0;
+		if (++FramesOverBudget >= DegradeFrames && Level < ECameraBudgetLevel::ThrottleArms)
+		{
+			const ECameraBudgetLevel NewLevel = (ECameraBudgetLevel)((int32)Level + 1);
+			EntryCost[(int32)NewLevel] = LastFrameCost;
+			SetLevel(NewLevel);
+		}
+		return;
+	}
+
+	FramesOverBudget = 0;
+	if (Level == ECameraBudgetLevel::Full) { return; }
+
+	// Scale by what this level saved when it was added, so dropping it doesn't immediately go back over budget
+	const double Settled = SettledCost[(int32)Level];
+	const double Savings = Settled > 0.0 ? FMath::Max(EntryCost[(int32)Level] / Settled, 1.0) : 1.0;
+	if (LastFrameCost * Savings < Budget * RecoverFraction)
+	{
+		if (++FramesUnderBudget >= RecoverFrames)
+		{
+			SetLevel((ECameraBudgetLevel)((int32)Level - 1));
+		}
+	}
+	else
+	{
+		FramesUnderBudget = 0;
+	}
+}
+
+void FCameraBudgetGovernor::SetLevel(ECameraBudgetLevel NewLevel)
+{
+	if (NewLevel != Level)
+	{
+		Level = NewLevel;
+		FramesOverBudget = 0;
+		FramesUnderBudget = 0;
+		bSettling = true;
+	}
+	SET_DWORD_STAT(STAT_CameraBudgetLevel, (uint32)Level);
+}
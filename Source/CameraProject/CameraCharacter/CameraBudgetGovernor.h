@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** How far camera quality is cut back to stay within Camera.BudgetMs; each level includes the ones before it */
+enum class ECameraBudgetLevel : uint8
+{
+	/** Everything runs at full quality */
+	Full,
+	/** Lag is solved in one step however long the frame was */
+	NoSubsteps,
+	/** The collision test reuses the last query's result for a few frames between real queries */
+	ReuseSweeps,
+	/** Arms nobody is viewing through only update every few frames */
+	ThrottleArms,
+};
+
+
+/**
+ * Tracks what camera work costs each frame against a time budget and picks an ECameraBudgetLevel.
+ *
+ * A level is added after DegradeFrames frames in a row over budget. Dropping a level estimates what the frame would
+ * cost without it, from the cost measured just before and just after the level was added, and only happens after
+ * RecoverFrames frames in a row where that estimate fits comfortably within the budget, so quality doesn't flip
+ * back and forth around the limit.
+ */
+class CAMERAPROJECT_API FCameraBudgetGovernor
+{
+public:
+	/** Charges camera work to the current frame. Game thread only. */
+	void AddCost(double Seconds) { FrameCost += Seconds; }
+
+	/** Moves the level for the frame that just finished, then starts measuring the next one. BudgetMs <= 0 turns the governor off. */
+	void EndFrame(float BudgetMs);
+
+	ECameraBudgetLevel GetLevel() const { return Level; }
+
+	double GetLastFrameCostMs() const { return LastFrameCost * 1000.0; }
+
+	static const int32 DegradeFrames = 2;
+	static const int32 RecoverFrames = 60;
+
+	/** Fraction of the budget a frame must be estimated to fit in before a level is dropped */
+	static const float RecoverFraction;
+
+	/** Non view target arms update once every this many frames at ThrottleArms */
+	static const int32 ThrottleInterval = 4;
+
+	/** Most frames in a row the collision test reuses a result at ReuseSweeps */
+	static const int32 MaxSweepReuse = 2;
+
+private:
+	void SetLevel(ECameraBudgetLevel NewLevel);
+
+	ECameraBudgetLevel Level = ECameraBudgetLevel::Full;
+
+	double FrameCost = 0.0;
+	double LastFrameCost = 0.0;
+
+	int32 FramesOverBudget = 0;
+	int32 FramesUnderBudget = 0;
+
+	/** Cost of the frame that pushed the governor into each level, and of the first frame spent at it */
+	double EntryCost[(int32)ECameraBudgetLevel::ThrottleArms + 1] = {};
+	double SettledCost[(int32)ECameraBudgetLevel::ThrottleArms + 1] = {};
+	bool bSettling = false;
+};
@@ -9,9 +9,11 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "CameraArmComponent.h"
+#include "CameraProject.h"
 
 // Sets default values
-ACameraCharacter::ACameraCharacter()
+ACameraCharacter::ACameraCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -36,16 +38,29 @@ ACameraCharacter::ACameraCharacter()
 	GetCharacterMovement()->AirControl = 0.2f;
 
 	
+	// Dedicated servers have no one to view through the camera, so they don't get one. Optional subobjects, so data
+	// saved with them still loads there.
+	if (!ShouldCreateCameraComponents())
+	{
+		ObjectInitializer.DoNotCreateDefaultSubobject(TEXT("CameraArm")).DoNotCreateDefaultSubobject(TEXT("FollowCamera"));
+	}
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
-	OurCameraArm = CreateDefaultSubobject<UCameraArmComponent>(TEXT("CameraArm"));
-	OurCameraArm->SetupAttachment(RootComponent);
-	OurCameraArm->DesiredCameraDistance = 200.0f; // The camera follows at this distance behind the character
-	//OurCameraArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	OurCameraArm = CreateOptionalDefaultSubobject<UCameraArmComponent>(TEXT("CameraArm"));
+	if (OurCameraArm)
+	{
+		OurCameraArm->SetupAttachment(RootComponent);
+		OurCameraArm->DesiredCameraDistance = 200.0f; // The camera follows at this distance behind the character
+		//OurCameraArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	}
 
 	// Create a follow camera
-	OurCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-	OurCamera->SetupAttachment(OurCameraArm); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-	OurCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	OurCamera = CreateOptionalDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
+	if (OurCamera)
+	{
+		OurCamera->SetupAttachment(OurCameraArm); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+		OurCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	}
 
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character)
 	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
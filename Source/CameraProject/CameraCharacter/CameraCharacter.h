@@ -13,7 +13,7 @@ class CAMERAPROJECT_API ACameraCharacter : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	ACameraCharacter();
+	ACameraCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
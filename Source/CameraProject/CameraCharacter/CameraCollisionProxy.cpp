@@ -0,0 +1,268 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraCollisionProxy.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Components/StaticMeshComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "CameraArmSubsystem.h"
+
+UCameraProxyComponent::UCameraProxyComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	ProxyChannel = ECC_GameTraceChannel1;
+	ProxyBodySetup = nullptr;
+
+	Mobility = EComponentMobility::Static;
+	bHiddenInGame = true;
+	SetCanEverAffectNavigation(false);
+	SetGenerateOverlapEvents(false);
+	CanCharacterStepUpOn = ECB_No;
+
+	SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	SetCollisionObjectType(ECC_WorldStatic);
+}
+
+void UCameraProxyComponent::OnRegister()
+{
+	// Set before the physics state is created, so the proxies only ever show up to camera probes
+	const ACameraCollisionProxy* Proxy = Cast<ACameraCollisionProxy>(GetOwner());
+	BodyInstance.SetResponseToAllChannels(ECR_Ignore);
+	BodyInstance.SetResponseToChannel(ProxyChannel, ECR_Block);
+	BodyInstance.SetResponseToChannel(ECC_Camera, Proxy && Proxy->AreProxiesActive() ? ECR_Block : ECR_Ignore);
+
+	Super::OnRegister();
+}
+
+void UCameraProxyComponent::SetBoxes(const TArray<FKBoxElem>& NewBoxes)
+{
+	Boxes = NewBoxes;
+	bBodySetupDirty = true;
+
+	if (IsRegistered())
+	{
+		RecreatePhysicsState();
+		UpdateBounds();
+	}
+}
+
+UBodySetup* UCameraProxyComponent::GetBodySetup()
+{
+	if (!ProxyBodySetup)
+	{
+		ProxyBodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		ProxyBodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		ProxyBodySetup->bNeverNeedsCookedCollisionData = true;
+		bBodySetupDirty = true;
+	}
+
+	if (bBodySetupDirty)
+	{
+		ProxyBodySetup->AggGeom.BoxElems = Boxes;
+		bBodySetupDirty = false;
+	}
+
+	return ProxyBodySetup;
+}
+
+FBoxSphereBounds UCameraProxyComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	FKAggregateGeom Geometry;
+	Geometry.BoxElems = Boxes;
+	const FBox Bounds = Geometry.CalcAABB(LocalToWorld);
+	return Bounds.IsValid ? FBoxSphereBounds(Bounds) : FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+}
+
+ACameraCollisionProxy::ACameraCollisionProxy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	ProxyComponent = CreateDefaultSubobject<UCameraProxyComponent>(TEXT("ProxyComponent"));
+	RootComponent = ProxyComponent;
+
+	SetActorHiddenInGame(true);
+	SetCanBeDamaged(false);
+}
+
+void ACameraCollisionProxy::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UCameraArmSubsystem* ArmSubsystem = GetWorld()->GetSubsystem<UCameraArmSubsystem>())
+	{
+		ArmSubsystem->RegisterCollisionProxy(this);
+	}
+}
+
+void ACameraCollisionProxy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCameraArmSubsystem* ArmSubsystem = GetWorld()->GetSubsystem<UCameraArmSubsystem>())
+	{
+		ArmSubsystem->UnregisterCollisionProxy(this);
+	}
+	SetProxiesActive(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACameraCollisionProxy::SetProxiesActive(bool bActive)
+{
+	if (bActive == bProxiesActive) { return; }
+	bProxiesActive = bActive;
+
+	if (bActive)
+	{
+		// Overlapping rather than ignoring keeps the meshes out of blocking probes but visible to occluder fading
+		for (UStaticMeshComponent* Component : ProxiedComponents)
+		{
+			if (Component && Component->GetCollisionResponseToChannel(ECC_Camera) == ECR_Block)
+			{
+				Component->SetCollisionResponseToChannel(ECC_Camera, ECR_Overlap);
+				OverlappingComponents.Add(Component);
+			}
+		}
+	}
+	else
+	{
+		for (const TWeakObjectPtr<UStaticMeshComponent>& Component : OverlappingComponents)
+		{
+			if (Component.IsValid())
+			{
+				Component->SetCollisionResponseToChannel(ECC_Camera, ECR_Block);
+			}
+		}
+		OverlappingComponents.Reset();
+	}
+
+	ProxyComponent->SetCollisionResponseToChannel(ECC_Camera, bActive ? ECR_Block : ECR_Ignore);
+}
+
+bool ACameraCollisionProxy::ShouldProxy(const UStaticMeshComponent* Component, const FCameraProxyBuildSettings& Settings)
+{
+	return Component->GetStaticMesh()
+		&& Component->IsQueryCollisionEnabled()
+		&& Component->GetCollisionResponseToChannel(ECC_Camera) == ECR_Block
+		&& (Settings.bIncludeMovable || Component->Mobility != EComponentMobility::Movable);
+}
+
+void ACameraCollisionProxy::BuildBoxes(ULevel* Level, const FCameraProxyBuildSettings& Settings, TArray<FKBoxElem>& OutBoxes, TArray<UStaticMeshComponent*>& OutProxiedComponents)
+{
+	struct FSourceBox
+	{
+		FKBoxElem Box;
+		FBox WorldBounds;
+	};
+
+	TArray<FSourceBox> SmallBoxes;
+
+	TInlineComponentArray<UStaticMeshComponent*> Components;
+	for (AActor* Actor : Level->Actors)
+	{
+		if (!Actor || Actor->IsA<ACameraCollisionProxy>()) { continue; }
+
+		Actor->GetComponents(Components);
+		for (UStaticMeshComponent* Component : Components)
+		{
+			if (!ShouldProxy(Component, Settings)) { continue; }
+
+			// Bound the simple collision where there is some, since that is usually tighter than the render mesh
+			const UBodySetup* BodySetup = Component->GetStaticMesh()->GetBodySetup();
+			const FBox LocalBounds = BodySetup && BodySetup->AggGeom.GetElementCount() > 0
+				? BodySetup->AggGeom.CalcAABB(FTransform::Identity)
+				: Component->GetStaticMesh()->GetBoundingBox();
+
+			// Meshes too small for a box of their own are still proxied, as the probe radius covers them
+			OutProxiedComponents.Add(Component);
+
+			const FTransform& Transform = Component->GetComponentTransform();
+			const FVector Size = LocalBounds.GetSize() * Transform.GetScale3D().GetAbs();
+			if (Size.GetMax() < Settings.MinSize) { continue; }
+
+			FSourceBox Source;
+			Source.Box = FKBoxElem(Size.X, Size.Y, Size.Z);
+			Source.Box.Center = Transform.TransformPosition(LocalBounds.GetCenter());
+			Source.Box.Rotation = Transform.Rotator();
+			Source.WorldBounds = LocalBounds.TransformBy(Transform);
+
+			if (Size.GetMax() < Settings.MergeSize)
+			{
+				SmallBoxes.Add(Source);
+			}
+			else
+			{
+				OutBoxes.Add(Source.Box);
+			}
+		}
+	}
+
+	// Clutter that fills most of a cell becomes one box for the cell
+	TMap<FIntVector, TArray<int32>> Cells;
+	for (int32 Index = 0; Index < SmallBoxes.Num(); ++Index)
+	{
+		const FVector Center = SmallBoxes[Index].WorldBounds.GetCenter() / Settings.MergeSize;
+		Cells.FindOrAdd(FIntVector(FMath::FloorToInt(Center.X), FMath::FloorToInt(Center.Y), FMath::FloorToInt(Center.Z))).Add(Index);
+	}
+
+	for (const TPair<FIntVector, TArray<int32>>& Cell : Cells)
+	{
+		FBox Merged(ForceInit);
+		float FilledVolume = 0.f;
+		for (int32 Index : Cell.Value)
+		{
+			Merged += SmallBoxes[Index].WorldBounds;
+			FilledVolume += SmallBoxes[Index].Box.GetVolume(FVector::OneVector);
+		}
+
+		if (Cell.Value.Num() > 1 && FilledVolume >= Merged.GetVolume() * Settings.MinFillRatio)
+		{
+			const FVector Size = Merged.GetSize();
+			FKBoxElem& Box = OutBoxes.Add_GetRef(FKBoxElem(Size.X, Size.Y, Size.Z));
+			Box.Center = Merged.GetCenter();
+		}
+		else
+		{
+			for (int32 Index : Cell.Value)
+			{
+				OutBoxes.Add(SmallBoxes[Index].Box);
+			}
+		}
+	}
+}
+
+ACameraCollisionProxy* ACameraCollisionProxy::Generate(ULevel* Level, const FCameraProxyBuildSettings& Settings)
+{
+	UWorld* World = Level ? Level->GetWorld() : nullptr;
+	if (!World) { return nullptr; }
+
+	TArray<ACameraCollisionProxy*> OldProxies;
+	for (AActor* Actor : Level->Actors)
+	{
+		if (ACameraCollisionProxy* OldProxy = Cast<ACameraCollisionProxy>(Actor))
+		{
+			OldProxies.Add(OldProxy);
+		}
+	}
+	for (ACameraCollisionProxy* OldProxy : OldProxies)
+	{
+		World->DestroyActor(OldProxy);
+	}
+
+	TArray<FKBoxElem> Boxes;
+	TArray<UStaticMeshComponent*> Components;
+	BuildBoxes(Level, Settings, Boxes, Components);
+	if (Components.Num() == 0) { return nullptr; }
+
+	// Not spawned straight into play, so a world that has begun play activates the proxy once it has its meshes
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.OverrideLevel = Level;
+	SpawnParams.bDeferConstruction = true;
+	ACameraCollisionProxy* Proxy = World->SpawnActor<ACameraCollisionProxy>(FVector::ZeroVector, FRotator::ZeroRotator, SpawnParams);
+	if (Proxy)
+	{
+		Proxy->ProxiedComponents = MoveTemp(Components);
+		Proxy->GetProxyComponent()->SetBoxes(Boxes);
+		Proxy->FinishSpawning(FTransform::Identity);
+	}
+	return Proxy;
+}
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/PrimitiveComponent.h"
+#include "PhysicsEngine/BoxElem.h"
+#include "CameraCollisionProxy.generated.h"
+
+class UBodySetup;
+class ULevel;
+class UStaticMeshComponent;
+
+/** How coarse the generated camera proxies are */
+struct FCameraProxyBuildSettings
+{
+	/** Meshes whose bounds are smaller than this on every axis are left out; the probe radius covers them */
+	float MinSize = 20.f;
+
+	/** Meshes smaller than this are merged with their neighbours in cells of this size */
+	float MergeSize = 400.f;
+
+	/** How much of a merged box the meshes in it must fill, otherwise they keep their own boxes */
+	float MinFillRatio = 0.5f;
+
+	/** Also cover movable meshes, whose proxies won't follow them; only meant for benchmarks */
+	bool bIncludeMovable = false;
+};
+
+
+/**
+ * Simple boxes that stand in for level geometry in camera probes. Always blocks ProxyChannel, blocks ECC_Camera while
+ * its ACameraCollisionProxy is active, and ignores everything else.
+ */
+UCLASS(ClassGroup = Camera)
+class CAMERAPROJECT_API UCameraProxyComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCameraProxyComponent(const FObjectInitializer& ObjectInitializer);
+
+	/** Proxy shapes, relative to the component */
+	UPROPERTY(VisibleAnywhere, Category = Camera)
+		TArray<FKBoxElem> Boxes;
+
+	/**
+	 * Trace channel only the proxies block, for sweeping them on their own. Defined as CameraProxy in
+	 * Config/DefaultEngine.ini with a default response of Ignore, so ordinary geometry doesn't block it too.
+	 */
+	UPROPERTY(EditAnywhere, Category = Camera)
+		TEnumAsByte<ECollisionChannel> ProxyChannel;
+
+	void SetBoxes(const TArray<FKBoxElem>& NewBoxes);
+
+	// UPrimitiveComponent interface
+	virtual UBodySetup* GetBodySetup() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	// End of UPrimitiveComponent interface
+
+	// UActorComponent interface
+	virtual void OnRegister() override;
+	// End of UActorComponent interface
+
+private:
+	/** Built from Boxes on demand; boxes need no cooking, so nothing about it is saved */
+	UPROPERTY(Transient, DuplicateTransient)
+		UBodySetup* ProxyBodySetup;
+
+	bool bBodySetupDirty = true;
+};
+
+
+/**
+ * Camera collision proxies for one level, generated from the static meshes that block ECC_Camera. While active (see
+ * Camera.CollisionProxies), the boxes block ECC_Camera and the meshes they cover only overlap it, so single camera
+ * probes skip the meshes' detailed collision while occluder fading still finds them. Everything else, including other
+ * levels, landscape, BSP and anything movable, keeps blocking the camera as it always did.
+ *
+ * Generated offline by the CameraProxy commandlet and saved into the level; regenerate when the level's art changes.
+ */
+UCLASS(NotBlueprintable)
+class CAMERAPROJECT_API ACameraCollisionProxy : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACameraCollisionProxy(const FObjectInitializer& ObjectInitializer);
+
+	UCameraProxyComponent* GetProxyComponent() const { return ProxyComponent; }
+
+	/** Boxes covering the camera-blocking static meshes of Level, and the meshes they stand in for */
+	static void BuildBoxes(ULevel* Level, const FCameraProxyBuildSettings& Settings, TArray<FKBoxElem>& OutBoxes, TArray<UStaticMeshComponent*>& OutProxiedComponents);
+
+	/** Replaces Level's proxy, if it has one, with a newly generated one; null when nothing in Level needs proxies */
+	static ACameraCollisionProxy* Generate(ULevel* Level, const FCameraProxyBuildSettings& Settings);
+
+	/** Meshes of this proxy's level whose camera collision the boxes replace */
+	const TArray<UStaticMeshComponent*>& GetProxiedComponents() const { return ProxiedComponents; }
+
+	/** Swaps the boxes in for the meshes they cover on ECC_Camera, or gives the meshes their own collision back */
+	void SetProxiesActive(bool bActive);
+
+	bool AreProxiesActive() const { return bProxiesActive; }
+
+	/** Does Component's collision get replaced by proxies? */
+	static bool ShouldProxy(const UStaticMeshComponent* Component, const FCameraProxyBuildSettings& Settings);
+
+protected:
+	// AActor interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End of AActor interface
+
+private:
+	UPROPERTY(VisibleAnywhere, Category = Camera)
+		UCameraProxyComponent* ProxyComponent;
+
+	UPROPERTY(VisibleAnywhere, Category = Camera)
+		TArray<UStaticMeshComponent*> ProxiedComponents;
+
+	/** Meshes SetProxiesActive turned from blocking ECC_Camera to overlapping it, to be turned back */
+	TArray<TWeakObjectPtr<UStaticMeshComponent>> OverlappingComponents;
+
+	bool bProxiesActive = false;
+};
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraConstraintSubsystem.h"
+#include "CameraConstraintVolume.h"
+#include "Components/BrushComponent.h"
+#include "CameraProject.h"
+
+const float UCameraConstraintSubsystem::CellSize = 2000.f;
+
+bool UCameraConstraintSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return ShouldCreateCameraComponents();
+}
+
+FIntVector UCameraConstraintSubsystem::GetCell(const FVector& Location)
+{
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void UCameraConstraintSubsystem::RegisterVolume(ACameraConstraintVolume* Volume)
+{
+	check(IsInGameThread());
+
+	FConstraintEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Volume = Volume;
+	Entry.Transform = Volume->GetActorTransform();
+	Entry.LocalBounds = Volume->GetBrushComponent()->CalcBounds(FTransform::Identity).GetBox();
+	Entry.bCapArmLength = Volume->bCapArmLength;
+	Entry.MaxArmLength = Volume->MaxArmLength;
+	Entry.CollisionFreeArmLength = Volume->CollisionFreeArmLength;
+	Entry.bForceShoulderSide = Volume->bForceShoulderSide;
+	Entry.bRightShoulder = Volume->ShoulderSide == ECameraShoulderSide::Right;
+	Entry.bOverrideTargetOffset = Volume->bOverrideTargetOffset;
+	Entry.TargetOffset = Volume->TargetOffset;
+	Entry.Priority = Volume->Priority;
+
+	AddToCells(Entries.Num() - 1);
+}
+
+void UCameraConstraintSubsystem::UnregisterVolume(ACameraConstraintVolume* Volume)
+{
+	check(IsInGameThread());
+
+	// Only happens when a level unloads, so just rebuild the cells rather than patching the indices in them
+	if (Entries.RemoveAll([Volume](const FConstraintEntry& Entry) { return Entry.Volume == Volume; }) > 0)
+	{
+		RebuildCells();
+	}
+}
+
+void UCameraConstraintSubsystem::AddToCells(int32 EntryIndex)
+{
+	const FConstraintEntry& Entry = Entries[EntryIndex];
+	const FBox WorldBounds = Entry.LocalBounds.TransformBy(Entry.Transform);
+	const FIntVector MinCell = GetCell(WorldBounds.Min);
+	const FIntVector MaxCell = GetCell(WorldBounds.Max);
+
+	const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - MinCell.Z + 1);
+	if (NumCells > MaxCellsPerVolume)
+	{
+		LargeEntries.Add(EntryIndex);
+		return;
+	}
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(EntryIndex);
+			}
+		}
+	}
+}
+
+void UCameraConstraintSubsystem::RebuildCells()
+{
+	Cells.Reset();
+	LargeEntries.Reset();
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		AddToCells(EntryIndex);
+	}
+}
+
+void UCameraConstraintSubsystem::Combine(const FConstraintEntry& Entry, FCameraConstraint& OutConstraint)
+{
+	if (Entry.bCapArmLength && (!OutConstraint.bCapArmLength || Entry.MaxArmLength < OutConstraint.MaxArmLength))
+	{
+		OutConstraint.bCapArmLength = true;
+		OutConstraint.MaxArmLength = Entry.MaxArmLength;
+		OutConstraint.CollisionFreeArmLength = Entry.CollisionFreeArmLength;
+	}
+
+	if (Entry.bForceShoulderSide && Entry.Priority > OutConstraint.ShoulderPriority)
+	{
+		OutConstraint.bForceShoulderSide = true;
+		OutConstraint.bRightShoulder = Entry.bRightShoulder;
+		OutConstraint.ShoulderPriority = Entry.Priority;
+	}
+
+	if (Entry.bOverrideTargetOffset && Entry.Priority > OutConstraint.TargetOffsetPriority)
+	{
+		OutConstraint.bOverrideTargetOffset = true;
+		OutConstraint.TargetOffset = Entry.TargetOffset;
+		OutConstraint.TargetOffsetPriority = Entry.Priority;
+	}
+}
+
+bool UCameraConstraintSubsystem::FindConstraint(const FVector& Location, FCameraConstraint& OutConstraint) const
+{
+	OutConstraint = FCameraConstraint();
+	if (Entries.Num() == 0) { return false; }
+
+	bool bFound = false;
+	if (const TArray<int32, TInlineAllocator<2>>* CellEntries = Cells.Find(GetCell(Location)))
+	{
+		for (int32 EntryIndex : *CellEntries)
+		{
+			const FConstraintEntry& Entry = Entries[EntryIndex];
+			if (Entry.Contains(Location))
+			{
+				Combine(Entry, OutConstraint);
+				bFound = true;
+			}
+		}
+	}
+
+	for (int32 EntryIndex : LargeEntries)
+	{
+		const FConstraintEntry& Entry = Entries[EntryIndex];
+		if (Entry.Contains(Location))
+		{
+			Combine(Entry, OutConstraint);
+			bFound = true;
+		}
+	}
+
+	return bFound;
+}
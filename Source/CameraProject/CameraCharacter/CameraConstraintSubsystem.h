@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CameraConstraintSubsystem.generated.h"
+
+class ACameraConstraintVolume;
+
+/** Combined constraints of every volume containing a point */
+struct FCameraConstraint
+{
+	bool bCapArmLength = false;
+	float MaxArmLength = 0.f;
+	/** Collision-free length of the volume that set MaxArmLength */
+	float CollisionFreeArmLength = 0.f;
+
+	bool bForceShoulderSide = false;
+	bool bRightShoulder = true;
+	int32 ShoulderPriority = MIN_int32;
+
+	bool bOverrideTargetOffset = false;
+	FVector TargetOffset = FVector::ZeroVector;
+	int32 TargetOffsetPriority = MIN_int32;
+};
+
+
+/**
+ * Spatial hash of the camera constraint volumes in a world. Volumes are copied into a flat list and bucketed into
+ * fixed size cells as they begin play, so spring arms find the volumes around their origin with one cell lookup
+ * and never touch the volume actors, which keeps queries safe from the batched update's worker threads.
+ */
+UCLASS()
+class CAMERAPROJECT_API UCameraConstraintSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	// End of USubsystem interface
+
+	void RegisterVolume(ACameraConstraintVolume* Volume);
+	void UnregisterVolume(ACameraConstraintVolume* Volume);
+
+	/** Combines every volume containing Location into OutConstraint; returns false if there are none */
+	bool FindConstraint(const FVector& Location, FCameraConstraint& OutConstraint) const;
+
+	/** Edge length of a hash cell */
+	static const float CellSize;
+
+	/** Volumes covering more cells than this are kept in a separate list that every query checks */
+	static const int32 MaxCellsPerVolume = 4096;
+
+private:
+	/** Everything a query needs from a volume, copied out when it registers */
+	struct FConstraintEntry
+	{
+		ACameraConstraintVolume* Volume = nullptr;
+		FTransform Transform;
+		FBox LocalBounds;
+		bool bCapArmLength = false;
+		float MaxArmLength = 0.f;
+		float CollisionFreeArmLength = 0.f;
+		bool bForceShoulderSide = false;
+		bool bRightShoulder = true;
+		bool bOverrideTargetOffset = false;
+		FVector TargetOffset = FVector::ZeroVector;
+		int32 Priority = 0;
+
+		bool Contains(const FVector& Location) const { return LocalBounds.IsInsideOrOn(Transform.InverseTransformPosition(Location)); }
+	};
+
+	static FIntVector GetCell(const FVector& Location);
+
+	void AddToCells(int32 EntryIndex);
+	void RebuildCells();
+
+	static void Combine(const FConstraintEntry& Entry, FCameraConstraint& OutConstraint);
+
+	TArray<FConstraintEntry> Entries;
+
+	/** Indices into Entries of the volumes overlapping each cell */
+	TMap<FIntVector, TArray<int32, TInlineAllocator<2>>> Cells;
+
+	/** Indices into Entries of volumes too big to bucket */
+	TArray<int32> LargeEntries;
+};
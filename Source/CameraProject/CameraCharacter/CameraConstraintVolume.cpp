@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraConstraintVolume.h"
+#include "Components/BrushComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "CameraConstraintSubsystem.h"
+
+ACameraConstraintVolume::ACameraConstraintVolume(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	// Arms find these through the constraint index, so the brush needs no collision or overlap events of its own
+	GetBrushComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	GetBrushComponent()->SetGenerateOverlapEvents(false);
+}
+
+void ACameraConstraintVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UCameraConstraintSubsystem* ConstraintSubsystem = GetWorld()->GetSubsystem<UCameraConstraintSubsystem>())
+	{
+		ConstraintSubsystem->RegisterVolume(this);
+	}
+}
+
+void ACameraConstraintVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCameraConstraintSubsystem* ConstraintSubsystem = GetWorld()->GetSubsystem<UCameraConstraintSubsystem>())
+	{
+		ConstraintSubsystem->UnregisterVolume(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "CameraConstraintVolume.generated.h"
+
+
+/** Which side of the character the camera sits on, by the sign of the socket offset's Y */
+UENUM(BlueprintType)
+enum class ECameraShoulderSide : uint8
+{
+	Left,
+	Right,
+};
+
+
+/**
+ * Area where spring arms whose origin is inside are constrained: a shorter arm, a fixed shoulder side or a fixed
+ * target offset. Volumes are indexed once when they begin play and are not expected to move afterwards.
+ * Arms test their origin against the volume's oriented bounding box, so boxes are the intended brush shape.
+ */
+UCLASS()
+class CAMERAPROJECT_API ACameraConstraintVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	ACameraConstraintVolume(const FObjectInitializer& ObjectInitializer);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint")
+		bool bCapArmLength = false;
+
+	/** Longest the arm may be while inside; where capping volumes overlap, the shortest cap wins */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint", meta = (editcondition = "bCapArmLength", ClampMin = "0.0", UIMin = "0.0"))
+		float MaxArmLength = 150.f;
+
+	/**
+	 * Arm length up to which the designer guarantees the camera can't hit anything in this volume. When the capped
+	 * arm is no longer than this, the arm skips its collision test entirely. Zero never skips it.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint", meta = (editcondition = "bCapArmLength", ClampMin = "0.0", UIMin = "0.0"))
+		float CollisionFreeArmLength = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint")
+		bool bForceShoulderSide = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint", meta = (editcondition = "bForceShoulderSide"))
+		ECameraShoulderSide ShoulderSide = ECameraShoulderSide::Right;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint")
+		bool bOverrideTargetOffset = false;
+
+	/** World space offset from the arm's component to its origin, replacing the arm's own TargetOffset */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint", meta = (editcondition = "bOverrideTargetOffset"))
+		FVector TargetOffset = FVector::ZeroVector;
+
+	/** Where volumes overlap, the shoulder side and target offset of the highest priority volume win */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera Constraint")
+		int32 Priority = 0;
+
+protected:
+	// AActor interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	// End of AActor interface
+};
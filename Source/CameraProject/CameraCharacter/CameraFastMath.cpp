@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraFastMath.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraFastMath, Log, All);
+
+static TAutoConsoleVariable<int32> CVarCameraFastTrig(
+	TEXT("Camera.FastTrig"),
+	0,
+	TEXT("0: the camera solver uses the engine's precise rotator conversions.\n")
+	TEXT("1: the camera solver converts rotators with bounded-error polynomial sines and cosines, evaluated together with SIMD."),
+	ECVF_Default);
+
+namespace CameraFastMath
+{
+	static const VectorRegister DegreesToRadians = MakeVectorRegister(PI / 180.f, PI / 180.f, PI / 180.f, PI / 180.f);
+	static const VectorRegister OneOverNinety = MakeVectorRegister(1.f / 90.f, 1.f / 90.f, 1.f / 90.f, 1.f / 90.f);
+	static const VectorRegister Ninety = MakeVectorRegister(90.f, 90.f, 90.f, 90.f);
+	static const VectorRegister Quarter = MakeVectorRegister(0.25f, 0.25f, 0.25f, 0.25f);
+	static const VectorRegister Four = MakeVectorRegister(4.f, 4.f, 4.f, 4.f);
+	static const VectorRegister Half = MakeVectorRegister(0.5f, 0.5f, 0.5f, 0.5f);
+	static const VectorRegister OneAndHalf = MakeVectorRegister(1.5f, 1.5f, 1.5f, 1.5f);
+
+	// Fitted for the smallest largest error over [-pi/4, pi/4]; sin(x) = x * (1 + S1 x^2 + S2 x^4 + S3 x^6)
+	static const VectorRegister Sin1 = MakeVectorRegister(-0.16666637f, -0.16666637f, -0.16666637f, -0.16666637f);
+	static const VectorRegister Sin2 = MakeVectorRegister(0.0083315847f, 0.0083315847f, 0.0083315847f, 0.0083315847f);
+	static const VectorRegister Sin3 = MakeVectorRegister(-0.00019462121f, -0.00019462121f, -0.00019462121f, -0.00019462121f);
+
+	// cos(x) = 1 + C1 x^2 + C2 x^4 + C3 x^6
+	static const VectorRegister Cos1 = MakeVectorRegister(-0.49999857f, -0.49999857f, -0.49999857f, -0.49999857f);
+	static const VectorRegister Cos2 = MakeVectorRegister(0.041655026f, 0.041655026f, 0.041655026f, 0.041655026f);
+	static const VectorRegister Cos3 = MakeVectorRegister(-0.0013585908f, -0.0013585908f, -0.0013585908f, -0.0013585908f);
+
+	/** Rounds to the nearest whole number, halves away from zero */
+	static FORCEINLINE VectorRegister RoundToWhole(const VectorRegister& X)
+	{
+		return VectorTruncate(VectorAdd(X, VectorBitwiseOr(Half, VectorBitwiseAnd(X, GlobalVectorConstants::SignBit))));
+	}
+
+	/** Times the precise and fast rotator conversions over Iterations random rotations and logs both with the largest error */
+	static void RunBenchmark(int32 Iterations)
+	{
+		const float ArmLength = 3000.f;
+		const FVector SocketOffset(0.f, 60.f, 20.f);
+
+		FRandomStream Stream(1);
+		TArray<FRotator> Rotations;
+		Rotations.SetNumUninitialized(Iterations);
+		for (FRotator& Rotation : Rotations)
+		{
+			Rotation = FRotator(Stream.FRandRange(-720.f, 720.f), Stream.FRandRange(-720.f, 720.f), Stream.FRandRange(-720.f, 720.f));
+		}
+
+		// Summed so neither loop can be optimized away
+		FVector PreciseSum = FVector::ZeroVector;
+		FVector FastSum = FVector::ZeroVector;
+
+		const double PreciseStart = FPlatformTime::Seconds();
+		for (const FRotator& Rotation : Rotations)
+		{
+			PreciseSum += FCameraFastMath::GetArmOffset<false>(Rotation, ArmLength, SocketOffset);
+			PreciseSum.X += Rotation.Quaternion().W;
+		}
+		const double PreciseSeconds = FPlatformTime::Seconds() - PreciseStart;
+
+		const double FastStart = FPlatformTime::Seconds();
+		for (const FRotator& Rotation : Rotations)
+		{
+			FastSum += FCameraFastMath::GetArmOffset<true>(Rotation, ArmLength, SocketOffset);
+			FastSum.X += FCameraFastMath::ToQuat(Rotation).W;
+		}
+		const double FastSeconds = FPlatformTime::Seconds() - FastStart;
+
+		float MaxArmError = 0.f;
+		float MaxQuatError = 0.f;
+		for (const FRotator& Rotation : Rotations)
+		{
+			const FVector Precise = FCameraFastMath::GetArmOffset<false>(Rotation, ArmLength, SocketOffset);
+			const FVector Fast = FCameraFastMath::GetArmOffset<true>(Rotation, ArmLength, SocketOffset);
+			MaxArmError = FMath::Max(MaxArmError, FVector::Dist(Precise, Fast));
+			MaxQuatError = FMath::Max(MaxQuatError, FMath::RadiansToDegrees(Rotation.Quaternion().AngularDistance(FCameraFastMath::ToQuat(Rotation))));
+		}
+
+		const double Nanoseconds = 1e9 / FMath::Max(Iterations, 1);
+		UE_LOG(LogCameraFastMath, Display, TEXT("%d rotations: precise %.1f ns, fast %.1f ns (%.2fx)"), Iterations,
+			PreciseSeconds * Nanoseconds, FastSeconds * Nanoseconds, FastSeconds > 0.0 ? PreciseSeconds / FastSeconds : 0.0);
+		UE_LOG(LogCameraFastMath, Display, TEXT("Largest error: %.4f units at the end of a %.0f unit arm, %.5f degrees of quaternion rotation (checksums %s / %s)"),
+			MaxArmError, ArmLength, MaxQuatError, *PreciseSum.ToString(), *FastSum.ToString());
+	}
+}
+
+static FAutoConsoleCommand CameraFastTrigBenchmarkCommand(
+	TEXT("Camera.FastTrigBenchmark"),
+	TEXT("Times the camera's precise and fast rotator conversions and logs the largest error of the fast one. Takes the number of rotations, 1000000 by default."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		CameraFastMath::RunBenchmark(Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000000);
+	}));
+
+const float FCameraFastMath::MaxSinCosError = 2e-7f;
+
+bool FCameraFastMath::IsEnabled()
+{
+	return CVarCameraFastTrig.GetValueOnAnyThread() != 0;
+}
+
+void FCameraFastMath::SinCos4(const VectorRegister& AnglesDegrees, VectorRegister& OutSin, VectorRegister& OutCos)
+{
+	using namespace CameraFastMath;
+
+	// Take off whole quarter turns while still in degrees, so no rounded multiple of pi ends up in what is left,
+	// leaving [-pi/4, pi/4] where the polynomials were fitted. Which quarter, from -2 to 2, picks the signs below.
+	const VectorRegister Quarters = RoundToWhole(VectorMultiply(AnglesDegrees, OneOverNinety));
+	const VectorRegister X = VectorMultiply(VectorNegateMultiplyAdd(Quarters, Ninety, AnglesDegrees), DegreesToRadians);
+	const VectorRegister Quadrant = VectorNegateMultiplyAdd(RoundToWhole(VectorMultiply(Quarters, Quarter)), Four, Quarters);
+
+	const VectorRegister X2 = VectorMultiply(X, X);
+
+	VectorRegister SinPoly = VectorMultiplyAdd(X2, Sin3, Sin2);
+	SinPoly = VectorMultiplyAdd(X2, SinPoly, Sin1);
+	SinPoly = VectorMultiplyAdd(X2, SinPoly, GlobalVectorConstants::FloatOne);
+	const VectorRegister Sin = VectorMultiply(X, SinPoly);
+
+	VectorRegister CosPoly = VectorMultiplyAdd(X2, Cos3, Cos2);
+	CosPoly = VectorMultiplyAdd(X2, CosPoly, Cos1);
+	const VectorRegister Cos = VectorMultiplyAdd(X2, CosPoly, GlobalVectorConstants::FloatOne);
+
+	// A quarter turn forwards takes sin to cos and cos to -sin, a quarter turn back takes sin to -cos and cos to sin,
+	// and a half turn either way negates both
+	const VectorRegister AbsQuadrant = VectorAbs(Quadrant);
+	const VectorRegister Swap = VectorCompareEQ(AbsQuadrant, GlobalVectorConstants::FloatOne);
+	const VectorRegister QuadrantSign = VectorBitwiseAnd(Quadrant, GlobalVectorConstants::SignBit);
+	const VectorRegister HalfTurnSign = VectorBitwiseAnd(VectorCompareGT(AbsQuadrant, OneAndHalf), GlobalVectorConstants::SignBit);
+	const VectorRegister SinSign = VectorSelect(Swap, QuadrantSign, HalfTurnSign);
+	const VectorRegister CosSign = VectorSelect(Swap, VectorBitwiseXor(QuadrantSign, GlobalVectorConstants::SignBit), HalfTurnSign);
+
+	OutSin = VectorBitwiseXor(VectorSelect(Swap, Cos, Sin), SinSign);
+	OutCos = VectorBitwiseXor(VectorSelect(Swap, Sin, Cos), CosSign);
+}
+
+FQuat FCameraFastMath::ToQuat(const FRotator& Rotation)
+{
+	VectorRegister Sin, Cos;
+	SinCos4(MakeVectorRegister(Rotation.Pitch * 0.5f, Rotation.Yaw * 0.5f, Rotation.Roll * 0.5f, 0.f), Sin, Cos);
+
+	float S[4], C[4];
+	VectorStore(Sin, S);
+	VectorStore(Cos, C);
+	const float SP = S[0], SY = S[1], SR = S[2];
+	const float CP = C[0], CY = C[1], CR = C[2];
+
+	// Same composition as FRotator::Quaternion; the polynomials' error leaves it a hair off unit length
+	FQuat Result(
+		CR * SP * SY - SR * CP * CY,
+		-CR * SP * CY - SR * CP * SY,
+		CR * CP * SY - SR * SP * CY,
+		CR * CP * CY + SR * SP * SY);
+	Result.Normalize();
+	return Result;
+}
+
+FVector FCameraFastMath::GetArmOffset(const FRotator& Rotation, float ArmLength, const FVector& SocketOffset)
+{
+	VectorRegister Sin, Cos;
+	SinCos4(MakeVectorRegister(Rotation.Pitch, Rotation.Yaw, Rotation.Roll, 0.f), Sin, Cos);
+
+	float S[4], C[4];
+	VectorStore(Sin, S);
+	VectorStore(Cos, C);
+	const float SP = S[0], SY = S[1], SR = S[2];
+	const float CP = C[0], CY = C[1], CR = C[2];
+
+	// Rows of FRotationMatrix; the first is also Rotation.Vector()
+	const FVector AxisX(CP * CY, CP * SY, SP);
+	const FVector AxisY(SR * SP * CY - CR * SY, SR * SP * SY + CR * CY, -SR * CP);
+	const FVector AxisZ(-(CR * SP * CY + SR * SY), CY * SR - CR * SP * SY, CR * CP);
+
+	return AxisX * (SocketOffset.X - ArmLength) + AxisY * SocketOffset.Y + AxisZ * SocketOffset.Z;
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Bounded-error trigonometry for the camera solver, used while Camera.FastTrig is set. Angles are reduced by whole
+ * quarter turns to within 45 degrees, sines and cosines come from degree 7 and 6 polynomials fitted over that range,
+ * and all three angles of a rotator are evaluated together in one SIMD register instead of one scalar FMath::SinCos each.
+ *
+ * Every sine and cosine is within MaxSinCosError of the precise value. Over every rotator, the axes of the rotation
+ * and the quaternion stay within 0.0001 degrees of FRotationMatrix's and FRotator::Quaternion()'s, which puts the
+ * end of a 3000 unit arm less than 0.01 units away from where the precise path puts it.
+ * Camera.FastTrigBenchmark times both paths and measures the error.
+ */
+struct CAMERAPROJECT_API FCameraFastMath
+{
+	/** Largest difference between a sine or cosine from SinCos4 and the precise one */
+	static const float MaxSinCosError;
+
+	/** Is Camera.FastTrig set? Read when the camera's lag solvers are picked, which then use one path or the other throughout */
+	static bool IsEnabled();
+
+	/** Sines and cosines of four angles in degrees, evaluated together */
+	static void SinCos4(const VectorRegister& AnglesDegrees, VectorRegister& OutSin, VectorRegister& OutCos);
+
+	/** Rotation.Quaternion() from one SinCos4, normalized */
+	static FQuat ToQuat(const FRotator& Rotation);
+
+	/** Rotation.Vector() * -ArmLength + FRotationMatrix(Rotation).TransformVector(SocketOffset), from one SinCos4 */
+	static FVector GetArmOffset(const FRotator& Rotation, float ArmLength, const FVector& SocketOffset);
+
+	/** Rotation.Quaternion(), through the fast path when bFast is set */
+	template<bool bFast>
+	static FORCEINLINE FQuat ToQuat(const FRotator& Rotation)
+	{
+		return bFast ? ToQuat(Rotation) : Rotation.Quaternion();
+	}
+
+	/** Where the end of an arm of ArmLength with SocketOffset sits relative to its origin, through the fast path when bFast is set */
+	template<bool bFast>
+	static FORCEINLINE FVector GetArmOffset(const FRotator& Rotation, float ArmLength, const FVector& SocketOffset)
+	{
+		return bFast ? GetArmOffset(Rotation, ArmLength, SocketOffset) : FRotationMatrix(Rotation).TransformVector(SocketOffset) - Rotation.Vector() * ArmLength;
+	}
+};
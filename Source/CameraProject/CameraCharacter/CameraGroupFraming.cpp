@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraGroupFraming.h"
+#include "GameFramework/Actor.h"
+
+void FCameraGroupFraming::SetTargets(const TArray<AActor*>& Actors, float Radius)
+{
+	Reset();
+	for (AActor* Actor : Actors)
+	{
+		AddTarget(Actor, Radius);
+	}
+}
+
+void FCameraGroupFraming::AddTarget(AActor* Actor, float Radius)
+{
+	if (!Actor || Targets.Contains(Actor)) { return; }
+
+	const FVector Location = Actor->GetActorLocation();
+	Targets.Add(Actor);
+	X.Add(Location.X);
+	Y.Add(Location.Y);
+	Z.Add(Location.Z);
+	Radii.Add(FMath::Max(Radius, 0.f));
+	bNeedsRescan = true;
+}
+
+void FCameraGroupFraming::RemoveTarget(AActor* Actor)
+{
+	const int32 Index = Targets.IndexOfByKey(Actor);
+	if (Index != INDEX_NONE)
+	{
+		RemoveAtSwap(Index);
+	}
+}
+
+void FCameraGroupFraming::Reset()
+{
+	Targets.Reset();
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	Radii.Reset();
+	Bounds = FBox(ForceInit);
+	bNeedsRescan = true;
+}
+
+void FCameraGroupFraming::RemoveAtSwap(int32 Index)
+{
+	Targets.RemoveAtSwap(Index, 1, false);
+	X.RemoveAtSwap(Index, 1, false);
+	Y.RemoveAtSwap(Index, 1, false);
+	Z.RemoveAtSwap(Index, 1, false);
+	Radii.RemoveAtSwap(Index, 1, false);
+	bNeedsRescan = true;
+}
+
+void FCameraGroupFraming::UpdateTargets()
+{
+	float* Axes[3] = { X.GetData(), Y.GetData(), Z.GetData() };
+
+	for (int32 Index = Targets.Num() - 1; Index >= 0; --Index)
+	{
+		const AActor* Actor = Targets[Index].Get();
+		if (!Actor)
+		{
+			RemoveAtSwap(Index);
+			continue;
+		}
+
+		const FVector Location = Actor->GetActorLocation();
+		X[Index] = Location.X;
+		Y[Index] = Location.Y;
+		Z[Index] = Location.Z;
+
+		if (bNeedsRescan) { continue; }
+
+		// A target can only push a side outwards, unless it is the one holding that side and moved in
+		const float Radius = Radii[Index];
+		for (int32 Axis = 0; Axis < 3 && !bNeedsRescan; ++Axis)
+		{
+			const float Low = Axes[Axis][Index] - Radius;
+			const float High = Axes[Axis][Index] + Radius;
+
+			if (Low < Bounds.Min[Axis])
+			{
+				Bounds.Min[Axis] = Low;
+				MinIndex[Axis] = Index;
+			}
+			else if (MinIndex[Axis] == Index && Low > Bounds.Min[Axis])
+			{
+				bNeedsRescan = true;
+			}
+
+			if (High > Bounds.Max[Axis])
+			{
+				Bounds.Max[Axis] = High;
+				MaxIndex[Axis] = Index;
+			}
+			else if (MaxIndex[Axis] == Index && High < Bounds.Max[Axis])
+			{
+				bNeedsRescan = true;
+			}
+		}
+	}
+
+	if (bNeedsRescan)
+	{
+		Rescan();
+	}
+}
+
+void FCameraGroupFraming::Rescan()
+{
+	bNeedsRescan = false;
+	++NumRescans;
+
+	Bounds = FBox(ForceInit);
+	if (Targets.Num() == 0) { return; }
+
+	const float* Axes[3] = { X.GetData(), Y.GetData(), Z.GetData() };
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float* Values = Axes[Axis];
+		float Low = MAX_flt;
+		float High = -MAX_flt;
+		for (int32 Index = 0; Index < Targets.Num(); ++Index)
+		{
+			const float TargetLow = Values[Index] - Radii[Index];
+			const float TargetHigh = Values[Index] + Radii[Index];
+			if (TargetLow < Low)
+			{
+				Low = TargetLow;
+				MinIndex[Axis] = Index;
+			}
+			if (TargetHigh > High)
+			{
+				High = TargetHigh;
+				MaxIndex[Axis] = Index;
+			}
+		}
+		Bounds.Min[Axis] = Low;
+		Bounds.Max[Axis] = High;
+	}
+	Bounds.IsValid = 1;
+}
+
+float FCameraGroupFraming::FitArmLength(const FRotator& Rotation, float TanHalfFovX, float TanHalfFovY) const
+{
+	const int32 NumTargets = Targets.Num();
+	if (NumTargets == 0) { return 0.f; }
+
+	const FRotationMatrix View(Rotation);
+	const FVector Forward = View.GetUnitAxis(EAxis::X);
+	const FVector Right = View.GetUnitAxis(EAxis::Y);
+	const FVector Up = View.GetUnitAxis(EAxis::Z);
+	const FVector Center = Bounds.GetCenter();
+	const float InvTanX = 1.f / FMath::Max(TanHalfFovX, KINDA_SMALL_NUMBER);
+	const float InvTanY = 1.f / FMath::Max(TanHalfFovY, KINDA_SMALL_NUMBER);
+
+	// Each target needs the camera far enough back that it fits both sideways and up and down:
+	// (|offset along the axis| + radius) / tan(half fov) - offset along forward
+	auto FitTarget = [&](int32 Index)
+	{
+		const FVector Offset(X[Index] - Center.X, Y[Index] - Center.Y, Z[Index] - Center.Z);
+		const float Depth = Offset | Forward;
+		const float Sideways = (FMath::Abs(Offset | Right) + Radii[Index]) * InvTanX - Depth;
+		const float Vertical = (FMath::Abs(Offset | Up) + Radii[Index]) * InvTanY - Depth;
+		return FMath::Max(Sideways, Vertical);
+	};
+
+	const VectorRegister CenterX = VectorSetFloat1(Center.X);
+	const VectorRegister CenterY = VectorSetFloat1(Center.Y);
+	const VectorRegister CenterZ = VectorSetFloat1(Center.Z);
+	const VectorRegister ForwardX = VectorSetFloat1(Forward.X);
+	const VectorRegister ForwardY = VectorSetFloat1(Forward.Y);
+	const VectorRegister ForwardZ = VectorSetFloat1(Forward.Z);
+	const VectorRegister RightX = VectorSetFloat1(Right.X);
+	const VectorRegister RightY = VectorSetFloat1(Right.Y);
+	const VectorRegister RightZ = VectorSetFloat1(Right.Z);
+	const VectorRegister UpX = VectorSetFloat1(Up.X);
+	const VectorRegister UpY = VectorSetFloat1(Up.Y);
+	const VectorRegister UpZ = VectorSetFloat1(Up.Z);
+	const VectorRegister InvTanXs = VectorSetFloat1(InvTanX);
+	const VectorRegister InvTanYs = VectorSetFloat1(InvTanY);
+
+	// Four targets at a time straight out of the per-axis arrays, then whatever is left over one by one
+	VectorRegister Longest = VectorSetFloat1(-MAX_flt);
+	int32 Index = 0;
+	for (; Index + 4 <= NumTargets; Index += 4)
+	{
+		const VectorRegister OffsetX = VectorSubtract(VectorLoad(&X[Index]), CenterX);
+		const VectorRegister OffsetY = VectorSubtract(VectorLoad(&Y[Index]), CenterY);
+		const VectorRegister OffsetZ = VectorSubtract(VectorLoad(&Z[Index]), CenterZ);
+		const VectorRegister Radius = VectorLoad(&Radii[Index]);
+
+		const VectorRegister Depth = VectorMultiplyAdd(OffsetZ, ForwardZ, VectorMultiplyAdd(OffsetY, ForwardY, VectorMultiply(OffsetX, ForwardX)));
+		const VectorRegister Sideways = VectorMultiplyAdd(OffsetZ, RightZ, VectorMultiplyAdd(OffsetY, RightY, VectorMultiply(OffsetX, RightX)));
+		const VectorRegister Vertical = VectorMultiplyAdd(OffsetZ, UpZ, VectorMultiplyAdd(OffsetY, UpY, VectorMultiply(OffsetX, UpX)));
+
+		const VectorRegister FitX = VectorSubtract(VectorMultiply(VectorAdd(VectorAbs(Sideways), Radius), InvTanXs), Depth);
+		const VectorRegister FitY = VectorSubtract(VectorMultiply(VectorAdd(VectorAbs(Vertical), Radius), InvTanYs), Depth);
+		Longest = VectorMax(Longest, VectorMax(FitX, FitY));
+	}
+
+	float Lanes[4];
+	VectorStore(Longest, Lanes);
+	float ArmLength = FMath::Max(FMath::Max(Lanes[0], Lanes[1]), FMath::Max(Lanes[2], Lanes[3]));
+
+	for (; Index < NumTargets; ++Index)
+	{
+		ArmLength = FMath::Max(ArmLength, FitTarget(Index));
+	}
+
+	return FMath::Max(ArmLength, 0.f);
+}
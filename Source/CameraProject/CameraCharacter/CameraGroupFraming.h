@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/**
+ * Keeps a group of actors framed by one camera. Target positions live in contiguous per-axis arrays, so reading them
+ * back each frame and fitting them to the view walk memory in order, and the fit handles four targets per SIMD op.
+ *
+ * The bounds are kept incrementally: each axis remembers which target sets its minimum and maximum, and a target
+ * moving only matters if it moves past a side or is the one holding a side and moves inwards. Only then is the
+ * whole group scanned again.
+ */
+struct CAMERAPROJECT_API FCameraGroupFraming
+{
+	/** Replaces the group; Radius is how much room is kept around each target */
+	void SetTargets(const TArray<AActor*>& Actors, float Radius);
+
+	void AddTarget(AActor* Actor, float Radius);
+	void RemoveTarget(AActor* Actor);
+	void Reset();
+
+	int32 Num() const { return Targets.Num(); }
+
+	/** Reads every target's location and brings the bounds up to date, dropping targets that were destroyed. Game thread only. */
+	void UpdateTargets();
+
+	/** Box around every target and the room kept around it, as of the last UpdateTargets */
+	const FBox& GetBounds() const { return Bounds; }
+
+	/**
+	 * How far back along Rotation from the centre of the bounds the camera has to be for every target to be on
+	 * screen. TanHalfFovX and TanHalfFovY are the tangents of half the horizontal and vertical fields of view.
+	 */
+	float FitArmLength(const FRotator& Rotation, float TanHalfFovX, float TanHalfFovY) const;
+
+	/** How often UpdateTargets had to scan the whole group, for profiling */
+	uint32 GetNumRescans() const { return NumRescans; }
+
+private:
+	/** Finds the sides of the bounds and the targets holding them from scratch */
+	void Rescan();
+
+	void RemoveAtSwap(int32 Index);
+
+	TArray<TWeakObjectPtr<AActor>> Targets;
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> Radii;
+
+	FBox Bounds = FBox(ForceInit);
+
+	/** Target holding the minimum and maximum side of the bounds on each axis */
+	int32 MinIndex[3] = { INDEX_NONE, INDEX_NONE, INDEX_NONE };
+	int32 MaxIndex[3] = { INDEX_NONE, INDEX_NONE, INDEX_NONE };
+
+	bool bNeedsRescan = true;
+	uint32 NumRescans = 0;
+};
@@ -0,0 +1,260 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraHistory.h"
+
+namespace CameraHistory
+{
+	/** Position steps per unreal unit */
+	static const float PositionScale = 16.f;
+
+	/** Time steps per second */
+	static const double TimeScale = 10000.0;
+
+	/** Largest magnitude of the three smallest components of a unit quaternion */
+	static const float SmallestThreeRange = HALF_SQRT_2;
+
+	static const int32 ComponentBits = 10;
+	static const uint32 ComponentMax = (1 << ComponentBits) - 1;
+}
+
+FCameraHistory::FCameraHistory(float Seconds, float SampleRate)
+{
+	const int32 NumSamples = FMath::Max(FMath::CeilToInt(Seconds * SampleRate), KeyframeInterval);
+	Samples.SetNumUninitialized(NumSamples);
+
+	// Forced keyframes can use up spare slots early, which only shortens how far back the history reaches
+	Keyframes.SetNumUninitialized(NumSamples / KeyframeInterval + 2);
+
+	MinInterval = SampleRate > 0.f ? 1.0 / SampleRate : 0.0;
+}
+
+void FCameraHistory::Reset()
+{
+	NumRecorded = 0;
+	NumKeyframes = 0;
+	SamplesSinceKeyframe = 0;
+}
+
+SIZE_T FCameraHistory::GetAllocatedSize() const
+{
+	return Samples.GetAllocatedSize() + Keyframes.GetAllocatedSize();
+}
+
+uint32 FCameraHistory::PackRotation(const FQuat& Rotation)
+{
+	const FQuat Normalized = Rotation.GetNormalized();
+	float Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+
+	int32 LargestIndex = 0;
+	for (int32 Index = 1; Index < 4; ++Index)
+	{
+		if (FMath::Abs(Components[Index]) > FMath::Abs(Components[LargestIndex]))
+		{
+			LargestIndex = Index;
+		}
+	}
+
+	// q and -q are the same rotation, so the dropped component can always be made positive
+	const float Sign = Components[LargestIndex] < 0.f ? -1.f : 1.f;
+
+	uint32 Packed = (uint32)LargestIndex << (3 * CameraHistory::ComponentBits);
+	int32 Shift = 2 * CameraHistory::ComponentBits;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		if (Index == LargestIndex) { continue; }
+
+		const float Unit = FMath::Clamp(Components[Index] * Sign / CameraHistory::SmallestThreeRange * 0.5f + 0.5f, 0.f, 1.f);
+		Packed |= (uint32)FMath::RoundToInt(Unit * CameraHistory::ComponentMax) << Shift;
+		Shift -= CameraHistory::ComponentBits;
+	}
+	return Packed;
+}
+
+FQuat FCameraHistory::UnpackRotation(uint32 Packed)
+{
+	const int32 LargestIndex = (int32)(Packed >> (3 * CameraHistory::ComponentBits));
+
+	float Components[4];
+	float SumSquares = 0.f;
+	int32 Shift = 2 * CameraHistory::ComponentBits;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		if (Index == LargestIndex) { continue; }
+
+		const float Unit = (float)((Packed >> Shift) & CameraHistory::ComponentMax) / CameraHistory::ComponentMax;
+		Components[Index] = (Unit - 0.5f) * 2.f * CameraHistory::SmallestThreeRange;
+		SumSquares += FMath::Square(Components[Index]);
+		Shift -= CameraHistory::ComponentBits;
+	}
+	Components[LargestIndex] = FMath::Sqrt(FMath::Max(1.f - SumSquares, 0.f));
+
+	return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+}
+
+void FCameraHistory::Record(double Time, const FTransform& RelativeTransform)
+{
+	if (NumRecorded > 0 && Time - LastTime < MinInterval) { return; }
+
+	const FVector Location = RelativeTransform.GetLocation() * CameraHistory::PositionScale;
+	const FIntVector Position(FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z));
+	const FIntVector PositionDelta = Position - LastPosition;
+	const int64 TimeDelta = FMath::RoundToInt((Time - LastTime) * CameraHistory::TimeScale);
+
+	const bool bDeltaFits = TimeDelta >= 0 && TimeDelta < KeyframeMarker
+		&& FMath::Abs(PositionDelta.X) <= MAX_int16 && FMath::Abs(PositionDelta.Y) <= MAX_int16 && FMath::Abs(PositionDelta.Z) <= MAX_int16;
+	const bool bKeyframe = NumRecorded == 0 || SamplesSinceKeyframe >= KeyframeInterval || !bDeltaFits;
+
+	FSample& Sample = Samples[NumRecorded % (uint32)Samples.Num()];
+	Sample.Rotation = PackRotation(RelativeTransform.GetRotation());
+
+	if (bKeyframe)
+	{
+		Sample.TimeDelta = KeyframeMarker;
+		Sample.PositionDelta[0] = Sample.PositionDelta[1] = Sample.PositionDelta[2] = 0;
+
+		FKeyframe& Keyframe = Keyframes[NumKeyframes % (uint32)Keyframes.Num()];
+		Keyframe.Time = Time;
+		Keyframe.Position = Position;
+		Keyframe.Sequence = NumRecorded;
+		++NumKeyframes;
+
+		SamplesSinceKeyframe = 0;
+		LastPosition = Position;
+		LastTime = Time;
+	}
+	else
+	{
+		Sample.TimeDelta = (uint16)TimeDelta;
+		Sample.PositionDelta[0] = (int16)PositionDelta.X;
+		Sample.PositionDelta[1] = (int16)PositionDelta.Y;
+		Sample.PositionDelta[2] = (int16)PositionDelta.Z;
+
+		// Track the decoded values rather than the exact ones so rounding never accumulates
+		LastPosition += PositionDelta;
+		LastTime += TimeDelta / CameraHistory::TimeScale;
+	}
+
+	++SamplesSinceKeyframe;
+	++NumRecorded;
+}
+
+uint32 FCameraHistory::GetOldestSequence() const
+{
+	return NumRecorded > (uint32)Samples.Num() ? NumRecorded - (uint32)Samples.Num() : 0;
+}
+
+int64 FCameraHistory::FindKeyframe(double Time) const
+{
+	const uint32 OldestSequence = GetOldestSequence();
+	const uint32 NumStored = FMath::Min(NumKeyframes, (uint32)Keyframes.Num());
+
+	for (uint32 Age = 0; Age < NumStored; ++Age)
+	{
+		const uint32 KeyframeNumber = NumKeyframes - 1 - Age;
+		const FKeyframe& Keyframe = GetKeyframe(KeyframeNumber);
+		if (Keyframe.Sequence < OldestSequence) { break; }
+		if (Keyframe.Time <= Time) { return KeyframeNumber; }
+	}
+	return INDEX_NONE;
+}
+
+bool FCameraHistory::GetTimeRange(double& OutStart, double& OutEnd) const
+{
+	if (NumRecorded == 0) { return false; }
+
+	// Samples before the oldest surviving keyframe can't be decoded, so the range starts there
+	const uint32 OldestSequence = GetOldestSequence();
+	const uint32 NumStored = FMath::Min(NumKeyframes, (uint32)Keyframes.Num());
+	for (uint32 KeyframeNumber = NumKeyframes - NumStored; KeyframeNumber < NumKeyframes; ++KeyframeNumber)
+	{
+		const FKeyframe& Keyframe = GetKeyframe(KeyframeNumber);
+		if (Keyframe.Sequence >= OldestSequence)
+		{
+			OutStart = Keyframe.Time;
+			OutEnd = LastTime;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FCameraHistory::Evaluate(double Time, FTransform& OutRelativeTransform) const
+{
+	const int64 KeyframeNumber = FindKeyframe(Time);
+	if (KeyframeNumber == INDEX_NONE) { return false; }
+
+	const FKeyframe& Keyframe = GetKeyframe((uint32)KeyframeNumber);
+
+	uint32 Sequence = Keyframe.Sequence;
+	FIntVector Position = Keyframe.Position;
+	double SampleTime = Keyframe.Time;
+	uint32 Rotation = GetSample(Sequence).Rotation;
+
+	// Walk forward to the samples either side of Time; the next keyframe is already past it
+	while (Sequence + 1 < NumRecorded)
+	{
+		const FSample& Next = GetSample(Sequence + 1);
+
+		FIntVector NextPosition;
+		double NextTime;
+		if (Next.TimeDelta == KeyframeMarker)
+		{
+			const FKeyframe& NextKeyframe = GetKeyframe((uint32)KeyframeNumber + 1);
+			NextPosition = NextKeyframe.Position;
+			NextTime = NextKeyframe.Time;
+		}
+		else
+		{
+			NextPosition = Position + FIntVector(Next.PositionDelta[0], Next.PositionDelta[1], Next.PositionDelta[2]);
+			NextTime = SampleTime + Next.TimeDelta / CameraHistory::TimeScale;
+		}
+
+		if (NextTime >= Time)
+		{
+			const float Alpha = NextTime > SampleTime ? (float)((Time - SampleTime) / (NextTime - SampleTime)) : 1.f;
+			const FVector From = FVector(Position) / CameraHistory::PositionScale;
+			const FVector To = FVector(NextPosition) / CameraHistory::PositionScale;
+
+			OutRelativeTransform.SetLocation(FMath::Lerp(From, To, Alpha));
+			OutRelativeTransform.SetRotation(FQuat::Slerp(UnpackRotation(Rotation), UnpackRotation(Next.Rotation), Alpha));
+			OutRelativeTransform.SetScale3D(FVector::OneVector);
+			return true;
+		}
+
+		++Sequence;
+		Position = NextPosition;
+		SampleTime = NextTime;
+		Rotation = Next.Rotation;
+	}
+
+	// Past the newest sample
+	OutRelativeTransform = FTransform(UnpackRotation(Rotation), FVector(Position) / CameraHistory::PositionScale);
+	return true;
+}
+
+void FCameraHistoryPlayback::StartFromEnd(float SecondsAgo)
+{
+	double Start = 0.0;
+	double End = 0.0;
+	if (History.GetTimeRange(Start, End))
+	{
+		PlaybackTime = FMath::Max(End - SecondsAgo, Start);
+	}
+}
+
+bool FCameraHistoryPlayback::IsFinished() const
+{
+	double Start = 0.0;
+	double End = 0.0;
+	return !History.GetTimeRange(Start, End) || PlaybackTime > End;
+}
+
+bool FCameraHistoryPlayback::Evaluate(const FTransform& OwnerTransform, FTransform& OutCameraTransform) const
+{
+	FTransform RelativeTransform;
+	if (!History.Evaluate(PlaybackTime, RelativeTransform)) { return false; }
+
+	OutCameraTransform = RelativeTransform * OwnerTransform;
+	return true;
+}
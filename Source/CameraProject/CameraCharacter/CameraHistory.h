@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Fixed size history of a camera transform relative to its owner, for instant replays.
+ *
+ * Each sample is 12 bytes: the time since the previous sample in 0.1 ms steps, the position change in 1/16 cm
+ * steps and the rotation packed with smallest-three into 32 bits. Every KeyframeInterval samples, and whenever a
+ * change doesn't fit in a sample, a keyframe with the absolute time and position is stored alongside, so reading
+ * any time only walks the samples since the keyframe before it. Deltas are taken from the previously decoded
+ * position, so quantization error doesn't build up between keyframes.
+ *
+ * Memory is allocated once for Seconds at SampleRate; recording faster than SampleRate skips samples, and the
+ * oldest samples are overwritten once the buffer is full.
+ */
+class CAMERAPROJECT_API FCameraHistory
+{
+public:
+	FCameraHistory(float Seconds, float SampleRate);
+
+	/** Adds the transform at Time, which must not go backwards */
+	void Record(double Time, const FTransform& RelativeTransform);
+
+	/** Interpolated transform at Time, clamped to the newest sample; false if Time is older than the history */
+	bool Evaluate(double Time, FTransform& OutRelativeTransform) const;
+
+	/** Times of the oldest and newest samples that can still be evaluated */
+	bool GetTimeRange(double& OutStart, double& OutEnd) const;
+
+	void Reset();
+
+	/** Bytes held by the sample and keyframe buffers */
+	SIZE_T GetAllocatedSize() const;
+
+	static const int32 KeyframeInterval = 32;
+
+	/** Smallest-three quaternion packing: index of the dropped component and three 10 bit components */
+	static uint32 PackRotation(const FQuat& Rotation);
+	static FQuat UnpackRotation(uint32 Packed);
+
+private:
+	struct FSample
+	{
+		/** 0.1 ms since the previous sample, or KeyframeMarker if this sample starts a keyframe */
+		uint16 TimeDelta;
+		int16 PositionDelta[3];
+		uint32 Rotation;
+	};
+
+	struct FKeyframe
+	{
+		double Time;
+		FIntVector Position;
+		uint32 Sequence;
+	};
+
+	static const uint16 KeyframeMarker = MAX_uint16;
+
+	const FSample& GetSample(uint32 Sequence) const { return Samples[Sequence % (uint32)Samples.Num()]; }
+	const FKeyframe& GetKeyframe(uint32 KeyframeNumber) const { return Keyframes[KeyframeNumber % (uint32)Keyframes.Num()]; }
+
+	/** Sequence number of the oldest sample still in the buffer */
+	uint32 GetOldestSequence() const;
+
+	/** Newest keyframe at or before Time that is still in the buffer, or INDEX_NONE */
+	int64 FindKeyframe(double Time) const;
+
+	TArray<FSample> Samples;
+	TArray<FKeyframe> Keyframes;
+
+	/** Samples and keyframes recorded so far; ring positions are these modulo the buffer sizes */
+	uint32 NumRecorded = 0;
+	uint32 NumKeyframes = 0;
+	uint32 SamplesSinceKeyframe = 0;
+
+	/** Decoded values of the newest sample, which the next delta is taken from */
+	FIntVector LastPosition = FIntVector::ZeroValue;
+	double LastTime = 0.0;
+
+	double MinInterval = 0.0;
+};
+
+
+/** Plays an FCameraHistory back by time, placing the camera around wherever the owner is during the replay */
+struct CAMERAPROJECT_API FCameraHistoryPlayback
+{
+	explicit FCameraHistoryPlayback(const FCameraHistory& InHistory)
+		: History(InHistory)
+	{
+	}
+
+	/** Moves playback to SecondsAgo before the newest sample */
+	void StartFromEnd(float SecondsAgo);
+
+	void Seek(double Time) { PlaybackTime = Time; }
+
+	void Advance(float DeltaTime) { PlaybackTime += DeltaTime * PlayRate; }
+
+	/** Has playback moved past the newest sample? */
+	bool IsFinished() const;
+
+	/** Camera world transform at the playback time, given the owner's transform at that point of the replay */
+	bool Evaluate(const FTransform& OwnerTransform, FTransform& OutCameraTransform) const;
+
+	double PlaybackTime = 0.0;
+	float PlayRate = 1.f;
+
+private:
+	const FCameraHistory& History;
+};
@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraLatency.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraLatency, Log, All);
+
+static TAutoConsoleVariable<int32> CVarCameraLatencyTracking(
+	TEXT("Camera.LatencyTracking"),
+	0,
+	TEXT("0: off. 1: record how long look input takes to reach the camera into latency histograms. 2: also show the percentiles on screen."),
+	ECVF_Default);
+
+static FAutoConsoleCommand CameraLatencyReportCommand(
+	TEXT("Camera.LatencyReport"),
+	TEXT("Logs the p50/p95/p99 of every look input latency span recorded this session."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (int32 SpanIndex = 0; SpanIndex < (int32)ECameraLatencySpan::Num; ++SpanIndex)
+		{
+			const ECameraLatencySpan Span = (ECameraLatencySpan)SpanIndex;
+			const FCameraLatencyHistogram& Histogram = FCameraLatencyTracker::GetHistogram(Span);
+			UE_LOG(LogCameraLatency, Display, TEXT("%-9s %6u frames   mean %7.2f ms   p50 %7.2f   p95 %7.2f   p99 %7.2f   max %7.2f"),
+				FCameraLatencyTracker::GetSpanName(Span), Histogram.GetCount(), Histogram.GetMean(),
+				Histogram.GetPercentile(.5f), Histogram.GetPercentile(.95f), Histogram.GetPercentile(.99f), Histogram.GetMax());
+		}
+	}));
+
+static FAutoConsoleCommand CameraLatencyCsvCommand(
+	TEXT("Camera.LatencyCsv"),
+	TEXT("Exports this session's look input latency histograms. Writes to Saved/Profiling/CameraLatency.csv unless given a file name."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("CameraLatency.csv");
+		if (FCameraLatencyTracker::ExportCsv(Filename))
+		{
+			UE_LOG(LogCameraLatency, Display, TEXT("Camera latency written to %s"), *Filename);
+		}
+		else
+		{
+			UE_LOG(LogCameraLatency, Warning, TEXT("Failed to write %s"), *Filename);
+		}
+	}));
+
+static FAutoConsoleCommand CameraLatencyResetCommand(
+	TEXT("Camera.LatencyReset"),
+	TEXT("Clears the look input latency histograms."),
+	FConsoleCommandDelegate::CreateStatic(&FCameraLatencyTracker::Reset));
+
+/** Slowest the target may turn, in degrees per second, for the lag behind it to be measured */
+static const float MinLagTurnRate = 5.f;
+
+const float FCameraLatencyHistogram::BucketMs = 0.25f;
+
+FCameraLatencyHistogram FCameraLatencyTracker::Histograms[(int32)ECameraLatencySpan::Num];
+
+//////////////////////////////////////////////////////////////////////////
+// FCameraLatencyHistogram
+
+void FCameraLatencyHistogram::Add(float Ms)
+{
+	Ms = FMath::Max(Ms, 0.f);
+	++Buckets[FMath::Min(FMath::FloorToInt(Ms / BucketMs), NumBuckets - 1)];
+	++Count;
+	TotalMs += Ms;
+	MaxMs = FMath::Max(MaxMs, Ms);
+}
+
+void FCameraLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	TotalMs = 0.0;
+	MaxMs = 0.f;
+}
+
+float FCameraLatencyHistogram::GetPercentile(float Percentile) const
+{
+	if (Count == 0) { return 0.f; }
+
+	const uint32 Wanted = (uint32)FMath::Clamp(FMath::CeilToInt(Percentile * Count), 1, (int32)Count);
+	uint32 Seen = 0;
+	for (int32 BucketIndex = 0; BucketIndex < NumBuckets; ++BucketIndex)
+	{
+		Seen += Buckets[BucketIndex];
+		if (Seen >= Wanted)
+		{
+			// Never report more than was actually seen, which matters for the overflow bucket
+			return FMath::Min((BucketIndex + 1) * BucketMs, MaxMs);
+		}
+	}
+	return MaxMs;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FCameraLatencyTracker
+
+bool FCameraLatencyTracker::IsEnabled()
+{
+	return CVarCameraLatencyTracking.GetValueOnGameThread() != 0;
+}
+
+void FCameraLatencyTracker::Record(const FCameraLatencyStamp& Stamp, double CommitTime, float LagSeconds)
+{
+	check(IsInGameThread());
+
+	const float ConsumeMs = (float)((Stamp.AppliedTime - Stamp.InputTime) * 1000.0);
+	const float ReadMs = (float)((Stamp.ReadTime - Stamp.AppliedTime) * 1000.0);
+	const float SolveMs = (float)((CommitTime - Stamp.ReadTime) * 1000.0);
+	const float PipelineMs = (float)((CommitTime - Stamp.InputTime) * 1000.0);
+
+	Histograms[(int32)ECameraLatencySpan::Consume].Add(ConsumeMs);
+	Histograms[(int32)ECameraLatencySpan::Read].Add(ReadMs);
+	Histograms[(int32)ECameraLatencySpan::Solve].Add(SolveMs);
+	Histograms[(int32)ECameraLatencySpan::Pipeline].Add(PipelineMs);
+
+	if (LagSeconds >= 0.f)
+	{
+		Histograms[(int32)ECameraLatencySpan::Lag].Add(LagSeconds * 1000.f);
+		Histograms[(int32)ECameraLatencySpan::Total].Add(PipelineMs + LagSeconds * 1000.f);
+	}
+
+	if (CVarCameraLatencyTracking.GetValueOnGameThread() > 1 && GEngine)
+	{
+		const FCameraLatencyHistogram& Pipeline = Histograms[(int32)ECameraLatencySpan::Pipeline];
+		const FCameraLatencyHistogram& Lag = Histograms[(int32)ECameraLatencySpan::Lag];
+		const FCameraLatencyHistogram& Total = Histograms[(int32)ECameraLatencySpan::Total];
+
+		// Fixed key, so each frame replaces the last frame's line instead of adding one
+		static const uint64 OnScreenKey = 0xCA3E0043;
+		GEngine->AddOnScreenDebugMessage(OnScreenKey, 1.f, FColor::Cyan, FString::Printf(
+			TEXT("Camera latency ms (p50/p95/p99)   pipeline %.1f/%.1f/%.1f   lag %.1f/%.1f/%.1f   total %.1f/%.1f/%.1f"),
+			Pipeline.GetPercentile(.5f), Pipeline.GetPercentile(.95f), Pipeline.GetPercentile(.99f),
+			Lag.GetPercentile(.5f), Lag.GetPercentile(.95f), Lag.GetPercentile(.99f),
+			Total.GetPercentile(.5f), Total.GetPercentile(.95f), Total.GetPercentile(.99f)));
+	}
+}
+
+float FCameraLatencyTracker::MeasureLag(const FRotator& Target, const FRotator& PreviousTarget, const FRotator& Committed, float DeltaTime)
+{
+	if (DeltaTime <= SMALL_NUMBER) { return -1.f; }
+
+	const float TurnRate = FMath::RadiansToDegrees(Target.Quaternion().AngularDistance(PreviousTarget.Quaternion())) / DeltaTime;
+	if (TurnRate < MinLagTurnRate) { return -1.f; }
+
+	return FMath::RadiansToDegrees(Target.Quaternion().AngularDistance(Committed.Quaternion())) / TurnRate;
+}
+
+const FCameraLatencyHistogram& FCameraLatencyTracker::GetHistogram(ECameraLatencySpan Span)
+{
+	return Histograms[(int32)Span];
+}
+
+void FCameraLatencyTracker::Reset()
+{
+	for (FCameraLatencyHistogram& Histogram : Histograms)
+	{
+		Histogram.Reset();
+	}
+}
+
+const TCHAR* FCameraLatencyTracker::GetSpanName(ECameraLatencySpan Span)
+{
+	switch (Span)
+	{
+	case ECameraLatencySpan::Consume:	return TEXT("Consume");
+	case ECameraLatencySpan::Read:		return TEXT("Read");
+	case ECameraLatencySpan::Solve:		return TEXT("Solve");
+	case ECameraLatencySpan::Pipeline:	return TEXT("Pipeline");
+	case ECameraLatencySpan::Lag:		return TEXT("Lag");
+	case ECameraLatencySpan::Total:		return TEXT("Total");
+	default:							return TEXT("Unknown");
+	}
+}
+
+bool FCameraLatencyTracker::ExportCsv(const FString& Filename)
+{
+	FString Csv = TEXT("Span,Frames,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs") LINE_TERMINATOR;
+	for (int32 SpanIndex = 0; SpanIndex < (int32)ECameraLatencySpan::Num; ++SpanIndex)
+	{
+		const FCameraLatencyHistogram& Histogram = Histograms[SpanIndex];
+		Csv += FString::Printf(TEXT("%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f") LINE_TERMINATOR, GetSpanName((ECameraLatencySpan)SpanIndex), Histogram.GetCount(),
+			Histogram.GetMean(), Histogram.GetPercentile(.5f), Histogram.GetPercentile(.95f), Histogram.GetPercentile(.99f), Histogram.GetMax());
+	}
+
+	// Buckets past the last one anything landed in are left out
+	int32 NumUsedBuckets = 0;
+	for (const FCameraLatencyHistogram& Histogram : Histograms)
+	{
+		for (int32 BucketIndex = FCameraLatencyHistogram::NumBuckets - 1; BucketIndex >= NumUsedBuckets; --BucketIndex)
+		{
+			if (Histogram.GetBuckets()[BucketIndex] > 0)
+			{
+				NumUsedBuckets = BucketIndex + 1;
+				break;
+			}
+		}
+	}
+
+	Csv += LINE_TERMINATOR;
+	Csv += TEXT("BucketStartMs");
+	for (int32 SpanIndex = 0; SpanIndex < (int32)ECameraLatencySpan::Num; ++SpanIndex)
+	{
+		Csv += TEXT(",");
+		Csv += GetSpanName((ECameraLatencySpan)SpanIndex);
+	}
+	Csv += LINE_TERMINATOR;
+
+	for (int32 BucketIndex = 0; BucketIndex < NumUsedBuckets; ++BucketIndex)
+	{
+		Csv += FString::Printf(TEXT("%.2f"), BucketIndex * FCameraLatencyHistogram::BucketMs);
+		for (const FCameraLatencyHistogram& Histogram : Histograms)
+		{
+			Csv += FString::Printf(TEXT(",%u"), Histogram.GetBuckets()[BucketIndex]);
+		}
+		Csv += LINE_TERMINATOR;
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
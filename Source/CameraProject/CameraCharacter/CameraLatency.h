@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Spans of the path from a look input to the camera it moves, measured per frame with input */
+enum class ECameraLatencySpan : uint8
+{
+	/** Input arriving until the character applied it to the controller */
+	Consume,
+	/** Applied until the spring arm read the rotation it produced as its target */
+	Read,
+	/** Read until the arm committed its socket */
+	Solve,
+	/** Input arriving until the commit: Consume, Read and Solve together */
+	Pipeline,
+	/** How far rotation lag keeps the committed rotation behind its target, as time at the target's current turn rate */
+	Lag,
+	/** Pipeline and Lag together */
+	Total,
+	Num
+};
+
+
+/** Latencies in fixed-width buckets, so recording never allocates and percentiles stay cheap */
+struct CAMERAPROJECT_API FCameraLatencyHistogram
+{
+	static const int32 NumBuckets = 2000;
+	static const float BucketMs;
+
+	void Add(float Ms);
+
+	void Reset();
+
+	/** Upper edge of the bucket Percentile (0..1) of the samples fall in */
+	float GetPercentile(float Percentile) const;
+
+	uint32 GetCount() const { return Count; }
+	float GetMean() const { return Count > 0 ? (float)(TotalMs / Count) : 0.f; }
+	float GetMax() const { return MaxMs; }
+
+	/** Samples in each bucket; the last one also holds everything longer than the histogram covers */
+	const uint32* GetBuckets() const { return Buckets; }
+
+private:
+	uint32 Buckets[NumBuckets] = {};
+	uint32 Count = 0;
+	double TotalMs = 0.0;
+	float MaxMs = 0.f;
+};
+
+
+/** Timestamps carried along with one frame's look input, all in FPlatformTime::Seconds */
+struct FCameraLatencyStamp
+{
+	/** When the oldest input applied this frame arrived; zero if the frame had no input */
+	double InputTime = 0.0;
+	/** When the character added it to the controller */
+	double AppliedTime = 0.0;
+	/** When the arm read the resulting target rotation */
+	double ReadTime = 0.0;
+
+	bool IsValid() const { return InputTime > 0.0; }
+};
+
+
+/**
+ * Session-wide latency histograms for look input, enabled with Camera.LatencyTracking. Characters stamp their input
+ * as they apply it and the spring arm records each stamped frame as it commits. Game thread only.
+ *
+ * Camera.LatencyReport logs the percentiles, Camera.LatencyCsv [File] exports them with the full histograms, and
+ * Camera.LatencyReset starts a new session. Camera.LatencyTracking 2 also keeps the percentiles on screen.
+ */
+struct CAMERAPROJECT_API FCameraLatencyTracker
+{
+	static bool IsEnabled();
+
+	/** Records one frame's latencies; LagSeconds is negative when the target wasn't turning fast enough to measure lag */
+	static void Record(const FCameraLatencyStamp& Stamp, double CommitTime, float LagSeconds);
+
+	/**
+	 * How long rotation lag keeps Committed behind Target, as the time Target takes to turn that far at the rate it
+	 * turned from PreviousTarget. Negative when Target turns too slowly for that to mean anything.
+	 */
+	static float MeasureLag(const FRotator& Target, const FRotator& PreviousTarget, const FRotator& Committed, float DeltaTime);
+
+	static const FCameraLatencyHistogram& GetHistogram(ECameraLatencySpan Span);
+
+	static void Reset();
+
+	static const TCHAR* GetSpanName(ECameraLatencySpan Span);
+
+	/** Writes the percentiles of every span, then every bucket of every histogram */
+	static bool ExportCsv(const FString& Filename);
+
+private:
+	static FCameraLatencyHistogram Histograms[(int32)ECameraLatencySpan::Num];
+};
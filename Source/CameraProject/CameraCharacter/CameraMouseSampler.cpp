@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraMouseSampler.h"
+#include "Input/Events.h"
+
+FCameraMouseSampler::FCameraMouseSampler()
+{
+	Samples.Reserve(MaxSamples);
+}
+
+bool FCameraMouseSampler::HandleMouseMoveEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent)
+{
+	const FVector2D Delta = MouseEvent.GetCursorDelta();
+	if (Delta.IsZero()) { return false; }
+
+	if (Samples.Num() < MaxSamples)
+	{
+		FCameraMouseSample& Sample = Samples.AddDefaulted_GetRef();
+		Sample.Time = FPlatformTime::Seconds();
+		Sample.Delta = Delta;
+	}
+	else
+	{
+		FCameraMouseSample& Newest = Samples.Last();
+		Newest.Time = FPlatformTime::Seconds();
+		Newest.Delta += Delta;
+	}
+
+	return false;
+}
+
+void FCameraMouseSampler::ConsumeSamples(TArray<FCameraMouseSample>& OutSamples)
+{
+	OutSamples.Reset();
+	OutSamples.Append(Samples);
+	Samples.Reset();
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Framework/Application/IInputProcessor.h"
+
+/**
+ * One raw mouse movement, stamped with the time Slate handled it. Slate handles a frame's OS messages together, so this
+ * is not when the movement happened; only their order means anything.
+ */
+struct FCameraMouseSample
+{
+	double Time = 0.0;
+	FVector2D Delta = FVector2D::ZeroVector;
+};
+
+/**
+ * Records every raw mouse movement Slate receives between frames, before the game viewport folds them into one
+ * axis value per frame. Registered as a Slate input pre-processor; it never consumes the events it sees.
+ */
+class CAMERAPROJECT_API FCameraMouseSampler : public IInputProcessor
+{
+public:
+	FCameraMouseSampler();
+
+	// IInputProcessor interface
+	virtual void Tick(const float DeltaTime, FSlateApplication& SlateApp, TSharedRef<ICursor> Cursor) override {}
+	virtual bool HandleMouseMoveEvent(FSlateApplication& SlateApp, const FPointerEvent& MouseEvent) override;
+	// End of IInputProcessor interface
+
+	/** Moves every sample recorded since the last call into OutSamples, oldest first */
+	void ConsumeSamples(TArray<FCameraMouseSample>& OutSamples);
+
+	/** Samples kept between frames; once full, new movement is merged into the newest sample */
+	static const int32 MaxSamples = 512;
+
+private:
+	TArray<FCameraMouseSample> Samples;
+};
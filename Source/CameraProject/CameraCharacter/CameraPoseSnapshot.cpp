@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraPoseSnapshot.h"
+#include "HAL/PlatformProcess.h"
+
+void FCameraPoseSnapshotBuffer::Publish(const FCameraPoseSnapshot& NewSnapshot)
+{
+	check(IsInGameThread());
+
+	// Interlocked operations are full barriers, so the copy can't move outside the odd window
+	FPlatformAtomics::InterlockedIncrement(&Sequence);
+	Snapshot = NewSnapshot;
+	FPlatformAtomics::InterlockedIncrement(&Sequence);
+}
+
+bool FCameraPoseSnapshotBuffer::Read(FCameraPoseSnapshot& OutSnapshot) const
+{
+	for (;;)
+	{
+		const int32 Before = FPlatformAtomics::AtomicRead(&Sequence);
+		if (Before & 1)
+		{
+			// Mid-publish; the game thread finishes the copy almost at once
+			FPlatformProcess::Yield();
+			continue;
+		}
+
+		FPlatformMisc::MemoryBarrier();
+		OutSnapshot = Snapshot;
+		FPlatformMisc::MemoryBarrier();
+
+		if (FPlatformAtomics::AtomicRead(&Sequence) == Before)
+		{
+			return OutSnapshot.bValid;
+		}
+	}
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Camera pose as of one spring arm commit; plain data, so copying it is all a reader does */
+struct FCameraPoseSnapshot
+{
+	/** World transform of the arm's socket, where the camera is */
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+
+	/** Where the camera would be without the collision test pulling it in */
+	FVector UnfixedLocation = FVector::ZeroVector;
+
+	/** Velocity of the camera between the last two commits, and how fast its rotation was changing in degrees per second */
+	FVector Velocity = FVector::ZeroVector;
+	FRotator AngularVelocity = FRotator::ZeroRotator;
+
+	/** The collision test pulled the camera in */
+	bool bCollisionFixApplied = false;
+	/** The collision test ran this update and found something */
+	bool bHitSomething = false;
+	/** How far along the arm the hit was, 1 when nothing was hit */
+	float HitTime = 1.f;
+
+	/** World time and engine frame of the commit */
+	double WorldTime = 0.0;
+	uint64 FrameNumber = 0;
+
+	/** False until the arm has committed once */
+	bool bValid = false;
+
+	FTransform GetTransform() const { return FTransform(Rotation, Location); }
+};
+
+
+/**
+ * Seqlock around the last committed FCameraPoseSnapshot, so audio, AI perception and UI threads can read a
+ * consistent pose without locking or marshalling to the game thread. The spring arm is the only writer; readers
+ * retry if they raced a publish, which only happens while the few dozen bytes of one are being copied.
+ *
+ * Held through a thread-safe shared pointer, so a reader on another thread can keep it after the arm is destroyed.
+ */
+class CAMERAPROJECT_API FCameraPoseSnapshotBuffer
+{
+public:
+	/** Replaces the published pose. Only the owning arm calls this, on the game thread. */
+	void Publish(const FCameraPoseSnapshot& Snapshot);
+
+	/** Copies the last published pose into OutSnapshot from any thread; false if nothing has been published yet */
+	bool Read(FCameraPoseSnapshot& OutSnapshot) const;
+
+	/** Increases every publish; readers can compare it to tell whether the pose changed since they last looked */
+	uint32 GetVersion() const { return (uint32)FPlatformAtomics::AtomicRead(&Sequence) >> 1; }
+
+private:
+	/** Odd while a publish is in progress */
+	volatile int32 Sequence = 0;
+
+	FCameraPoseSnapshot Snapshot;
+};
@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraRigPreset.h"
+
+FCameraRigSettings::FCameraRigSettings()
+{
+	ProbeSize = 12.0f;
+	CameraLagSpeed = 10.f;
+	CameraRotationLagSpeed = 10.f;
+	CameraLagMaxTimeStep = 1.f / 60.f;
+	CameraLagMaxDistance = 0.f;
+	ProbeClearanceThreshold = 100.f;
+	ProbeRefreshInterval = 10;
+	OccluderFadeParameter = TEXT("CameraFade");
+	OccludedFadeValue = 0.25f;
+	ProbeChannel = ECC_Camera;
+	CollisionResponse = ECameraCollisionResponse::PullIn;
+
+	bDoCollisionTest = true;
+	bAdaptiveProbe = true;
+	bInheritPitch = true;
+	bInheritYaw = true;
+	bInheritRoll = true;
+	bEnableCameraLag = false;
+	bEnableCameraRotationLag = false;
+	bUseCameraLagSubstepping = true;
+}
+
+void FCameraRigSettings::ApplyOverride(ECameraRigOverride Field, float Value)
+{
+	const bool bFlag = Value != 0.f;
+
+	switch (Field)
+	{
+	case ECameraRigOverride::DoCollisionTest:			bDoCollisionTest = bFlag; break;
+	case ECameraRigOverride::ProbeSize:					ProbeSize = Value; break;
+	case ECameraRigOverride::ProbeChannel:				ProbeChannel = (ECollisionChannel)FMath::Clamp(FMath::RoundToInt(Value), 0, (int32)ECC_MAX - 1); break;
+	case ECameraRigOverride::InheritPitch:				bInheritPitch = bFlag; break;
+	case ECameraRigOverride::InheritYaw:				bInheritYaw = bFlag; break;
+	case ECameraRigOverride::InheritRoll:				bInheritRoll = bFlag; break;
+	case ECameraRigOverride::EnableCameraLag:			bEnableCameraLag = bFlag; break;
+	case ECameraRigOverride::EnableCameraRotationLag:	bEnableCameraRotationLag = bFlag; break;
+	case ECameraRigOverride::UseCameraLagSubstepping:	bUseCameraLagSubstepping = bFlag; break;
+	case ECameraRigOverride::CameraLagSpeed:			CameraLagSpeed = Value; break;
+	case ECameraRigOverride::CameraRotationLagSpeed:	CameraRotationLagSpeed = Value; break;
+	case ECameraRigOverride::CameraLagMaxTimeStep:		CameraLagMaxTimeStep = Value; break;
+	case ECameraRigOverride::CameraLagMaxDistance:		CameraLagMaxDistance = Value; break;
+	case ECameraRigOverride::AdaptiveProbe:				bAdaptiveProbe = bFlag; break;
+	case ECameraRigOverride::ProbeClearanceThreshold:	ProbeClearanceThreshold = Value; break;
+	case ECameraRigOverride::ProbeRefreshInterval:		ProbeRefreshInterval = FMath::Max(FMath::RoundToInt(Value), 1); break;
+	case ECameraRigOverride::CollisionResponse:			CollisionResponse = bFlag ? ECameraCollisionResponse::FadeOccluders : ECameraCollisionResponse::PullIn; break;
+	case ECameraRigOverride::OccludedFadeValue:			OccludedFadeValue = Value; break;
+	default: break;
+	}
+}
+
+uint32 FCameraRigSettings::GetSettingsHash() const
+{
+	const uint32 Flags =
+		(bDoCollisionTest << 0) | (bInheritPitch << 1) | (bInheritYaw << 2) | (bInheritRoll << 3) |
+		(bEnableCameraLag << 4) | (bEnableCameraRotationLag << 5) | (bUseCameraLagSubstepping << 6) | (bAdaptiveProbe << 7);
+
+	uint32 Hash = GetTypeHash(ProbeSize);
+	Hash = HashCombine(Hash, GetTypeHash(CameraLagSpeed));
+	Hash = HashCombine(Hash, GetTypeHash(CameraRotationLagSpeed));
+	Hash = HashCombine(Hash, GetTypeHash(CameraLagMaxTimeStep));
+	Hash = HashCombine(Hash, GetTypeHash(CameraLagMaxDistance));
+	Hash = HashCombine(Hash, GetTypeHash(ProbeClearanceThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(ProbeRefreshInterval));
+	Hash = HashCombine(Hash, GetTypeHash(OccluderFadeParameter));
+	Hash = HashCombine(Hash, GetTypeHash(OccludedFadeValue));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)ProbeChannel));
+	Hash = HashCombine(Hash, GetTypeHash((uint8)CollisionResponse));
+	return HashCombine(Hash, Flags);
+}
+
+bool FCameraRigSettings::operator==(const FCameraRigSettings& Other) const
+{
+	return ProbeSize == Other.ProbeSize
+		&& CameraLagSpeed == Other.CameraLagSpeed
+		&& CameraRotationLagSpeed == Other.CameraRotationLagSpeed
+		&& CameraLagMaxTimeStep == Other.CameraLagMaxTimeStep
+		&& CameraLagMaxDistance == Other.CameraLagMaxDistance
+		&& ProbeClearanceThreshold == Other.ProbeClearanceThreshold
+		&& ProbeRefreshInterval == Other.ProbeRefreshInterval
+		&& OccluderFadeParameter == Other.OccluderFadeParameter
+		&& OccludedFadeValue == Other.OccludedFadeValue
+		&& ProbeChannel == Other.ProbeChannel
+		&& CollisionResponse == Other.CollisionResponse
+		&& bDoCollisionTest == Other.bDoCollisionTest
+		&& bAdaptiveProbe == Other.bAdaptiveProbe
+		&& bInheritPitch == Other.bInheritPitch
+		&& bInheritYaw == Other.bInheritYaw
+		&& bInheritRoll == Other.bInheritRoll
+		&& bEnableCameraLag == Other.bEnableCameraLag
+		&& bEnableCameraRotationLag == Other.bEnableCameraRotationLag
+		&& bUseCameraLagSubstepping == Other.bUseCameraLagSubstepping;
+}
+
+namespace
+{
+	/** A resolved combination of preset and overrides, shared by every arm that resolves to it */
+	struct FPooledRigSettings
+	{
+		explicit FPooledRigSettings(const FCameraRigSettings& InSettings) : Settings(InSettings) {}
+
+		FCameraRigSettings Settings;
+		int32 RefCount = 1;
+	};
+
+	/** Pooled settings by hash; an entry lives as long as some arm still points at it */
+	TMultiMap<uint32, TUniquePtr<FPooledRigSettings>>& GetSettingsPool()
+	{
+		static TMultiMap<uint32, TUniquePtr<FPooledRigSettings>> SettingsPool;
+		return SettingsPool;
+	}
+}
+
+const FCameraRigSettings& UCameraRigPreset::GetDefaultSettings()
+{
+	static const FCameraRigSettings DefaultSettings;
+	return DefaultSettings;
+}
+
+const FCameraAutoCorrectSettings& UCameraRigPreset::GetDefaultAutoCorrect()
+{
+	static const FCameraAutoCorrectSettings DefaultAutoCorrect;
+	return DefaultAutoCorrect;
+}
+
+const FCameraRigSettings* UCameraRigPreset::ResolveSettings(const UCameraRigPreset* Preset, const TArray<FCameraRigOverride>& Overrides)
+{
+	const FCameraRigSettings& BaseSettings = Preset ? Preset->Settings : GetDefaultSettings();
+	if (Overrides.Num() == 0)
+	{
+		return &BaseSettings;
+	}
+
+	check(IsInGameThread());
+
+	FCameraRigSettings Resolved = BaseSettings;
+	for (const FCameraRigOverride& Override : Overrides)
+	{
+		Resolved.ApplyOverride(Override.Field, Override.Value);
+	}
+
+	const uint32 Hash = Resolved.GetSettingsHash();
+	for (auto It = GetSettingsPool().CreateKeyIterator(Hash); It; ++It)
+	{
+		if (It.Value()->Settings == Resolved)
+		{
+			++It.Value()->RefCount;
+			return &It.Value()->Settings;
+		}
+	}
+
+	FPooledRigSettings* Pooled = GetSettingsPool().Add(Hash, MakeUnique<FPooledRigSettings>(Resolved)).Get();
+	return &Pooled->Settings;
+}
+
+void UCameraRigPreset::ReleaseSettings(const FCameraRigSettings* Settings)
+{
+	// Preset and default settings never match a pool entry by address, so releasing them does nothing
+	if (!Settings)
+	{
+		return;
+	}
+
+	check(IsInGameThread());
+
+	for (auto It = GetSettingsPool().CreateKeyIterator(Settings->GetSettingsHash()); It; ++It)
+	{
+		if (&It.Value()->Settings == Settings)
+		{
+			if (--It.Value()->RefCount == 0)
+			{
+				It.RemoveCurrent();
+			}
+			return;
+		}
+	}
+}
+
+void UCameraRigPreset::GetPoolStats(int32& OutNumSettings, SIZE_T& OutBytes)
+{
+	OutNumSettings = GetSettingsPool().Num();
+	OutBytes = GetSettingsPool().GetAllocatedSize() + OutNumSettings * sizeof(FPooledRigSettings);
+}
+
+#if WITH_EDITOR
+void UCameraRigPreset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	++Revision;
+}
+#endif
@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Engine/EngineTypes.h"
+#include "CameraRigPreset.generated.h"
+
+
+/** Individual tuning values of a camera rig that a single spring arm may override locally */
+UENUM(BlueprintType)
+enum class ECameraRigOverride : uint8
+{
+	None UMETA(Hidden),
+	DoCollisionTest,
+	ProbeSize,
+	ProbeChannel,
+	InheritPitch,
+	InheritYaw,
+	InheritRoll,
+	EnableCameraLag,
+	EnableCameraRotationLag,
+	UseCameraLagSubstepping,
+	CameraLagSpeed,
+	CameraRotationLagSpeed,
+	CameraLagMaxTimeStep,
+	CameraLagMaxDistance,
+	AdaptiveProbe,
+	ProbeClearanceThreshold,
+	ProbeRefreshInterval,
+	CollisionResponse,
+	OccludedFadeValue,
+};
+
+
+/** What a spring arm does when its collision test finds geometry between the camera and the target */
+UENUM(BlueprintType)
+enum class ECameraCollisionResponse : uint8
+{
+	/** Pull the camera in front of the first blocking hit */
+	PullIn,
+	/** Keep the arm length and fade every primitive between the camera and the target */
+	FadeOccluders,
+};
+
+
+/**
+ * Tuning shared by every spring arm that references the same preset.
+ * Nothing in here changes at runtime, so one copy can back any number of arms.
+ */
+USTRUCT(BlueprintType)
+struct CAMERAPROJECT_API FCameraRigSettings
+{
+	GENERATED_BODY()
+
+	FCameraRigSettings();
+
+	/** How big should the query probe sphere be (in unreal units) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
+		float ProbeSize;
+
+	/** If bEnableCameraLag is true, controls how quickly camera reaches target position. Low values are slower (more lag), high values are faster (less lag), while zero is instant (no lag). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag, meta = (editcondition = "bEnableCameraLag", ClampMin = "0.0", ClampMax = "1000.0", UIMin = "0.0", UIMax = "1000.0"))
+		float CameraLagSpeed;
+
+	/** If bEnableCameraRotationLag is true, controls how quickly camera reaches target position. Low values are slower (more lag), high values are faster (less lag), while zero is instant (no lag). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag, meta = (editcondition = "bEnableCameraRotationLag", ClampMin = "0.0", ClampMax = "1000.0", UIMin = "0.0", UIMax = "1000.0"))
+		float CameraRotationLagSpeed;
+
+	/** Max time step used when sub-stepping camera lag. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag, AdvancedDisplay, meta = (editcondition = "bUseCameraLagSubstepping", ClampMin = "0.005", ClampMax = "0.5", UIMin = "0.005", UIMax = "0.5"))
+		float CameraLagMaxTimeStep;
+
+	/** Max distance the camera target may lag behind the current location. If set to zero, no max distance is enforced. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag, meta = (editcondition = "bEnableCameraLag", ClampMin = "0.0", UIMin = "0.0"))
+		float CameraLagMaxDistance;
+
+	/**
+	 * With bAdaptiveProbe, how far beyond ProbeSize the periodic refresh sweep looks for geometry. While nothing is
+	 * closer than this, the arm may move by up to this much before it has to sweep a sphere again.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, AdvancedDisplay, meta = (editcondition = "bAdaptiveProbe", ClampMin = "0.0", UIMin = "0.0"))
+		float ProbeClearanceThreshold;
+
+	/** With bAdaptiveProbe, the most frames the probe may go without a full sweep along the whole arm */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, AdvancedDisplay, meta = (editcondition = "bAdaptiveProbe", ClampMin = "1", UIMin = "1"))
+		int32 ProbeRefreshInterval;
+
+	/** With FadeOccluders, scalar material parameter set on occluding primitives; their materials need to read it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
+		FName OccluderFadeParameter;
+
+	/** With FadeOccluders, value OccluderFadeParameter is set to while a primitive is occluding; it goes back to 1 once it is not */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest", ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0"))
+		float OccludedFadeValue;
+
+	/** Collision channel of the query probe (defaults to ECC_Camera) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
+		TEnumAsByte<ECollisionChannel> ProbeChannel;
+
+	/** Whether geometry found by the collision test pulls the camera in or gets faded out */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
+		ECameraCollisionResponse CollisionResponse;
+
+	/** If true, do a collision test using ProbeChannel and ProbeSize to prevent camera clipping into level.  */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision)
+		uint8 bDoCollisionTest : 1;
+
+	/**
+	 * If true, the collision test picks the cheapest query the last frames allow: a line trace while geometry is known
+	 * to be further than ProbeClearanceThreshold away, a sweep of only the part of the arm in front of last frame's hit,
+	 * and the full sphere sweep otherwise. Every ProbeRefreshInterval frames the whole arm is swept again.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraCollision, AdvancedDisplay, meta = (editcondition = "bDoCollisionTest"))
+		uint8 bAdaptiveProbe : 1;
+
+	/** Should we inherit pitch from parent component. Does nothing if using Absolute Rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraSettings)
+		uint8 bInheritPitch : 1;
+
+	/** Should we inherit yaw from parent component. Does nothing if using Absolute Rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraSettings)
+		uint8 bInheritYaw : 1;
+
+	/** Should we inherit roll from parent component. Does nothing if using Absolute Rotation. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = CameraSettings)
+		uint8 bInheritRoll : 1;
+
+	/** If true, camera lags behind target position to smooth its movement. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag)
+		uint8 bEnableCameraLag : 1;
+
+	/** If true, camera lags behind target rotation to smooth its movement. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag)
+		uint8 bEnableCameraRotationLag : 1;
+
+	/** Sub-step camera damping so that it handles fluctuating frame rates well (though this comes at a cost). */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Lag, AdvancedDisplay)
+		uint8 bUseCameraLagSubstepping : 1;
+
+	/** Writes a single overridden value into these settings */
+	void ApplyOverride(ECameraRigOverride Field, float Value);
+
+	/** Hash of every tuning value, used to share identical resolved settings between arms */
+	uint32 GetSettingsHash() const;
+
+	bool operator==(const FCameraRigSettings& Other) const;
+};
+
+
+/** Settings ACameraProjectCharacter uses when it automatically moves the camera back into place */
+USTRUCT(BlueprintType)
+struct CAMERAPROJECT_API FCameraAutoCorrectSettings
+{
+	GENERATED_BODY()
+
+	// If we want to move in a set amount of time, set this value to 0 or greater; otherwise, the transform will change at an adjustable speed
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera")
+		float AutoAdjustTime = -1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera")
+		float AutoTurnRate = 5;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera")
+		float AutoMoveRate = 700;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct")
+		bool bAutoCorrectCameraRotationYaw = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct")
+		bool bAutoCorrectCameraRotationPitch = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct")
+		bool bAutoCorrectCameraRotationRoll = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct")
+		FVector AutoCorrectCameraLocation = FVector(1, 1, 1);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct")
+		FVector AutoCorrectSocketOffset = FVector(1, 1, 1);
+};
+
+
+/** One locally overridden value of a camera rig preset */
+USTRUCT(BlueprintType)
+struct CAMERAPROJECT_API FCameraRigOverride
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Camera)
+		ECameraRigOverride Field = ECameraRigOverride::None;
+
+	/** Value written into the field; flags and CollisionResponse use zero / non-zero, channels use the channel index */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Camera)
+		float Value = 0.f;
+};
+
+
+/**
+ * One named camera setup a spring arm can switch to, such as exploration, aim or cover. Only the arm's active rig
+ * is simulated, plus the outgoing one while blending, so rigs that aren't in use cost nothing but their memory.
+ */
+USTRUCT(BlueprintType)
+struct CAMERAPROJECT_API FCameraRig
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Rig)
+		FName Name;
+
+	/** Lag and probe tuning while this rig is active; the arm's RigOverrides still apply on top */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Rig)
+		UCameraRigPreset* Preset = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Rig)
+		float TargetArmLength = 300.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Rig)
+		FVector SocketOffset = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Rig)
+		FVector TargetOffset = FVector::ZeroVector;
+};
+
+
+/**
+ * Shared, immutable tuning for a camera rig. Spring arms reference one of these instead of
+ * carrying their own copy of every lag and probe value, and only store the few values they override.
+ */
+UCLASS(BlueprintType)
+class CAMERAPROJECT_API UCameraRigPreset : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Rig", meta = (ShowOnlyInnerProperties))
+		FCameraRigSettings Settings;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Auto Correct", meta = (ShowOnlyInnerProperties))
+		FCameraAutoCorrectSettings AutoCorrect;
+
+	/** Bumped whenever the preset is edited so arms know to resolve their settings again */
+	uint32 GetRevision() const { return Revision; }
+
+	/** Settings used by arms that do not reference a preset */
+	static const FCameraRigSettings& GetDefaultSettings();
+	static const FCameraAutoCorrectSettings& GetDefaultAutoCorrect();
+
+	/**
+	 * Returns settings for Preset with Overrides applied. Arms without overrides get the preset's own
+	 * settings, and arms with identical overrides share a single pooled copy. Every result must be
+	 * handed back to ReleaseSettings once the caller stops using it.
+	 */
+	static const FCameraRigSettings* ResolveSettings(const UCameraRigPreset* Preset, const TArray<FCameraRigOverride>& Overrides);
+
+	/** Drops a reference taken by ResolveSettings; pooled copies are freed when the last arm using them lets go */
+	static void ReleaseSettings(const FCameraRigSettings* Settings);
+
+	/** Number of pooled copies and the bytes they take up, for Camera.RigMemory */
+	static void GetPoolStats(int32& OutNumSettings, SIZE_T& OutBytes);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	uint32 Revision = 0;
+};
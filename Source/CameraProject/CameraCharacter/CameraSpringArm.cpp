@@ -6,6 +6,103 @@
 #include "WorldCollision.h"
 #include "Engine/World.h"
 #include "DrawDebugHelpers.h"
+#include "Components/PrimitiveComponent.h"
+#include "CameraStats.h"
+#include "CameraArmSubsystem.h"
+#include "CameraProject.h"
+#include "CameraFastMath.h"
+#include "CameraConstraintSubsystem.h"
+#include "CameraCollisionProxy.h"
+#include "HAL/IConsoleManager.h"
+#include "Camera/CameraComponent.h"
+#include "UObject/UObjectIterator.h"
+
+static TAutoConsoleVariable<int32> CVarCameraAdaptiveProbe(
+	TEXT("Camera.AdaptiveProbe"),
+	1,
+	TEXT("0: spring arms always sweep the whole arm. 1: arms whose rig enables bAdaptiveProbe pick the cheapest safe query."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCameraSpecializedSolvers(
+	TEXT("Camera.SpecializedSolvers"),
+	1,
+	TEXT("0: spring arms solve lag with the generic solver and always call BlendLocations through the vtable, as the reference path.\n")
+	TEXT("1: arms use the lag solver and resolve stage specialized for their rig and class."),
+	ECVF_Default);
+
+/** Serial the solvers are picked against, bumped when a console variable they depend on changes */
+static uint32 GCameraSolverSelectionSerial = 1;
+
+static void OnCameraSolverVariablesChanged()
+{
+	static int32 LastSpecializedSolvers = INDEX_NONE;
+	static int32 LastFastTrig = INDEX_NONE;
+
+	const int32 SpecializedSolvers = CVarCameraSpecializedSolvers.GetValueOnGameThread();
+	const int32 FastTrig = FCameraFastMath::IsEnabled() ? 1 : 0;
+	if (SpecializedSolvers != LastSpecializedSolvers || FastTrig != LastFastTrig)
+	{
+		LastSpecializedSolvers = SpecializedSolvers;
+		LastFastTrig = FastTrig;
+		++GCameraSolverSelectionSerial;
+	}
+}
+
+static FAutoConsoleVariableSink CCameraSolverVariablesSink(FConsoleCommandDelegate::CreateStatic(&OnCameraSolverVariablesChanged));
+
+static TAutoConsoleVariable<int32> CVarCameraEditorUpdatePolicy(
+	TEXT("Camera.EditorUpdatePolicy"),
+	1,
+	TEXT("How spring arms placed in editor levels update outside of PIE.\n")
+	TEXT("0: every editor tick.\n")
+	TEXT("1: every tick while selected or recently rendered in a viewport, otherwise only after they move or are edited.\n")
+	TEXT("2: every tick while selected, otherwise only after they move or are edited."),
+	ECVF_Default);
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraRig, Log, All);
+
+static FAutoConsoleCommand CameraRigMemoryCommand(
+	TEXT("Camera.RigMemory"),
+	TEXT("Logs the memory rig settings take up across every live spring arm, including the pooled override settings."),
+	FConsoleCommandDelegate::CreateStatic(&UCameraSpringArm::LogRigMemory));
+
+/** Seconds since an editor viewport last drew an arm's actor for it to still count as visible */
+static const float EditorVisibleTolerance = 0.5f;
+
+/** How quickly measured view velocities follow new measurements, per second */
+static const float ViewMotionSmoothing = 10.f;
+
+/** Fraction of ProbeSize the arm may drift before the part of it in front of the last hit has to be swept again */
+static const float ProbeDriftTolerance = 0.25f;
+
+//////////////////////////////////////////////////////////////////////////
+// FCameraInputCurve
+
+void FCameraInputCurve::AddKnot(float Alpha, const FRotator& Offset)
+{
+	const int32 KnotIndex = FMath::Min(NumKnots, MaxKnots - 1);
+	Alphas[KnotIndex] = FMath::Clamp(Alpha, KnotIndex > 0 ? Alphas[KnotIndex - 1] : 0.f, 1.f);
+	Offsets[KnotIndex] = Offset;
+	NumKnots = KnotIndex + 1;
+}
+
+FRotator FCameraInputCurve::Evaluate(float Alpha) const
+{
+	float PreviousAlpha = 0.f;
+	FRotator PreviousOffset = FRotator::ZeroRotator;
+	for (int32 KnotIndex = 0; KnotIndex < NumKnots; ++KnotIndex)
+	{
+		if (Alpha <= Alphas[KnotIndex])
+		{
+			const float Span = Alphas[KnotIndex] - PreviousAlpha;
+			const float SpanAlpha = Span > KINDA_SMALL_NUMBER ? (Alpha - PreviousAlpha) / Span : 1.f;
+			return PreviousOffset + (Offsets[KnotIndex] - PreviousOffset) * SpanAlpha;
+		}
+		PreviousAlpha = Alphas[KnotIndex];
+		PreviousOffset = Offsets[KnotIndex];
+	}
+	return GetTotal();
+}
 
 //////////////////////////////////////////////////////////////////////////
 // USpringArmComponent
@@ -16,30 +113,185 @@ UCameraSpringArm::UCameraSpringArm(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+	PrimaryComponentTick.TickGroup = CameraTickGroup;
 
 	bAutoActivate = true;
 	bTickInEditor = true;
 	bUsePawnControlRotation = false;
-	bDoCollisionTest = true;
-
-	bInheritPitch = true;
-	bInheritYaw = true;
-	bInheritRoll = true;
 
 	TargetArmLength = 300.0f;
-	ProbeSize = 12.0f;
-	ProbeChannel = ECC_Camera;
+	RigPreset = nullptr;
+	ActiveResolver = &UCameraSpringArm::ResolveFrameSpecialized<false>;
+
+	bDirectViewOutput = false;
+
+	FramingTargetRadius = 100.f;
+	FramingMinArmLength = 300.f;
+	FramingMaxArmLength = 3000.f;
+	FramingPitch = -40.f;
+	FramingFieldOfView = 90.f;
+	FramingAspectRatio = 16.f / 9.f;
+	bRecordHistory = false;
+	HistorySeconds = 30.f;
+	HistorySampleRate = 60.f;
 
 	RelativeSocketRotation = FQuat::Identity;
 
-	bUseCameraLagSubstepping = true;
-	CameraLagSpeed = 10.f;
-	CameraRotationLagSpeed = 10.f;
-	CameraLagMaxTimeStep = 1.f / 60.f;
-	CameraLagMaxDistance = 0.f;
+#if WITH_EDITORONLY_DATA
+	// Old data only differs from these where it was actually tuned, which is all the migration carries over
+	const FCameraRigSettings& Defaults = UCameraRigPreset::GetDefaultSettings();
+	ProbeSize_DEPRECATED = Defaults.ProbeSize;
+	ProbeChannel_DEPRECATED = Defaults.ProbeChannel;
+	bDoCollisionTest_DEPRECATED = Defaults.bDoCollisionTest;
+	bInheritPitch_DEPRECATED = Defaults.bInheritPitch;
+	bInheritYaw_DEPRECATED = Defaults.bInheritYaw;
+	bInheritRoll_DEPRECATED = Defaults.bInheritRoll;
+	bEnableCameraLag_DEPRECATED = Defaults.bEnableCameraLag;
+	bEnableCameraRotationLag_DEPRECATED = Defaults.bEnableCameraRotationLag;
+	bUseCameraLagSubstepping_DEPRECATED = Defaults.bUseCameraLagSubstepping;
+	CameraLagSpeed_DEPRECATED = Defaults.CameraLagSpeed;
+	CameraRotationLagSpeed_DEPRECATED = Defaults.CameraRotationLagSpeed;
+	CameraLagMaxTimeStep_DEPRECATED = Defaults.CameraLagMaxTimeStep;
+	CameraLagMaxDistance_DEPRECATED = Defaults.CameraLagMaxDistance;
+#endif
+
+	PoseSnapshot = MakeShared<FCameraPoseSnapshotBuffer, ESPMode::ThreadSafe>();
+}
+
+void UCameraSpringArm::ResolveRigSettings()
+{
+	RigOverrideMask = 0;
+	for (const FCameraRigOverride& Override : RigOverrides)
+	{
+		RigOverrideMask |= 1u << (uint32)Override.Field;
+	}
+
+	// Resolve before releasing, so an arm whose settings didn't change keeps its pooled copy alive
+	const FCameraRigSettings* PreviousSettings = ActiveRigSettings;
+	ActiveRigSettings = UCameraRigPreset::ResolveSettings(RigPreset, RigOverrides);
+	UCameraRigPreset::ReleaseSettings(PreviousSettings);
+	SelectSolvers();
+
+#if WITH_EDITORONLY_DATA
+	ResolvedPresetRevision = RigPreset ? RigPreset->GetRevision() : 0;
+	bEditorUpdatePending = true;
+#endif
+}
+
+void UCameraSpringArm::SelectSolvers()
+{
+	ActiveLagSolvers = FCameraLagSolvers::Select(GetRigSettings());
+
+	// The generic solver is the reference for the specialized ones, so it keeps the virtual call as well
+	const bool bDefaultBlend = !ActiveLagSolvers.bGeneric && !MayOverrideBlendLocations();
+	ActiveResolver = bDefaultBlend ? &UCameraSpringArm::ResolveFrameSpecialized<true> : &UCameraSpringArm::ResolveFrameSpecialized<false>;
+
+	if (RigBlend)
+	{
+		RigBlend->LagSolvers = FCameraLagSolvers::Select(RigBlend->Settings);
+	}
+}
 
-	UnfixedCameraPosition = FVector::ZeroVector;
+bool UCameraSpringArm::MayOverrideBlendLocations() const
+{
+	// Blueprint classes can't override it, so what matters is the nearest native class
+	const UClass* NativeClass = GetClass();
+	while (NativeClass && !NativeClass->HasAnyClassFlags(CLASS_Native))
+	{
+		NativeClass = NativeClass->GetSuperClass();
+	}
+	return NativeClass != UCameraSpringArm::StaticClass();
+}
+
+bool UCameraSpringArm::SetActiveRig(FName RigName, float BlendTime)
+{
+	const FCameraRig* NewRig = Rigs.FindByPredicate([RigName](const FCameraRig& Rig) { return Rig.Name == RigName; });
+	if (!NewRig) { return false; }
+
+	// Whatever drives the arm now becomes the outgoing rig, starting from where its lag left off
+	if (BlendTime > 0.f)
+	{
+		if (!RigBlend)
+		{
+			RigBlend = MakeUnique<FCameraRigBlend>();
+		}
+		RigBlend->Settings = GetRigSettings();
+		RigBlend->ArmLength = TargetArmLength;
+		RigBlend->SocketOffset = ActualSocketOffset;
+		RigBlend->TargetOffset = TargetOffset;
+		RigBlend->LagState = ArmState;
+		RigBlend->LagSolvers = ActiveLagSolvers;
+		RigBlend->Duration = BlendTime;
+		RigBlend->Elapsed = 0.f;
+	}
+	else
+	{
+		RigBlend.Reset();
+	}
+
+	ActiveRigName = RigName;
+	TargetArmLength = NewRig->TargetArmLength;
+	ActualSocketOffset = NewRig->SocketOffset;
+	TargetOffset = NewRig->TargetOffset;
+	SetRigPreset(NewRig->Preset);
+
+	// ArmState's lag is kept as the new rig's warm start; only what the probe learned has to go, as its shape may differ
+	ArmState.bProbeHadHit = false;
+	ArmState.ProbeMargin = 0.f;
+	ArmState.FramesSinceProbeRefresh = MAX_int32;
+	return true;
+}
+
+void UCameraSpringArm::SetRigPreset(UCameraRigPreset* NewPreset)
+{
+	RigPreset = NewPreset;
+	ResolveRigSettings();
+}
+
+void UCameraSpringArm::SetInputCurve(const FCameraInputCurve& Curve)
+{
+	if (!PendingInputCurve)
+	{
+		PendingInputCurve = MakeUnique<FCameraInputCurve>();
+	}
+	*PendingInputCurve = Curve;
+}
+
+void UCameraSpringArm::SetRigOverride(ECameraRigOverride Field, float Value)
+{
+	FCameraRigOverride* Existing = RigOverrides.FindByPredicate([Field](const FCameraRigOverride& Override) { return Override.Field == Field; });
+	if (Existing)
+	{
+		Existing->Value = Value;
+	}
+	else
+	{
+		FCameraRigOverride NewOverride;
+		NewOverride.Field = Field;
+		NewOverride.Value = Value;
+		RigOverrides.Add(NewOverride);
+	}
+	ResolveRigSettings();
+}
+
+void UCameraSpringArm::ClearRigOverride(ECameraRigOverride Field)
+{
+	RigOverrides.RemoveAll([Field](const FCameraRigOverride& Override) { return Override.Field == Field; });
+	ResolveRigSettings();
+}
+
+void UCameraSpringArm::SetRecordHistory(bool bRecord)
+{
+	bRecordHistory = bRecord;
+
+	if (!bRecordHistory)
+	{
+		History.Reset();
+	}
+	else if (!History && IsRegistered() && GetWorld()->IsGameWorld() && GetNetMode() != NM_DedicatedServer)
+	{
+		History = MakeUnique<FCameraHistory>(HistorySeconds, HistorySampleRate);
+	}
 }
 
 FRotator UCameraSpringArm::GetDesiredRotation() const
@@ -49,6 +301,7 @@ FRotator UCameraSpringArm::GetDesiredRotation() const
 
 FRotator UCameraSpringArm::GetTargetRotation() const
 {
+	const FCameraRigSettings& Rig = GetRigSettings();
 	FRotator DesiredRot = GetDesiredRotation();
 
 	if (bUsePawnControlRotation)
@@ -67,17 +320,17 @@ FRotator UCameraSpringArm::GetTargetRotation() const
 	if (!IsUsingAbsoluteRotation())
 	{
 		const FRotator LocalRelativeRotation = GetRelativeRotation();
-		if (!bInheritPitch)
+		if (!Rig.bInheritPitch)
 		{
 			DesiredRot.Pitch = LocalRelativeRotation.Pitch;
 		}
 
-		if (!bInheritYaw)
+		if (!Rig.bInheritYaw)
 		{
 			DesiredRot.Yaw = LocalRelativeRotation.Yaw;
 		}
 
-		if (!bInheritRoll)
+		if (!Rig.bInheritRoll)
 		{
 			DesiredRot.Roll = LocalRelativeRotation.Roll;
 		}
@@ -88,135 +341,873 @@ FRotator UCameraSpringArm::GetTargetRotation() const
 
 void UCameraSpringArm::UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime)
 {
-	FRotator DesiredRot = GetTargetRotation();
-	DesiredRot += ExtraArmRotation;
+	FCameraArmFrame Frame;
+	GatherFrame(Frame, bDoTrace, bDoLocationLag, bDoRotationLag, DeltaTime);
+	SolveFrameLag(Frame);
+	QueryFrameCollision(Frame);
+	ResolveFrame(Frame);
+	CommitFrame(Frame);
+}
+
+void UCameraSpringArm::PrepareFrame(float DeltaTime)
+{
+	if (ActiveLagSolvers.IsStale())
+	{
+		SelectSolvers();
+	}
+
+	OnPrepareFrame.Broadcast(DeltaTime);
+
+	if (IsFramingGroup() || bFramingRelease)
+	{
+		UpdateGroupFraming(DeltaTime);
+	}
+}
+
+float UCameraSpringArm::GetMaxReach() const
+{
+	float ArmLength = FMath::Max(TargetArmLength, FramingMaxArmLength);
+	float Offsets = ActualSocketOffset.Size() + TargetOffset.Size();
+	for (const FCameraRig& Rig : Rigs)
+	{
+		ArmLength = FMath::Max(ArmLength, Rig.TargetArmLength);
+		Offsets = FMath::Max(Offsets, Rig.SocketOffset.Size() + Rig.TargetOffset.Size());
+	}
+	return ArmLength + Offsets;
+}
+
+void UCameraSpringArm::SetFramingTargets(const TArray<AActor*>& Targets)
+{
+	const bool bWasFraming = IsFramingGroup() || bFramingRelease;
+	GroupFraming.SetTargets(Targets, FramingTargetRadius);
+
+	if (IsFramingGroup() && !bWasFraming)
+	{
+		// Start from where the arm is now, so lag eases the camera over to the group
+		FramingArmLength = TargetArmLength;
+		bFramingRelease = false;
+
+		FramingCamera.Reset();
+		for (USceneComponent* Child : GetAttachChildren())
+		{
+			if (UCameraComponent* Camera = Cast<UCameraComponent>(Child))
+			{
+				FramingCamera = Camera;
+				break;
+			}
+		}
+	}
+	else if (!IsFramingGroup() && bWasFraming)
+	{
+		bFramingRelease = true;
+	}
+}
+
+void UCameraSpringArm::AddFramingTarget(AActor* Target)
+{
+	if (IsFramingGroup())
+	{
+		GroupFraming.AddTarget(Target, FramingTargetRadius);
+	}
+	else if (Target)
+	{
+		SetFramingTargets({ Target });
+	}
+}
+
+void UCameraSpringArm::RemoveFramingTarget(AActor* Target)
+{
+	GroupFraming.RemoveTarget(Target);
+	if (!IsFramingGroup())
+	{
+		bFramingRelease = true;
+	}
+}
+
+void UCameraSpringArm::ClearFramingTargets()
+{
+	SetFramingTargets(TArray<AActor*>());
+}
+
+void UCameraSpringArm::UpdateGroupFraming(float DeltaTime)
+{
+	CAMERA_STAGE_SCOPE(Framing);
+
+	const FCameraRigSettings& Rig = GetRigSettings();
+	const bool bLagLength = Rig.bEnableCameraLag && Rig.CameraLagSpeed > 0.f;
+
+	if (IsFramingGroup())
+	{
+		GroupFraming.UpdateTargets();
+
+		// Every target may have been destroyed since the last frame
+		bFramingRelease = !IsFramingGroup();
+	}
+
+	float WantedArmLength = TargetArmLength;
+	if (IsFramingGroup())
+	{
+		const UCameraComponent* Camera = FramingCamera.Get();
+		const float FieldOfView = Camera ? Camera->FieldOfView : FramingFieldOfView;
+		const float AspectRatio = Camera ? Camera->AspectRatio : FramingAspectRatio;
+		const float TanHalfFovX = FMath::Tan(FMath::DegreesToRadians(FieldOfView * .5f));
+
+		FRotator ViewRotation = GetTargetRotation() + ExtraArmRotation;
+		ViewRotation.Pitch = FramingPitch;
+
+		FramingOrigin = GroupFraming.GetBounds().GetCenter();
+		WantedArmLength = FMath::Clamp(GroupFraming.FitArmLength(ViewRotation, TanHalfFovX, TanHalfFovX / FMath::Max(AspectRatio, .1f)), FramingMinArmLength, FramingMaxArmLength);
+	}
+	else if (!bFramingRelease || !bLagLength || FMath::IsNearlyEqual(FramingArmLength, TargetArmLength, 1.f))
+	{
+		bFramingRelease = false;
+		return;
+	}
+
+	// The arm length isn't part of location lag, so it eases at the same speed alongside it
+	FramingArmLength = bLagLength ? FMath::FInterpTo(FramingArmLength, WantedArmLength, DeltaTime, Rig.CameraLagSpeed) : WantedArmLength;
+}
+
+void UCameraSpringArm::SolveFrame(FCameraArmFrame& Frame, float DeltaTime)
+{
+	GatherRigFrame(Frame, DeltaTime);
+	SolveFrameLag(Frame);
+	QueryFrameCollision(Frame);
+	ResolveFrame(Frame);
+}
+
+bool UCameraSpringArm::SkipForBudget(float& InOutDeltaTime)
+{
+	if (ArmSubsystem && ArmSubsystem->ShouldThrottle(GetOwner(), GetUniqueID()))
+	{
+		SkippedDeltaTime += InOutDeltaTime;
+		return true;
+	}
+
+	InOutDeltaTime += SkippedDeltaTime;
+	SkippedDeltaTime = 0.f;
+	return false;
+}
+
+void UCameraSpringArm::GatherFrame(FCameraArmFrame& Frame, bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime) const
+{
+	CAMERA_STAGE_SCOPE(Gather);
+
+	Frame.DeltaTime = DeltaTime;
+	Frame.BudgetLevel = ArmSubsystem ? ArmSubsystem->GetBudgetLevel() : ECameraBudgetLevel::Full;
+	Frame.bDoTrace = bDoTrace;
+	Frame.bDoLocationLag = bDoLocationLag;
+	Frame.bDoRotationLag = bDoRotationLag;
+
+	Frame.DesiredRot = GetTargetRotation();
+	Frame.DesiredRot += ExtraArmRotation;
+
+	Frame.LatencyStamp = PendingLatencyStamp;
+	if (Frame.LatencyStamp.IsValid())
+	{
+		Frame.LatencyStamp.ReadTime = FPlatformTime::Seconds();
+	}
+
+	// Get the spring arm 'origin', the target we want to look at
+	Frame.ArmOrigin = GetComponentLocation() + TargetOffset;
+
+	Frame.TargetArmLength = TargetArmLength;
+	Frame.SocketOffset = ActualSocketOffset;
+
+	if (IsFramingGroup())
+	{
+		// Location and rotation lag carry the camera over to the group, just as they follow the owner
+		Frame.ArmOrigin = FramingOrigin + TargetOffset;
+		Frame.TargetArmLength = FramingArmLength;
+		Frame.DesiredRot.Pitch = FramingPitch;
+	}
+	else if (bFramingRelease)
+	{
+		Frame.TargetArmLength = FramingArmLength;
+	}
+	Frame.TargetRot = Frame.DesiredRot;
+
+	ApplyConstraints(Frame);
+
+	Frame.InputCurve.Reset();
+	if (bUsePawnControlRotation && PendingInputCurve && PendingInputCurve->NumKnots > 0)
+	{
+		Frame.InputCurve = *PendingInputCurve;
+
+		// Input on axes the arm doesn't inherit never reaches DesiredRot, so it mustn't shape the lag either
+		if (!IsUsingAbsoluteRotation())
+		{
+			const FCameraRigSettings& Rig = GetRigSettings();
+			for (int32 KnotIndex = 0; KnotIndex < Frame.InputCurve.NumKnots; ++KnotIndex)
+			{
+				FRotator& Offset = Frame.InputCurve.Offsets[KnotIndex];
+				if (!Rig.bInheritPitch) { Offset.Pitch = 0.f; }
+				if (!Rig.bInheritYaw) { Offset.Yaw = 0.f; }
+				if (!Rig.bInheritRoll) { Offset.Roll = 0.f; }
+			}
+		}
+	}
+}
+
+void UCameraSpringArm::ApplyConstraints(FCameraArmFrame& Frame) const
+{
+	FCameraConstraint Constraint;
+	if (!ConstraintSubsystem || !ConstraintSubsystem->FindConstraint(Frame.ArmOrigin, Constraint)) { return; }
+
+	if (Constraint.bOverrideTargetOffset)
+	{
+		Frame.ArmOrigin = GetComponentLocation() + Constraint.TargetOffset;
+	}
+
+	if (Constraint.bForceShoulderSide)
+	{
+		Frame.SocketOffset.Y = Constraint.bRightShoulder ? FMath::Abs(Frame.SocketOffset.Y) : -FMath::Abs(Frame.SocketOffset.Y);
+	}
+
+	if (Constraint.bCapArmLength)
+	{
+		Frame.TargetArmLength = FMath::Min(Frame.TargetArmLength, Constraint.MaxArmLength);
+
+		// The volume vouches for the space this close to the origin, so there is nothing for the sweep to find
+		if (Frame.TargetArmLength <= Constraint.CollisionFreeArmLength)
+		{
+			Frame.bDoTrace = false;
+		}
+	}
+}
+
+void UCameraSpringArm::GatherRigFrame(FCameraArmFrame& Frame, float DeltaTime) const
+{
+	const FCameraRigSettings& Rig = GetRigSettings();
+	GatherFrame(Frame, Rig.bDoCollisionTest, Rig.bEnableCameraLag, Rig.bEnableCameraRotationLag, DeltaTime);
+}
+
+void UCameraSpringArm::SolveFrameLag(FCameraArmFrame& Frame)
+{
+	CAMERA_STAGE_SCOPE(Lag);
+
+	if (!RigBlend || RigBlend->IsFinished())
+	{
+		ActiveLagSolvers.Get(Frame)(GetRigSettings(), ArmState, Frame);
+		return;
+	}
+
+	// The outgoing rig sees the same target and input, from its own origin and with its own arm
+	FCameraRigBlend& Blend = *RigBlend;
+	FCameraArmFrame& OutgoingFrame = Blend.Frame;
+	OutgoingFrame = Frame;
+	OutgoingFrame.ArmOrigin = Frame.ArmOrigin - TargetOffset + Blend.TargetOffset;
+	OutgoingFrame.TargetArmLength = Blend.ArmLength;
+	OutgoingFrame.SocketOffset = Blend.SocketOffset;
+	OutgoingFrame.bDoLocationLag = Blend.Settings.bEnableCameraLag;
+	OutgoingFrame.bDoRotationLag = Blend.Settings.bEnableCameraRotationLag;
+
+	ActiveLagSolvers.Get(Frame)(GetRigSettings(), ArmState, Frame);
+	Blend.LagSolvers.Get(OutgoingFrame)(Blend.Settings, Blend.LagState, OutgoingFrame);
+
+	// Freed by the commit rather than here, which may be a worker thread
+	Blend.Elapsed += Frame.DeltaTime;
+	const float Alpha = FMath::SmoothStep(0.f, 1.f, Blend.Elapsed / Blend.Duration);
+
+	// Both rigs share the one collision probe, which sweeps to the blended camera
+	Frame.LaggedOrigin = FMath::Lerp(OutgoingFrame.LaggedOrigin, Frame.LaggedOrigin, Alpha);
+	Frame.DesiredLoc = FMath::Lerp(OutgoingFrame.DesiredLoc, Frame.DesiredLoc, Alpha);
+	Frame.DesiredQuat = FQuat::Slerp(OutgoingFrame.DesiredQuat, Frame.DesiredQuat, Alpha);
+	Frame.DesiredRot = Frame.DesiredQuat.Rotator();
+}
+
+/**
+ * Solves location and rotation lag for one rig, from Frame's gathered inputs into its lagged outputs. Always inlined,
+ * so the specialized solvers below, which pass every flag as a constant, compile the disabled features away.
+ * Whether rotators are converted with FCameraFastMath is always fixed at compile time.
+ */
+template<bool bFastTrig>
+static FORCEINLINE void SolveRigLag(const FCameraRigSettings& Rig, FCameraLagState& State, FCameraArmFrame& Frame,
+	bool bRotationLag, bool bLocationLag, bool bSubstep, bool bClampDistance)
+{
+	const float DeltaTime = Frame.DeltaTime;
+	const FVector ArmOrigin = Frame.ArmOrigin;
+	FRotator DesiredRot = Frame.DesiredRot;
 
 	// Apply 'lag' to rotation if desired
-	if (bDoRotationLag)
+	if (bRotationLag)
 	{
-		if (bUseCameraLagSubstepping && DeltaTime > CameraLagMaxTimeStep&& CameraRotationLagSpeed > 0.f)
+		if (bSubstep && DeltaTime > Rig.CameraLagMaxTimeStep&& Rig.CameraRotationLagSpeed > 0.f)
 		{
-			const FRotator ArmRotStep = (DesiredRot - PreviousDesiredRot).GetNormalized() * (1.f / DeltaTime);
-			FRotator LerpTarget = PreviousDesiredRot;
+			// Input with known timing is followed as it arrived; whatever is left is spread evenly over the frame
+			const FCameraInputCurve& Input = Frame.InputCurve;
+			const FRotator ArmRotStep = (DesiredRot - State.PreviousDesiredRot - Input.GetTotal()).GetNormalized() * (1.f / DeltaTime);
+			FRotator LerpTarget = State.PreviousDesiredRot;
 			float RemainingTime = DeltaTime;
 			while (RemainingTime > KINDA_SMALL_NUMBER)
 			{
-				const float LerpAmount = FMath::Min(CameraLagMaxTimeStep, RemainingTime);
+				const float LerpAmount = FMath::Min(Rig.CameraLagMaxTimeStep, RemainingTime);
 				LerpTarget += ArmRotStep * LerpAmount;
 				RemainingTime -= LerpAmount;
 
-				DesiredRot = FRotator(FMath::QInterpTo(FQuat(PreviousDesiredRot), FQuat(LerpTarget), LerpAmount, CameraRotationLagSpeed));
-				PreviousDesiredRot = DesiredRot;
+				const FRotator StepTarget = LerpTarget + Input.Evaluate(1.f - RemainingTime / DeltaTime);
+				DesiredRot = FRotator(FMath::QInterpTo(FCameraFastMath::ToQuat<bFastTrig>(State.PreviousDesiredRot), FCameraFastMath::ToQuat<bFastTrig>(StepTarget), LerpAmount, Rig.CameraRotationLagSpeed));
+				State.PreviousDesiredRot = DesiredRot;
 			}
 		}
 		else
 		{
-			DesiredRot = FRotator(FMath::QInterpTo(FQuat(PreviousDesiredRot), FQuat(DesiredRot), DeltaTime, CameraRotationLagSpeed));
+			DesiredRot = FRotator(FMath::QInterpTo(FCameraFastMath::ToQuat<bFastTrig>(State.PreviousDesiredRot), FCameraFastMath::ToQuat<bFastTrig>(DesiredRot), DeltaTime, Rig.CameraRotationLagSpeed));
 		}
 	}
 
 	//DesiredRot.Add(ControlOffset.Pitch, ControlOffset.Yaw, ControlOffset.Roll);
 
-	PreviousDesiredRot = DesiredRot;
+	State.PreviousDesiredRot = DesiredRot;
 
-	// Get the spring arm 'origin', the target we want to look at
-	FVector ArmOrigin = GetComponentLocation() + TargetOffset;
 	// We lag the target, not the actual camera position, so rotating the camera around does not have lag
 	FVector DesiredLoc = ArmOrigin;
-	if (bDoLocationLag)
+	Frame.bClampedDist = false;
+	if (bLocationLag)
 	{
-		if (bUseCameraLagSubstepping && DeltaTime > CameraLagMaxTimeStep&& CameraLagSpeed > 0.f)
+		if (bSubstep && DeltaTime > Rig.CameraLagMaxTimeStep&& Rig.CameraLagSpeed > 0.f)
 		{
-			const FVector ArmMovementStep = (DesiredLoc - PreviousDesiredLoc) * (1.f / DeltaTime);
-			FVector LerpTarget = PreviousDesiredLoc;
+			const FVector ArmMovementStep = (DesiredLoc - State.PreviousDesiredLoc) * (1.f / DeltaTime);
+			FVector LerpTarget = State.PreviousDesiredLoc;
 
 			float RemainingTime = DeltaTime;
 			while (RemainingTime > KINDA_SMALL_NUMBER)
 			{
-				const float LerpAmount = FMath::Min(CameraLagMaxTimeStep, RemainingTime);
+				const float LerpAmount = FMath::Min(Rig.CameraLagMaxTimeStep, RemainingTime);
 				LerpTarget += ArmMovementStep * LerpAmount;
 				RemainingTime -= LerpAmount;
 
-				DesiredLoc = FMath::VInterpTo(PreviousDesiredLoc, LerpTarget, LerpAmount, CameraLagSpeed);
-				PreviousDesiredLoc = DesiredLoc;
+				DesiredLoc = FMath::VInterpTo(State.PreviousDesiredLoc, LerpTarget, LerpAmount, Rig.CameraLagSpeed);
+				State.PreviousDesiredLoc = DesiredLoc;
 			}
 		}
 		else
 		{
-			DesiredLoc = FMath::VInterpTo(PreviousDesiredLoc, DesiredLoc, DeltaTime, CameraLagSpeed);
+			DesiredLoc = FMath::VInterpTo(State.PreviousDesiredLoc, DesiredLoc, DeltaTime, Rig.CameraLagSpeed);
 		}
 
 		// Clamp distance if requested
-		bool bClampedDist = false;
-		if (CameraLagMaxDistance > 0.f)
+		if (bClampDistance)
 		{
 			const FVector FromOrigin = DesiredLoc - ArmOrigin;
-			if (FromOrigin.SizeSquared() > FMath::Square(CameraLagMaxDistance))
+			if (FromOrigin.SizeSquared() > FMath::Square(Rig.CameraLagMaxDistance))
 			{
-				DesiredLoc = ArmOrigin + FromOrigin.GetClampedToMaxSize(CameraLagMaxDistance);
-				bClampedDist = true;
+				DesiredLoc = ArmOrigin + FromOrigin.GetClampedToMaxSize(Rig.CameraLagMaxDistance);
+				Frame.bClampedDist = true;
 			}
 		}
+	}
 
-#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
-		if (bDrawDebugLagMarkers)
+	State.PreviousArmOrigin = ArmOrigin;
+	State.PreviousDesiredLoc = DesiredLoc;
+	Frame.LaggedOrigin = DesiredLoc;
+
+	// Now offset camera position back along our rotation, and add socket offset in local space
+	DesiredLoc += FCameraFastMath::GetArmOffset<bFastTrig>(DesiredRot, Frame.TargetArmLength, Frame.SocketOffset);
+
+	Frame.DesiredRot = DesiredRot;
+	Frame.DesiredQuat = FCameraFastMath::ToQuat<bFastTrig>(DesiredRot);
+	Frame.DesiredLoc = DesiredLoc;
+}
+
+/** Lag solve with every flag fixed at compile time, so each one runs straight through only the lag it does */
+template<bool bRotationLag, bool bLocationLag, bool bSubstep, bool bClampDistance, bool bFastTrig>
+static void SolveRigLagSpecialized(const FCameraRigSettings& Rig, FCameraLagState& State, FCameraArmFrame& Frame)
+{
+	SolveRigLag<bFastTrig>(Rig, State, Frame, bRotationLag, bLocationLag, bSubstep, bClampDistance);
+}
+
+/** Lag solve reading every lag flag from the frame and rig as it goes, the reference for the specialized ones */
+template<bool bFastTrig>
+static void SolveRigLagGeneric(const FCameraRigSettings& Rig, FCameraLagState& State, FCameraArmFrame& Frame)
+{
+	const bool bSubstep = Rig.bUseCameraLagSubstepping && Frame.BudgetLevel < ECameraBudgetLevel::NoSubsteps;
+	SolveRigLag<bFastTrig>(Rig, State, Frame, Frame.bDoRotationLag, Frame.bDoLocationLag, bSubstep, Rig.CameraLagMaxDistance > 0.f);
+}
+
+FCameraLagSolver FCameraLagSolvers::Find(bool bRotationLag, bool bLocationLag, bool bSubstep, bool bClampDistance, bool bFastTrig)
+{
+	// Indexed by the flags as bits: rotation lag, location lag, substeps, clamped distance, fast trig
+	static const FCameraLagSolver Solvers[32] =
+	{
+		&SolveRigLagSpecialized<false, false, false, false, false>,
+		&SolveRigLagSpecialized<true, false, false, false, false>,
+		&SolveRigLagSpecialized<false, true, false, false, false>,
+		&SolveRigLagSpecialized<true, true, false, false, false>,
+		&SolveRigLagSpecialized<false, false, true, false, false>,
+		&SolveRigLagSpecialized<true, false, true, false, false>,
+		&SolveRigLagSpecialized<false, true, true, false, false>,
+		&SolveRigLagSpecialized<true, true, true, false, false>,
+		&SolveRigLagSpecialized<false, false, false, true, false>,
+		&SolveRigLagSpecialized<true, false, false, true, false>,
+		&SolveRigLagSpecialized<false, true, false, true, false>,
+		&SolveRigLagSpecialized<true, true, false, true, false>,
+		&SolveRigLagSpecialized<false, false, true, true, false>,
+		&SolveRigLagSpecialized<true, false, true, true, false>,
+		&SolveRigLagSpecialized<false, true, true, true, false>,
+		&SolveRigLagSpecialized<true, true, true, true, false>,
+		&SolveRigLagSpecialized<false, false, false, false, true>,
+		&SolveRigLagSpecialized<true, false, false, false, true>,
+		&SolveRigLagSpecialized<false, true, false, false, true>,
+		&SolveRigLagSpecialized<true, true, false, false, true>,
+		&SolveRigLagSpecialized<false, false, true, false, true>,
+		&SolveRigLagSpecialized<true, false, true, false, true>,
+		&SolveRigLagSpecialized<false, true, true, false, true>,
+		&SolveRigLagSpecialized<true, true, true, false, true>,
+		&SolveRigLagSpecialized<false, false, false, true, true>,
+		&SolveRigLagSpecialized<true, false, false, true, true>,
+		&SolveRigLagSpecialized<false, true, false, true, true>,
+		&SolveRigLagSpecialized<true, true, false, true, true>,
+		&SolveRigLagSpecialized<false, false, true, true, true>,
+		&SolveRigLagSpecialized<true, false, true, true, true>,
+		&SolveRigLagSpecialized<false, true, true, true, true>,
+		&SolveRigLagSpecialized<true, true, true, true, true>,
+	};
+
+	const int32 Index = (bRotationLag ? 1 : 0) | (bLocationLag ? 2 : 0) | (bSubstep ? 4 : 0) | (bClampDistance ? 8 : 0) | (bFastTrig ? 16 : 0);
+	return Solvers[Index];
+}
+
+uint32 FCameraLagSolvers::GetSelectionSerial()
+{
+	return GCameraSolverSelectionSerial;
+}
+
+FCameraLagSolvers FCameraLagSolvers::Select(const FCameraRigSettings& Rig)
+{
+	FCameraLagSolvers Result;
+	Result.bRotationLag = Rig.bEnableCameraRotationLag;
+	Result.bLocationLag = Rig.bEnableCameraLag;
+	Result.bSubstep = Rig.bUseCameraLagSubstepping;
+	Result.bClampDistance = Rig.CameraLagMaxDistance > 0.f;
+	Result.bFastTrig = FCameraFastMath::IsEnabled();
+	Result.SelectionSerial = GetSelectionSerial();
+
+	if (CVarCameraSpecializedSolvers.GetValueOnAnyThread() == 0)
+	{
+		Result.bGeneric = true;
+		Result.Full = Result.bFastTrig ? &SolveRigLagGeneric<true> : &SolveRigLagGeneric<false>;
+		Result.NoSubsteps = Result.Full;
+		return Result;
+	}
+
+	Result.Full = Find(Result.bRotationLag, Result.bLocationLag, Result.bSubstep, Result.bClampDistance, Result.bFastTrig);
+
+	// Over budget, lag is solved in one step; long frames converge a little differently but cost the same as short ones
+	Result.NoSubsteps = Find(Result.bRotationLag, Result.bLocationLag, false, Result.bClampDistance, Result.bFastTrig);
+	return Result;
+}
+
+void UCameraSpringArm::QueryFrameCollision(FCameraArmFrame& Frame)
+{
+	Frame.bTraced = Frame.bDoTrace && (Frame.TargetArmLength != 0.0f);
+	Frame.bHitSomething = false;
+	Frame.bFadeOccluders = false;
+	Frame.HitLocation = Frame.DesiredLoc;
+	Frame.ProbeMargin = 0.f;
+	Frame.ProbeHitTime = 1.f;
+	if (!Frame.bTraced) { return; }
+
+	CAMERA_STAGE_SCOPE(Collision);
+
+	const FCameraRigSettings& Rig = GetRigSettings();
+	FCameraSpringArmState& State = ArmState;
+	const FVector Start = Frame.ArmOrigin;
+	const FVector End = Frame.DesiredLoc;
+
+	// Scene queries take the physics scene read lock themselves, so this is safe from worker threads
+	const FCollisionQueryParams& QueryParams = ProbeQueryParams;
+
+	// Every point of the arm moves at most as far as the further of its two ends
+	Frame.ProbeMovement = FMath::Sqrt(FMath::Max(FVector::DistSquared(Start, State.ProbeStart), FVector::DistSquared(End, State.ProbeEnd)));
+
+	// Over budget, keep the last query's hit at the same point along the arm for a frame or two instead of querying
+	const bool bHaveLastQuery = State.FramesSinceProbeRefresh != MAX_int32;
+	if (Frame.BudgetLevel >= ECameraBudgetLevel::ReuseSweeps && bHaveLastQuery && State.ProbeReuseCount < FCameraBudgetGovernor::MaxSweepReuse)
+	{
+		++State.ProbeReuseCount;
+		Frame.ProbeTier = ECameraProbeTier::Reused;
+		FCameraProbeCounters::Add(ECameraProbeTier::Reused);
+
+		Frame.bFadeOccluders = Rig.CollisionResponse == ECameraCollisionResponse::FadeOccluders;
+		Frame.bHitSomething = !Frame.bFadeOccluders && State.bProbeHadHit;
+		Frame.ProbeHitTime = State.ProbeHitTime;
+		Frame.HitLocation = Frame.bHitSomething ? FMath::Lerp(Start, End, State.ProbeHitTime) : End;
+		Frame.ProbeMargin = FMath::Max(State.ProbeMargin - Frame.ProbeMovement, 0.f);
+		return;
+	}
+	State.ProbeReuseCount = 0;
+
+	if (Rig.CollisionResponse == ECameraCollisionResponse::FadeOccluders)
+	{
+		// Treat everything as an overlap so the sweep reports every occluder instead of stopping at the first one
+		static const FCollisionResponseParams OverlapAll(ECR_Overlap);
+
+		Frame.bFadeOccluders = true;
+		Frame.ProbeTier = ECameraProbeTier::Sphere;
+		FCameraProbeCounters::Add(ECameraProbeTier::Sphere);
+		// Meshes covered by collision proxies only overlap ECC_Camera, which this sweep still reports, so they fade too
+		GetWorld()->SweepMultiByChannel(State.OccluderHits, Start, End, FQuat::Identity, Rig.ProbeChannel, FCollisionShape::MakeSphere(Rig.ProbeSize), QueryParams, OverlapAll);
+		return;
+	}
+
+	auto Sweep = [this, &Frame, &State, &Rig, &QueryParams, &End](const FVector& SweepStart, float Radius, float StartTime)
+	{
+		FHitResult& Result = State.ProbeHit;
+		if (GetWorld()->SweepSingleByChannel(Result, SweepStart, End, FQuat::Identity, Rig.ProbeChannel, FCollisionShape::MakeSphere(Radius), QueryParams))
 		{
-			DrawDebugSphere(GetWorld(), ArmOrigin, 5.f, 8, FColor::Green);
-			DrawDebugSphere(GetWorld(), DesiredLoc, 5.f, 8, FColor::Yellow);
+			Frame.bHitSomething = true;
+			Frame.HitLocation = Result.Location;
+			Frame.ProbeHitTime = FMath::Lerp(StartTime, 1.f, Result.Time);
+			return true;
+		}
+		return false;
+	};
+
+	const bool bAdaptive = Rig.bAdaptiveProbe && CVarCameraAdaptiveProbe.GetValueOnAnyThread() != 0;
+	const bool bRefreshDue = !bAdaptive || State.FramesSinceProbeRefresh >= Rig.ProbeRefreshInterval;
 
-			const FVector ToOrigin = ArmOrigin - DesiredLoc;
-			DrawDebugDirectionalArrow(GetWorld(), DesiredLoc, DesiredLoc + ToOrigin * 0.5f, 7.5f, bClampedDist ? FColor::Red : FColor::Green);
-			DrawDebugDirectionalArrow(GetWorld(), DesiredLoc + ToOrigin * 0.5f, ArmOrigin, 7.5f, bClampedDist ? FColor::Red : FColor::Green);
+	// Each arm counts as one probe a frame, under the tier it picked; a cheap query that has to be followed by the
+	// exact sweep is counted as a fallback instead of as a second probe
+	bool bFallingBack = false;
+
+	if (!bRefreshDue && State.ProbeMargin > Frame.ProbeMovement)
+	{
+		// Nothing that was there at the last refresh can have reached the probe yet, so the line only has to catch things that moved in since
+		Frame.ProbeTier = ECameraProbeTier::Line;
+		FCameraProbeCounters::Add(ECameraProbeTier::Line);
+		if (!GetWorld()->LineTraceTestByChannel(Start, End, Rig.ProbeChannel, QueryParams))
+		{
+			Frame.ProbeMargin = State.ProbeMargin - Frame.ProbeMovement;
+			return;
 		}
-#endif
+		bFallingBack = true;
 	}
+	else if (!bRefreshDue && State.bProbeHadHit && State.ProbeDrift + Frame.ProbeMovement < Rig.ProbeSize * ProbeDriftTolerance)
+	{
+		// The arm has barely moved since the part in front of last frame's hit was found clear, so only sweep from just before the hit
+		const float ArmLength = (End - Start).Size();
+		const float StartTime = ArmLength > KINDA_SMALL_NUMBER ? State.ProbeHitTime - Rig.ProbeSize / ArmLength : 0.f;
+		if (StartTime > 0.f)
+		{
+			Frame.ProbeTier = ECameraProbeTier::Partial;
+			FCameraProbeCounters::Add(ECameraProbeTier::Partial);
+			Sweep(FMath::Lerp(Start, End, StartTime), Rig.ProbeSize, StartTime);
+			return;
+		}
+	}
+	else if (bRefreshDue && bAdaptive)
+	{
+		// Sweep wider than the probe to find out how much room there is around the arm
+		Frame.ProbeTier = ECameraProbeTier::Refresh;
+		FCameraProbeCounters::Add(ECameraProbeTier::Refresh);
 
-	PreviousArmOrigin = ArmOrigin;
-	PreviousDesiredLoc = DesiredLoc;
+		const FCollisionShape RefreshShape = FCollisionShape::MakeSphere(Rig.ProbeSize + Rig.ProbeClearanceThreshold);
+		if (!GetWorld()->SweepSingleByChannel(State.ProbeHit, Start, End, FQuat::Identity, Rig.ProbeChannel, RefreshShape, QueryParams))
+		{
+			Frame.ProbeMargin = Rig.ProbeClearanceThreshold;
+			return;
+		}
 
-	// Now offset camera position back along our rotation
-	DesiredLoc -= DesiredRot.Vector() * TargetArmLength;
-	// Add socket offset in local space
-	DesiredLoc += FRotationMatrix(DesiredRot).TransformVector(ActualSocketOffset);
+		// Geometry is close, so the exact sweep below gives the actual result
+		FCameraProbeCounters::AddFallback();
+		Sweep(Start, Rig.ProbeSize, 0.f);
+		return;
+	}
 
-	// Do a sweep to ensure we are not penetrating the world
-	FVector ResultLoc;
-	if (bDoTrace && (TargetArmLength != 0.0f))
+	// The line found something, so the arm ends up swept whole like any other sphere probe
+	Frame.ProbeTier = ECameraProbeTier::Sphere;
+	if (bFallingBack)
 	{
-		bIsCameraFixed = true;
-		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SpringArm), false, GetOwner());
+		FCameraProbeCounters::AddFallback();
+	}
+	else
+	{
+		FCameraProbeCounters::Add(ECameraProbeTier::Sphere);
+	}
+	Sweep(Start, Rig.ProbeSize, 0.f);
+}
 
-		FHitResult Result;
-		GetWorld()->SweepSingleByChannel(Result, ArmOrigin, DesiredLoc, FQuat::Identity, ProbeChannel, FCollisionShape::MakeSphere(ProbeSize), QueryParams);
+void UCameraSpringArm::ResolveFrame(FCameraArmFrame& Frame)
+{
+	CAMERA_STAGE_SCOPE(Resolve);
 
-		UnfixedCameraPosition = DesiredLoc;
+	(this->*ActiveResolver)(Frame);
+}
 
-		ResultLoc = BlendLocations(DesiredLoc, Result.Location, Result.bBlockingHit, DeltaTime);
+template<bool bDefaultBlend>
+void UCameraSpringArm::ResolveFrameSpecialized(FCameraArmFrame& Frame)
+{
+	FCameraSpringArmState& State = ArmState;
+
+	// Do a sweep to ensure we are not penetrating the world
+	if (Frame.bTraced)
+	{
+		State.UnfixedCameraPosition = Frame.DesiredLoc;
 
-		if (ResultLoc == DesiredLoc)
+		if (bDefaultBlend)
 		{
-			bIsCameraFixed = false;
+			Frame.ResultLoc = Frame.bHitSomething ? Frame.HitLocation : Frame.DesiredLoc;
 		}
+		else
+		{
+			Frame.ResultLoc = BlendLocations(Frame.DesiredLoc, Frame.HitLocation, Frame.bHitSomething, Frame.DeltaTime);
+		}
+
+		State.bIsCameraFixed = Frame.ResultLoc != Frame.DesiredLoc;
+
+		// Remember what the probe found so the next frame can pick a cheaper query
+		const bool bSweptWholeArm = Frame.ProbeTier == ECameraProbeTier::Sphere || Frame.ProbeTier == ECameraProbeTier::Refresh;
+		State.ProbeStart = Frame.ArmOrigin;
+		State.ProbeEnd = Frame.DesiredLoc;
+		State.bProbeHadHit = Frame.bHitSomething;
+		State.ProbeHitTime = Frame.ProbeHitTime;
+		State.ProbeMargin = Frame.ProbeMargin;
+		State.ProbeDrift = bSweptWholeArm ? 0.f : State.ProbeDrift + Frame.ProbeMovement;
+		State.FramesSinceProbeRefresh = Frame.ProbeTier == ECameraProbeTier::Refresh ? 0 : FMath::Min(State.FramesSinceProbeRefresh, MAX_int32 - 1) + 1;
 	}
 	else
 	{
-		ResultLoc = DesiredLoc;
-		bIsCameraFixed = false;
-		UnfixedCameraPosition = ResultLoc;
+		Frame.ResultLoc = Frame.DesiredLoc;
+		State.bIsCameraFixed = false;
+		State.UnfixedCameraPosition = Frame.ResultLoc;
+
+		// Whatever the probe knew is stale by the time the test is turned back on
+		State.bProbeHadHit = false;
+		State.ProbeMargin = 0.f;
+		State.FramesSinceProbeRefresh = MAX_int32;
+	}
+}
+
+void UCameraSpringArm::CommitFrame(const FCameraArmFrame& Frame)
+{
+	CAMERA_STAGE_SCOPE(Commit);
+
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+	// Drawn here rather than while solving lag, since debug drawing is only safe on the game thread
+	if (bDrawDebugLagMarkers && Frame.bDoLocationLag)
+	{
+		const FVector ArmOrigin = Frame.ArmOrigin;
+		const FVector DesiredLoc = Frame.LaggedOrigin;
+
+		DrawDebugSphere(GetWorld(), ArmOrigin, 5.f, 8, FColor::Green);
+		DrawDebugSphere(GetWorld(), DesiredLoc, 5.f, 8, FColor::Yellow);
+
+		const FVector ToOrigin = ArmOrigin - DesiredLoc;
+		DrawDebugDirectionalArrow(GetWorld(), DesiredLoc, DesiredLoc + ToOrigin * 0.5f, 7.5f, Frame.bClampedDist ? FColor::Red : FColor::Green);
+		DrawDebugDirectionalArrow(GetWorld(), DesiredLoc + ToOrigin * 0.5f, ArmOrigin, 7.5f, Frame.bClampedDist ? FColor::Red : FColor::Green);
+	}
+#endif
+
+	if (Frame.bFadeOccluders)
+	{
+		UpdateFadedOccluders();
+	}
+	else if (FadedOccluders.Num() > 0)
+	{
+		RestoreFadedOccluders();
 	}
 
 	// Form a transform for new world transform for camera
-	FTransform WorldCamTM(DesiredRot, ResultLoc);
+	FTransform WorldCamTM(Frame.DesiredQuat, Frame.ResultLoc);
 	// Convert to relative to component
 	FTransform RelCamTM = WorldCamTM.GetRelativeTransform(GetComponentTransform());
 
+	// Moving the arm already carried the children along, so they only need updating if the socket moved on the arm
+	const bool bSocketMoved = RelCamTM.GetLocation() != RelativeSocketLocation || !(RelCamTM.GetRotation() == RelativeSocketRotation);
+
 	// Update socket location/rotation
 	RelativeSocketLocation = RelCamTM.GetLocation();
 	RelativeSocketRotation = RelCamTM.GetRotation();
 
+	const FVector PreviousViewLocation = CommittedSocketTransform.GetLocation();
+	const bool bHadCommittedView = bHasCommittedView;
+	CommittedSocketTransform = WorldCamTM;
+	bHasCommittedView = true;
+
+	// The view reads the pose directly, so walking the attachment tree waits until something asks for it, or the
+	// subsystem flushes arms with other children at the end of the frame. Without a subsystem, move them now.
+	if (bDirectViewOutput && ArmSubsystem)
+	{
+		bChildTransformsDirty = true;
+	}
+	else if (bSocketMoved || bChildTransformsDirty)
+	{
+		UpdateChildTransforms();
+		bChildTransformsDirty = false;
+	}
+
+	CommitComponentLocation = GetComponentLocation();
+	CommitFrameNumber = GFrameCounter;
+
+	if (History && !bHistoryPaused && GetOwner())
+	{
+		History->Record(GetWorld()->GetTimeSeconds(), WorldCamTM.GetRelativeTransform(GetOwner()->GetActorTransform()));
+	}
+
+	if (PendingInputCurve)
+	{
+		PendingInputCurve->Reset();
+	}
+
+	if (RigBlend && RigBlend->IsFinished())
+	{
+		RigBlend.Reset();
+	}
+
+	if (Frame.LatencyStamp.IsValid())
+	{
+		// Without rotation lag the camera turns as soon as the commit lands, so all the latency is in the pipeline
+		const float LagSeconds = Frame.bDoRotationLag ? FCameraLatencyTracker::MeasureLag(Frame.TargetRot, LatencyPreviousTargetRot, Frame.DesiredRot, Frame.DeltaTime) : 0.f;
+		FCameraLatencyTracker::Record(Frame.LatencyStamp, FPlatformTime::Seconds(), LagSeconds);
+	}
+	LatencyPreviousTargetRot = Frame.TargetRot;
+	PendingLatencyStamp = FCameraLatencyStamp();
+
+	UpdateViewMotion(Frame);
+
+	PublishPoseSnapshot(Frame, PreviousViewLocation, bHadCommittedView);
+}
+
+void UCameraSpringArm::PublishPoseSnapshot(const FCameraArmFrame& Frame, const FVector& PreviousLocation, bool bHadPreviousView)
+{
+	FCameraPoseSnapshot Snapshot;
+	Snapshot.Location = CommittedSocketTransform.GetLocation();
+	Snapshot.Rotation = CommittedSocketTransform.GetRotation();
+	Snapshot.UnfixedLocation = ArmState.UnfixedCameraPosition;
+	Snapshot.AngularVelocity = ArmState.ViewAngularVelocity;
+	Snapshot.bCollisionFixApplied = ArmState.bIsCameraFixed;
+	Snapshot.bHitSomething = Frame.bHitSomething;
+	Snapshot.HitTime = Frame.ProbeHitTime;
+	Snapshot.WorldTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0;
+	Snapshot.FrameNumber = GFrameCounter;
+	Snapshot.bValid = true;
+
+	if (bHadPreviousView && Frame.DeltaTime > SMALL_NUMBER)
+	{
+		Snapshot.Velocity = (Snapshot.Location - PreviousLocation) / Frame.DeltaTime;
+	}
+
+	PoseSnapshot->Publish(Snapshot);
+}
+
+void UCameraSpringArm::FlushChildTransforms()
+{
+	if (bChildTransformsDirty)
+	{
+		UpdateChildTransforms();
+		bChildTransformsDirty = false;
+	}
+}
+
+bool UCameraSpringArm::HasChildrenBesideDirectView() const
+{
+	const TArray<USceneComponent*>& Children = GetAttachChildren();
+	const USceneComponent* ViewComponent = DirectViewComponent.Get();
+	return Children.Num() > (ViewComponent && ViewComponent->GetAttachParent() == this ? 1 : 0);
+}
+
+void UCameraSpringArm::UpdateViewMotion(const FCameraArmFrame& Frame)
+{
+	FCameraSpringArmState& State = ArmState;
+
+	const FVector OwnerLocation = GetOwner() ? GetOwner()->GetActorLocation() : FVector::ZeroVector;
+	const FVector OriginOffset = Frame.ArmOrigin - OwnerLocation;
+	const FVector LocalArm = Frame.DesiredRot.UnrotateVector(Frame.ResultLoc - Frame.LaggedOrigin);
+
+	if (State.bHasViewMotion && Frame.DeltaTime > SMALL_NUMBER)
+	{
+		const float InvDeltaTime = 1.f / Frame.DeltaTime;
+		const float Blend = FMath::Min(Frame.DeltaTime * ViewMotionSmoothing, 1.f);
+
+		State.ViewAngularVelocity = FMath::Lerp(State.ViewAngularVelocity, (Frame.DesiredRot - State.ViewRotation).GetNormalized() * InvDeltaTime, Blend);
+		State.ViewOriginOffsetVelocity = FMath::Lerp(State.ViewOriginOffsetVelocity, (OriginOffset - State.ViewOriginOffset) * InvDeltaTime, Blend);
+		State.ViewLocalArmVelocity = FMath::Lerp(State.ViewLocalArmVelocity, (LocalArm - State.ViewLocalArm) * InvDeltaTime, Blend);
+	}
+
+	State.bHasViewMotion = true;
+	State.ViewRotation = Frame.DesiredRot;
+	State.ViewArmOrigin = Frame.ArmOrigin;
+	State.ViewLaggedOrigin = Frame.LaggedOrigin;
+	State.ViewOriginOffset = OriginOffset;
+	State.ViewLocalArm = LocalArm;
+}
+
+bool UCameraSpringArm::PredictView(float SecondsAhead, FVector& OutLocation, FRotator& OutRotation) const
+{
+	const FCameraSpringArmState& State = ArmState;
+	if (!State.bHasViewMotion) { return false; }
+
+	const FCameraRigSettings& Rig = GetRigSettings();
+
+	// The target moves with the owner, and with any transition moving the arm relative to it
+	const FVector OwnerVelocity = GetOwner() ? GetOwner()->GetVelocity() : FVector::ZeroVector;
+	const FVector PredictedOrigin = State.ViewArmOrigin + (OwnerVelocity + State.ViewOriginOffsetVelocity) * SecondsAhead;
+
+	// Location lag closes the gap to the target exponentially
+	FVector PredictedLaggedOrigin = PredictedOrigin;
+	if (Rig.bEnableCameraLag && Rig.CameraLagSpeed > 0.f)
+	{
+		PredictedLaggedOrigin += (State.ViewLaggedOrigin - State.ViewArmOrigin) * FMath::Exp(-Rig.CameraLagSpeed * SecondsAhead);
+	}
+
+	OutRotation = (State.ViewRotation + State.ViewAngularVelocity * SecondsAhead).GetNormalized();
+	OutLocation = PredictedLaggedOrigin + OutRotation.RotateVector(State.ViewLocalArm + State.ViewLocalArmVelocity * SecondsAhead);
+	return true;
+}
+
+void UCameraSpringArm::UpdateFadedOccluders()
+{
+	CurrentOccluders.Reset();
+	for (const FHitResult& Hit : ArmState.OccluderHits)
+	{
+		UPrimitiveComponent* Occluder = Hit.GetComponent();
+		if (Occluder && !Occluder->IsA<UCameraProxyComponent>())
+		{
+			CurrentOccluders.AddUnique(Occluder);
+		}
+	}
+
+	// Unfade whatever left the set since last frame
+	for (int32 FadedIndex = FadedOccluders.Num() - 1; FadedIndex >= 0; --FadedIndex)
+	{
+		UPrimitiveComponent* Faded = FadedOccluders[FadedIndex].Get();
+		if (Faded && CurrentOccluders.Contains(Faded)) { continue; }
+
+		if (Faded)
+		{
+			SetOccluderFaded(Faded, false);
+		}
+		FadedOccluders.RemoveAtSwap(FadedIndex, 1, false);
+	}
+
+	// Fade whatever entered it; primitives that stay in the set aren't touched
+	for (UPrimitiveComponent* Occluder : CurrentOccluders)
+	{
+		if (!FadedOccluders.Contains(Occluder))
+		{
+			SetOccluderFaded(Occluder, true);
+			FadedOccluders.Add(Occluder);
+		}
+	}
+}
 
+void UCameraSpringArm::RestoreFadedOccluders()
+{
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Faded : FadedOccluders)
+	{
+		if (UPrimitiveComponent* Occluder = Faded.Get())
+		{
+			SetOccluderFaded(Occluder, false);
+		}
+	}
+	FadedOccluders.Reset();
+}
 
-	UpdateChildTransforms();
+void UCameraSpringArm::SetOccluderFaded(UPrimitiveComponent* Occluder, bool bFaded) const
+{
+	const FCameraRigSettings& Rig = GetRigSettings();
+	Occluder->SetScalarParameterValueOnMaterials(Rig.OccluderFadeParameter, bFaded ? Rig.OccludedFadeValue : 1.f);
 }
 
 FVector UCameraSpringArm::BlendLocations(const FVector& DesiredArmLocation, const FVector& TraceHitLocation, bool bHitSomething, float DeltaTime)
@@ -227,13 +1218,208 @@ FVector UCameraSpringArm::BlendLocations(const FVector& DesiredArmLocation, cons
 void UCameraSpringArm::ApplyWorldOffset(const FVector& InOffset, bool bWorldShift)
 {
 	Super::ApplyWorldOffset(InOffset, bWorldShift);
-	PreviousDesiredLoc += InOffset;
-	PreviousArmOrigin += InOffset;
+	ArmState.PreviousDesiredLoc += InOffset;
+	ArmState.PreviousArmOrigin += InOffset;
+	ArmState.ViewArmOrigin += InOffset;
+	ArmState.ViewLaggedOrigin += InOffset;
+	ArmState.ProbeStart += InOffset;
+	ArmState.ProbeEnd += InOffset;
+	if (RigBlend)
+	{
+		RigBlend->LagState.PreviousDesiredLoc += InOffset;
+		RigBlend->LagState.PreviousArmOrigin += InOffset;
+	}
+	CommittedSocketTransform.AddToTranslation(InOffset);
 }
 
 void UCameraSpringArm::PostLoad()
 {
 	Super::PostLoad();
+#if WITH_EDITORONLY_DATA
+	MigrateDeprecatedRigProperties();
+#endif
+	ResolveRigSettings();
+}
+
+void UCameraSpringArm::BeginDestroy()
+{
+	UCameraRigPreset::ReleaseSettings(ActiveRigSettings);
+	ActiveRigSettings = nullptr;
+
+	Super::BeginDestroy();
+}
+
+void UCameraSpringArm::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// Everything the arm allocates beyond its own object
+	SIZE_T Bytes = sizeof(FCameraPoseSnapshotBuffer);
+	Bytes += RigOverrides.GetAllocatedSize() + Rigs.GetAllocatedSize();
+	Bytes += ArmState.OccluderHits.GetAllocatedSize() + FadedOccluders.GetAllocatedSize() + CurrentOccluders.GetAllocatedSize();
+	if (History)
+	{
+		Bytes += sizeof(FCameraHistory) + History->GetAllocatedSize();
+	}
+	if (RigBlend)
+	{
+		Bytes += sizeof(FCameraRigBlend);
+	}
+	if (PendingInputCurve)
+	{
+		Bytes += sizeof(FCameraInputCurve);
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Bytes);
+}
+
+void UCameraSpringArm::LogRigMemory()
+{
+	int32 NumArms = 0;
+	int32 NumOverrides = 0;
+	SIZE_T ObjectBytes = 0;
+	SIZE_T OverrideBytes = 0;
+	for (TObjectIterator<UCameraSpringArm> It; It; ++It)
+	{
+		if (It->IsTemplate()) { continue; }
+
+		++NumArms;
+		NumOverrides += It->RigOverrides.Num();
+		ObjectBytes += It->GetClass()->GetStructureSize();
+		OverrideBytes += It->RigOverrides.GetAllocatedSize();
+	}
+
+	int32 NumPooled = 0;
+	SIZE_T PoolBytes = 0;
+	UCameraRigPreset::GetPoolStats(NumPooled, PoolBytes);
+
+	// What each arm holds for its rig: the settings pointer, the override mask and array, plus its share of the pool
+	const SIZE_T InlineBytes = sizeof(ActiveRigSettings) + sizeof(RigOverrideMask) + sizeof(RigOverrides);
+	const SIZE_T RigBytes = NumArms * InlineBytes + OverrideBytes + PoolBytes;
+
+	UE_LOG(LogCameraRig, Log, TEXT("%d arms, %d overrides, %d pooled settings (%llu B). Arm object %.0f B on average."),
+		NumArms, NumOverrides, NumPooled, (uint64)PoolBytes, NumArms > 0 ? (double)ObjectBytes / NumArms : 0.0);
+	UE_LOG(LogCameraRig, Log, TEXT("Rig settings per arm: %.1f B measured, against %llu B for a copy of FCameraRigSettings on every arm."),
+		NumArms > 0 ? (double)RigBytes / NumArms : 0.0, (uint64)sizeof(FCameraRigSettings));
+}
+
+#if WITH_EDITORONLY_DATA
+void UCameraSpringArm::MigrateDeprecatedRigProperties()
+{
+	const FCameraRigSettings& Defaults = UCameraRigPreset::GetDefaultSettings();
+
+	auto Migrate = [this](ECameraRigOverride Field, float OldValue, float DefaultValue)
+	{
+		// Overrides saved since the migration win over the old value
+		if (OldValue == DefaultValue || RigOverrides.ContainsByPredicate([Field](const FCameraRigOverride& Override) { return Override.Field == Field; }))
+		{
+			return;
+		}
+
+		FCameraRigOverride NewOverride;
+		NewOverride.Field = Field;
+		NewOverride.Value = OldValue;
+		RigOverrides.Add(NewOverride);
+	};
+
+	Migrate(ECameraRigOverride::ProbeSize, ProbeSize_DEPRECATED, Defaults.ProbeSize);
+	Migrate(ECameraRigOverride::ProbeChannel, (float)ProbeChannel_DEPRECATED.GetValue(), (float)Defaults.ProbeChannel.GetValue());
+	Migrate(ECameraRigOverride::DoCollisionTest, bDoCollisionTest_DEPRECATED, Defaults.bDoCollisionTest);
+	Migrate(ECameraRigOverride::InheritPitch, bInheritPitch_DEPRECATED, Defaults.bInheritPitch);
+	Migrate(ECameraRigOverride::InheritYaw, bInheritYaw_DEPRECATED, Defaults.bInheritYaw);
+	Migrate(ECameraRigOverride::InheritRoll, bInheritRoll_DEPRECATED, Defaults.bInheritRoll);
+	Migrate(ECameraRigOverride::EnableCameraLag, bEnableCameraLag_DEPRECATED, Defaults.bEnableCameraLag);
+	Migrate(ECameraRigOverride::EnableCameraRotationLag, bEnableCameraRotationLag_DEPRECATED, Defaults.bEnableCameraRotationLag);
+	Migrate(ECameraRigOverride::UseCameraLagSubstepping, bUseCameraLagSubstepping_DEPRECATED, Defaults.bUseCameraLagSubstepping);
+	Migrate(ECameraRigOverride::CameraLagSpeed, CameraLagSpeed_DEPRECATED, Defaults.CameraLagSpeed);
+	Migrate(ECameraRigOverride::CameraRotationLagSpeed, CameraRotationLagSpeed_DEPRECATED, Defaults.CameraRotationLagSpeed);
+	Migrate(ECameraRigOverride::CameraLagMaxTimeStep, CameraLagMaxTimeStep_DEPRECATED, Defaults.CameraLagMaxTimeStep);
+	Migrate(ECameraRigOverride::CameraLagMaxDistance, CameraLagMaxDistance_DEPRECATED, Defaults.CameraLagMaxDistance);
+}
+#endif
+
+void UCameraSpringArm::OnRegister()
+{
+	Super::OnRegister();
+
+	// Servers still need the resolved settings to validate the camera locations clients report
+	ResolveRigSettings();
+
+	// Arms added in Blueprint still exist on dedicated servers; nobody views through them, so they never tick or sweep
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		PrimaryComponentTick.bCanEverTick = false;
+		return;
+	}
+
+	ProbeQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(SpringArm), false, GetOwner());
+
+	UWorld* World = GetWorld();
+	ConstraintSubsystem = World && World->IsGameWorld() ? World->GetSubsystem<UCameraConstraintSubsystem>() : nullptr;
+	ArmSubsystem = World && World->IsGameWorld() ? World->GetSubsystem<UCameraArmSubsystem>() : nullptr;
+
+	if (World && World->IsGameWorld())
+	{
+		if (bRecordHistory && !History)
+		{
+			History = MakeUnique<FCameraHistory>(HistorySeconds, HistorySampleRate);
+		}
+
+		AddCameraTickPrerequisites(PrimaryComponentTick, GetOwner());
+
+		if (ArmSubsystem)
+		{
+			ArmSubsystem->RegisterArm(this);
+		}
+	}
+}
+
+void UCameraSpringArm::OnUnregister()
+{
+	RestoreFadedOccluders();
+
+	if (ArmSubsystem)
+	{
+		ArmSubsystem->UnregisterArm(this);
+		ArmSubsystem = nullptr;
+	}
+
+	Super::OnUnregister();
+}
+
+#if WITH_EDITOR
+void UCameraSpringArm::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	ResolveRigSettings();
+}
+
+bool UCameraSpringArm::ShouldUpdateInEditor(bool& bOutSettle) const
+{
+	bOutSettle = false;
+
+	// PIE and every other game world always runs the full simulation
+	const UWorld* World = GetWorld();
+	if (!World || World->WorldType != EWorldType::Editor) { return true; }
+
+	const int32 Policy = CVarCameraEditorUpdatePolicy.GetValueOnGameThread();
+	if (Policy <= 0) { return true; }
+
+	const AActor* Owner = GetOwner();
+	if (IsSelectedInEditor() || (Owner && Owner->IsSelectedInEditor())) { return true; }
+	if (Policy == 1 && Owner && Owner->WasRecentlyRendered(EditorVisibleTolerance)) { return true; }
+
+	bOutSettle = bEditorUpdatePending;
+	return bEditorUpdatePending;
+}
+#endif
+
+void UCameraSpringArm::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+#if WITH_EDITORONLY_DATA
+	bEditorUpdatePending = true;
+#endif
 }
 
 void UCameraSpringArm::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -242,7 +1428,43 @@ void UCameraSpringArm::TickComponent(float DeltaTime, enum ELevelTick TickType,
 
 	//UE_LOG(LogTemp, Warning, TEXT("%s   and   %s"), *RelativeLocation.ToString(), *ActualSocketOffset.ToString());
 
-	UpdateDesiredArmLocation(bDoCollisionTest, bEnableCameraLag, bEnableCameraRotationLag, DeltaTime);
+#if WITH_EDITORONLY_DATA
+	if (RigPreset && RigPreset->GetRevision() != ResolvedPresetRevision)
+	{
+		ResolveRigSettings();
+	}
+#endif
+
+#if WITH_EDITOR
+	bool bSettle = false;
+	if (!ShouldUpdateInEditor(bSettle)) { return; }
+
+	if (bSettle)
+	{
+		// Nobody is watching this arm, so show where it comes to rest instead of one step of lag towards it
+		PrepareFrame(DeltaTime);
+		UpdateDesiredArmLocation(GetRigSettings().bDoCollisionTest, false, false, DeltaTime);
+
+		// Cleared last, so anything the update itself moves does not queue another one
+		bEditorUpdatePending = false;
+		return;
+	}
+#endif
+
+	if (SkipForBudget(DeltaTime)) { return; }
+
+	CAMERA_FRAME_SCOPE();
+	const double StartTime = FPlatformTime::Seconds();
+
+	PrepareFrame(DeltaTime);
+
+	const FCameraRigSettings& Rig = GetRigSettings();
+	UpdateDesiredArmLocation(Rig.bDoCollisionTest, Rig.bEnableCameraLag, Rig.bEnableCameraRotationLag, DeltaTime);
+
+	if (ArmSubsystem)
+	{
+		ArmSubsystem->AddFrameCost(FPlatformTime::Seconds() - StartTime);
+	}
 
 }
 
@@ -286,10 +1508,10 @@ void UCameraSpringArm::QuerySupportedSockets(TArray<FComponentSocketDescription>
 
 FVector UCameraSpringArm::GetUnfixedCameraPosition() const
 {
-	return UnfixedCameraPosition;
+	return ArmState.UnfixedCameraPosition;
 }
 
 bool UCameraSpringArm::IsCollisionFixApplied() const
 {
-	return bIsCameraFixed;
+	return ArmState.bIsCameraFixed;
 }
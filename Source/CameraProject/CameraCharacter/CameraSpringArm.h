@@ -4,8 +4,227 @@
 
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
+#include "CameraRigPreset.h"
+#include "CameraStats.h"
+#include "CameraHistory.h"
+#include "CameraBudgetGovernor.h"
+#include "CameraLatency.h"
+#include "CameraGroupFraming.h"
+#include "CameraPoseSnapshot.h"
+#include "CollisionQueryParams.h"
 #include "CameraSpringArm.generated.h"
 
+class UPrimitiveComponent;
+class UCameraConstraintSubsystem;
+class UCameraArmSubsystem;
+class UCameraComponent;
+
+/** Where lag left the arm last update, which is all a rig needs carried from one frame to the next */
+struct FCameraLagState
+{
+	/** Temporary variables when using camera lag, to record previous camera position */
+	FVector PreviousDesiredLoc = FVector::ZeroVector;
+	FVector PreviousArmOrigin = FVector::ZeroVector;
+	/** Temporary variable for lagging camera rotation, for previous rotation */
+	FRotator PreviousDesiredRot = FRotator::ZeroRotator;
+};
+
+
+/** Per-instance camera state that changes every frame; kept apart from the shared rig settings */
+struct FCameraSpringArmState : public FCameraLagState
+{
+	/** Temporary variables when applying Collision Test displacement to notify if its being applied and by how much */
+	bool bIsCameraFixed = false;
+	FVector UnfixedCameraPosition = FVector::ZeroVector;
+
+	/** Adaptive probe: the arm segment probed last frame, and whether and how far along it the probe hit */
+	FVector ProbeStart = FVector::ZeroVector;
+	FVector ProbeEnd = FVector::ZeroVector;
+	bool bProbeHadHit = false;
+	float ProbeHitTime = 1.f;
+	/** Free space around the arm beyond ProbeSize that is still guaranteed since the last refresh */
+	float ProbeMargin = 0.f;
+	/** How far the arm has moved since its whole length was last swept */
+	float ProbeDrift = 0.f;
+	int32 FramesSinceProbeRefresh = MAX_int32;
+	/** Frames in a row the last query's result has been reused to save budget */
+	int32 ProbeReuseCount = 0;
+
+	/** Result of this arm's last single sweep, reused rather than built on the stack every query */
+	FHitResult ProbeHit;
+
+	/** View motion measured at each commit, which PredictView extrapolates from */
+	bool bHasViewMotion = false;
+	FRotator ViewRotation = FRotator::ZeroRotator;
+	FRotator ViewAngularVelocity = FRotator::ZeroRotator;
+	FVector ViewArmOrigin = FVector::ZeroVector;
+	FVector ViewLaggedOrigin = FVector::ZeroVector;
+	/** Arm origin relative to the owner, and how fast transitions are moving it */
+	FVector ViewOriginOffset = FVector::ZeroVector;
+	FVector ViewOriginOffsetVelocity = FVector::ZeroVector;
+	/** Camera relative to the lagged origin in the arm's own rotation, and how fast that is changing */
+	FVector ViewLocalArm = FVector::ZeroVector;
+	FVector ViewLocalArmVelocity = FVector::ZeroVector;
+
+	/** With FadeOccluders, everything the last multi-sweep touched; reused so a stable set doesn't allocate */
+	TArray<FHitResult> OccluderHits;
+};
+
+
+/**
+ * Rotation input that arrived during one frame, as running totals at the moments it arrived. Lets rotation lag
+ * follow input as it really happened across a long frame instead of assuming it was spread evenly.
+ */
+struct CAMERAPROJECT_API FCameraInputCurve
+{
+	static const int32 MaxKnots = 16;
+
+	int32 NumKnots = 0;
+	/** How far through the frame each knot arrived, from 0 to 1 and increasing */
+	float Alphas[MaxKnots];
+	/** Total rotation input received up to each knot */
+	FRotator Offsets[MaxKnots];
+
+	void Reset() { NumKnots = 0; }
+
+	/** Appends a knot; once full, the last knot is moved forward instead */
+	void AddKnot(float Alpha, const FRotator& Offset);
+
+	FRotator GetTotal() const { return NumKnots > 0 ? Offsets[NumKnots - 1] : FRotator::ZeroRotator; }
+
+	/** Rotation input received by Alpha through the frame, linear between knots */
+	FRotator Evaluate(float Alpha) const;
+};
+
+
+/** Called on the game thread at the start of each arm update, before any inputs are gathered */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCameraArmPrepareFrame, float /*DeltaTime*/);
+
+
+/** Inputs and results of one arm update, handed from each stage of the update to the next */
+struct FCameraArmFrame
+{
+	float DeltaTime = 0.f;
+	bool bDoTrace = false;
+	bool bDoLocationLag = false;
+	bool bDoRotationLag = false;
+
+	/** How much quality the budget governor lets this update use */
+	ECameraBudgetLevel BudgetLevel = ECameraBudgetLevel::Full;
+
+	/** Gathered target rotation, replaced by the lagged rotation once lag is solved */
+	FRotator DesiredRot = FRotator::ZeroRotator;
+	/** Lagged DesiredRot as a quaternion, converted by the lag solver so the commit needs no trig of its own */
+	FQuat DesiredQuat = FQuat::Identity;
+	FVector ArmOrigin = FVector::ZeroVector;
+	float TargetArmLength = 0.f;
+	FVector SocketOffset = FVector::ZeroVector;
+
+	/** Timing of the control rotation input behind DesiredRot, if the owner provided it */
+	FCameraInputCurve InputCurve;
+
+	/** Gathered target rotation, kept after lag replaces DesiredRot so latency tracking can see how far behind lag left it */
+	FRotator TargetRot = FRotator::ZeroRotator;
+
+	/** When the look input behind this frame arrived and was read, if the owner stamped it */
+	FCameraLatencyStamp LatencyStamp;
+
+	/** Arm origin after location lag, and whether CameraLagMaxDistance clamped it */
+	FVector LaggedOrigin = FVector::ZeroVector;
+	bool bClampedDist = false;
+
+	/** Camera location before the collision test */
+	FVector DesiredLoc = FVector::ZeroVector;
+
+	bool bTraced = false;
+	bool bHitSomething = false;
+	/** The collision test collected occluders to fade into ArmState.OccluderHits rather than pulling the camera in */
+	bool bFadeOccluders = false;
+	FVector HitLocation = FVector::ZeroVector;
+
+	/** Query the collision test picked, and what it leaves for the next frame's pick */
+	ECameraProbeTier ProbeTier = ECameraProbeTier::Sphere;
+	float ProbeMovement = 0.f;
+	float ProbeMargin = 0.f;
+	float ProbeHitTime = 1.f;
+
+	/** Final camera location */
+	FVector ResultLoc = FVector::ZeroVector;
+};
+
+
+/** Solves location and rotation lag for one rig, from a frame's gathered inputs into its lagged outputs */
+typedef void (*FCameraLagSolver)(const FCameraRigSettings& Rig, FCameraLagState& State, FCameraArmFrame& Frame);
+
+/**
+ * Lag solvers specialized for one rig's lag flags and for Camera.FastTrig, so the per-frame solve never branches on
+ * configuration. Picked again whenever the rig settings or those console variables change; the budget only switches
+ * between the two it holds. With Camera.SpecializedSolvers off, both are the generic solver, which reads every lag
+ * flag as it goes.
+ */
+struct CAMERAPROJECT_API FCameraLagSolvers
+{
+	FCameraLagSolver Full = nullptr;
+	/** Same solver with substepping compiled out, for when the budget governor drops substeps */
+	FCameraLagSolver NoSubsteps = nullptr;
+
+	/** Flags the solvers were picked for */
+	bool bRotationLag = false;
+	bool bLocationLag = false;
+	bool bSubstep = false;
+	bool bClampDistance = false;
+	bool bFastTrig = false;
+
+	/** Picked with Camera.SpecializedSolvers off, so every frame runs the generic solver whatever it asks for */
+	bool bGeneric = false;
+
+	/** GetSelectionSerial() when these were picked */
+	uint32 SelectionSerial = 0;
+
+	static FCameraLagSolvers Select(const FCameraRigSettings& Rig);
+
+	/** Solver specialized for exactly these flags */
+	static FCameraLagSolver Find(bool bRotationLag, bool bLocationLag, bool bSubstep, bool bClampDistance, bool bFastTrig);
+
+	/** Changes whenever a console variable the picks depend on does, so solvers picked before it need picking again */
+	static uint32 GetSelectionSerial();
+
+	bool IsStale() const { return SelectionSerial != GetSelectionSerial(); }
+
+	/** Solver for Frame: the picked one, unless the frame asks for different lag than the rig it was picked for */
+	FCameraLagSolver Get(const FCameraArmFrame& Frame) const
+	{
+		if (bGeneric) { return Full; }
+
+		const bool bWantSubsteps = bSubstep && Frame.BudgetLevel < ECameraBudgetLevel::NoSubsteps;
+		if (Full && Frame.bDoRotationLag == bRotationLag && Frame.bDoLocationLag == bLocationLag)
+		{
+			return bWantSubsteps ? Full : NoSubsteps;
+		}
+		return Find(Frame.bDoRotationLag, Frame.bDoLocationLag, bWantSubsteps, bClampDistance, bFastTrig);
+	}
+};
+
+
+/** The rig an arm is blending away from: a copy of its settings and geometry, and its own lag state */
+struct FCameraRigBlend
+{
+	FCameraRigSettings Settings;
+	float ArmLength = 0.f;
+	FVector SocketOffset = FVector::ZeroVector;
+	FVector TargetOffset = FVector::ZeroVector;
+	FCameraLagState LagState;
+	FCameraLagSolvers LagSolvers;
+
+	/** Inputs and results of the outgoing rig's lag, reused every blended update */
+	FCameraArmFrame Frame;
+
+	float Duration = 0.f;
+	float Elapsed = 0.f;
+
+	bool IsFinished() const { return Elapsed >= Duration; }
+};
+
 
 /**
  * This component tries to maintain its children at a fixed distance from the parent,
@@ -33,17 +252,13 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
 		FRotator ControlOffset;
 
-	/** How big should the query probe sphere be (in unreal units) */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
-		float ProbeSize;
+	/** Shared lag and probe tuning for this arm. Arms without a preset use the FCameraRigSettings defaults. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rig)
+		UCameraRigPreset* RigPreset;
 
-	/** Collision channel of the query probe (defaults to ECC_Camera) */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraCollision, meta = (editcondition = "bDoCollisionTest"))
-		TEnumAsByte<ECollisionChannel> ProbeChannel;
-
-	/** If true, do a collision test using ProbeChannel and ProbeSize to prevent camera clipping into level.  */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraCollision)
-		uint32 bDoCollisionTest : 1;
+	/** Values this arm overrides locally on top of RigPreset; most arms leave this empty */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rig)
+		TArray<FCameraRigOverride> RigOverrides;
 
 	/**
 	 * If this component is placed on a pawn, should it use the view/control rotation of the pawn where possible?
@@ -57,39 +272,6 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraSettings)
 		uint32 bUsePawnControlRotation : 1;
 
-	/** Should we inherit pitch from parent component. Does nothing if using Absolute Rotation. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraSettings)
-		uint32 bInheritPitch : 1;
-
-	/** Should we inherit yaw from parent component. Does nothing if using Absolute Rotation. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraSettings)
-		uint32 bInheritYaw : 1;
-
-	/** Should we inherit roll from parent component. Does nothing if using Absolute Rotation. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = CameraSettings)
-		uint32 bInheritRoll : 1;
-
-	/**
-	 * If true, camera lags behind target position to smooth its movement.
-	 * @see CameraLagSpeed
-	 */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag)
-		uint32 bEnableCameraLag : 1;
-
-	/**
-	 * If true, camera lags behind target rotation to smooth its movement.
-	 * @see CameraRotationLagSpeed
-	 */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag)
-		uint32 bEnableCameraRotationLag : 1;
-
-	/**
-	 * If bUseCameraLagSubstepping is true, sub-step camera damping so that it handles fluctuating frame rates well (though this comes at a cost).
-	 * @see CameraLagMaxTimeStep
-	 */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag, AdvancedDisplay)
-		uint32 bUseCameraLagSubstepping : 1;
-
 	/**
 	 * If true and camera location lag is enabled, draws markers at the camera target (in green) and the lagged position (in yellow).
 	 * A line is drawn between the two locations, in green normally but in red if the distance to the lag target has been clamped (by CameraLagMaxDistance).
@@ -97,21 +279,27 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag)
 		uint32 bDrawDebugLagMarkers : 1;
 
-	/** If bEnableCameraLag is true, controls how quickly camera reaches target position. Low values are slower (more lag), high values are faster (less lag), while zero is instant (no lag). */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag, meta = (editcondition = "bEnableCameraLag", ClampMin = "0.0", ClampMax = "1000.0", UIMin = "0.0", UIMax = "1000.0"))
-		float CameraLagSpeed;
+	/**
+	 * Hand the committed camera pose straight to the view through GetCommittedView instead of moving the children
+	 * every update. Children are only moved when FlushChildTransforms is called, or by UCameraArmSubsystem after every
+	 * actor has ticked if the arm has children besides its direct view component. Anything reading the view
+	 * component's transform must flush first. Owners must read the view from GetCommittedView, as
+	 * ACameraProjectCharacter::CalcCamera does.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera)
+		uint32 bDirectViewOutput : 1;
 
-	/** If bEnableCameraRotationLag is true, controls how quickly camera reaches target position. Low values are slower (more lag), high values are faster (less lag), while zero is instant (no lag). */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag, meta = (editcondition = "bEnableCameraRotationLag", ClampMin = "0.0", ClampMax = "1000.0", UIMin = "0.0", UIMax = "1000.0"))
-		float CameraRotationLagSpeed;
+	/** Keep a compact history of where the camera sat relative to the owner, for instant replays */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Replay)
+		uint32 bRecordHistory : 1;
 
-	/** Max time step used when sub-stepping camera lag. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag, AdvancedDisplay, meta = (editcondition = "bUseCameraLagSubstepping", ClampMin = "0.005", ClampMax = "0.5", UIMin = "0.005", UIMax = "0.5"))
-		float CameraLagMaxTimeStep;
+	/** How far back the history reaches; its memory is allocated up front for this many seconds at HistorySampleRate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Replay, meta = (EditCondition = "bRecordHistory", ClampMin = "1.0"))
+		float HistorySeconds;
 
-	/** Max distance the camera target may lag behind the current location. If set to zero, no max distance is enforced. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Lag, meta = (editcondition = "bEnableCameraLag", ClampMin = "0.0", UIMin = "0.0"))
-		float CameraLagMaxDistance;
+	/** Most samples recorded per second; faster updates skip samples */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Replay, meta = (EditCondition = "bRecordHistory", ClampMin = "1.0"))
+		float HistorySampleRate;
 
 	/**
 	 * Get the target rotation we inherit, used as the base target for the boom rotation.
@@ -120,40 +308,228 @@ public:
 	UFUNCTION(BlueprintCallable, Category = SpringArm)
 		FRotator GetTargetRotation() const;
 
-	/** Get the position where the camera should be without applying the Collision Test displacement */
+	/** Get the position where the camera should be without applying the Collision Test displacement. Game thread only; other threads read GetPoseSnapshot. */
 	UFUNCTION(BlueprintCallable, Category = CameraCollision)
 		FVector GetUnfixedCameraPosition() const;
 
-	/** Is the Collision Test displacement being applied? */
+	/** Is the Collision Test displacement being applied? Game thread only; other threads read GetPoseSnapshot. */
 	UFUNCTION(BlueprintCallable, Category = CameraCollision)
 		bool IsCollisionFixApplied() const;
 
-	/** Temporary variables when applying Collision Test displacement to notify if its being applied and by how much */
-	bool bIsCameraFixed = false;
-	FVector UnfixedCameraPosition;
+	/**
+	 * Extrapolates where the end of the arm will be SecondsAhead from the last update, from the owner's velocity,
+	 * the remaining location lag, and how fast rotation and transitions were changing the arm when it was committed.
+	 * Meant for prefetching, so it favours being cheap over being exact. Returns false before the first update.
+	 */
+	UFUNCTION(BlueprintCallable, Category = SpringArm)
+		bool PredictView(float SecondsAhead, FVector& OutLocation, FRotator& OutRotation) const;
 
-	/** Temporary variables when using camera lag, to record previous camera position */
-	FVector PreviousDesiredLoc;
-	FVector PreviousArmOrigin;
-	/** Temporary variable for lagging camera rotation, for previous rotation */
-	FRotator PreviousDesiredRot;
+	/** World transform of the socket as of the last commit; false before the first update */
+	bool GetCommittedView(FTransform& OutSocketTransform) const
+	{
+		OutSocketTransform = CommittedSocketTransform;
+		return bHasCommittedView;
+	}
+
+	/**
+	 * Pose published at every commit, for code on other threads. Readers should keep the returned buffer rather than
+	 * the arm: it stays valid after the arm is destroyed, and reading it never touches the component.
+	 */
+	TSharedRef<const FCameraPoseSnapshotBuffer, ESPMode::ThreadSafe> GetPoseSnapshot() const { return PoseSnapshot.ToSharedRef(); }
+
+	/**
+	 * Did the arm move after it was committed this frame? If so, the update read its owner's transform from before
+	 * something moved it, and the view is a frame behind the owner.
+	 */
+	bool ReadStaleTransform() const { return CommitFrameNumber == GFrameCounter && !GetComponentLocation().Equals(CommitComponentLocation); }
+
+	/** Moves the children to the committed socket if bDirectViewOutput left them behind */
+	UFUNCTION(BlueprintCallable, Category = SpringArm)
+		void FlushChildTransforms();
+
+	/** Child the owner places from GetCommittedView itself, so it only needs moving when something reads it */
+	void SetDirectViewComponent(USceneComponent* ViewComponent) { DirectViewComponent = ViewComponent; }
+
+	/** Does a commit with bDirectViewOutput leave anything besides the direct view component behind? */
+	bool HasChildrenBesideDirectView() const;
+
+	/** Committed socket transforms relative to the owner, or null unless bRecordHistory is set on a registered arm */
+	const FCameraHistory* GetHistory() const { return History.Get(); }
+
+	/** Turns recording on or off, allocating the history for a registered arm or freeing what it recorded */
+	UFUNCTION(BlueprintCallable, Category = Replay)
+		void SetRecordHistory(bool bRecord);
+
+	/** Pauses recording, e.g. while the history is being played back, without dropping what was recorded */
+	void SetHistoryPaused(bool bPaused) { bHistoryPaused = bPaused; }
+
+	/** Settings this arm currently simulates with: RigPreset plus any RigOverrides */
+	const FCameraRigSettings& GetRigSettings() const { return ActiveRigSettings ? *ActiveRigSettings : UCameraRigPreset::GetDefaultSettings(); }
+
+	/** Auto correct settings of RigPreset, used by the owning character when it moves the camera back into place */
+	const FCameraAutoCorrectSettings& GetAutoCorrectSettings() const { return RigPreset ? RigPreset->AutoCorrect : UCameraRigPreset::GetDefaultAutoCorrect(); }
+
+	/** Is Field overridden locally rather than taken from RigPreset? */
+	bool IsRigValueOverridden(ECameraRigOverride Field) const { return (RigOverrideMask & (1u << (uint32)Field)) != 0; }
+
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		void SetRigPreset(UCameraRigPreset* NewPreset);
+
+	/** Overrides a single preset value for this arm only */
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		void SetRigOverride(ECameraRigOverride Field, float Value);
+
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		void ClearRigOverride(ECameraRigOverride Field);
+
+	/** Logs what rig settings take up across every live arm, measured rather than estimated; see Camera.RigMemory */
+	static void LogRigMemory();
+
+	/** Named setups this arm can switch between with SetActiveRig */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Rig)
+		TArray<FCameraRig> Rigs;
+
+	/**
+	 * Makes the rig called RigName drive the arm, blending from the current setup over BlendTime seconds.
+	 * The new rig starts from the current lag state, so the switch doesn't pop; switching again mid-blend drops
+	 * the older outgoing rig. Returns false if there is no such rig.
+	 */
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		bool SetActiveRig(FName RigName, float BlendTime = 0.3f);
+
+	/** Name of the rig last switched to, or None before any switch */
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		FName GetActiveRig() const { return ActiveRigName; }
+
+	UFUNCTION(BlueprintCallable, Category = Rig)
+		bool IsBlendingRigs() const { return RigBlendDuration > 0.f; }
+
+	/** Room kept around each target while framing a group */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "0.0"))
+		float FramingTargetRadius;
+
+	/** Shortest and longest the arm may get while framing a group */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "0.0"))
+		float FramingMinArmLength;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "0.0"))
+		float FramingMaxArmLength;
+
+	/** Pitch the camera looks down at a framed group with; the yaw still comes from the target rotation */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "-89.0", ClampMax = "89.0"))
+		float FramingPitch;
+
+	/** Field of view and aspect ratio the group is fitted to when no camera is attached to the arm */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "5.0", ClampMax = "170.0"))
+		float FramingFieldOfView;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Framing, meta = (ClampMin = "0.1"))
+		float FramingAspectRatio;
+
+	/**
+	 * Frames every actor in Targets instead of following the owner: the arm origin moves to the centre of the group
+	 * and the arm lengthens until the whole group fits on screen. Both go through the rig's lag like any other move.
+	 */
+	UFUNCTION(BlueprintCallable, Category = Framing)
+		void SetFramingTargets(const TArray<AActor*>& Targets);
+
+	UFUNCTION(BlueprintCallable, Category = Framing)
+		void AddFramingTarget(AActor* Target);
+
+	UFUNCTION(BlueprintCallable, Category = Framing)
+		void RemoveFramingTarget(AActor* Target);
+
+	/** Goes back to following the owner, easing the arm back to TargetArmLength */
+	UFUNCTION(BlueprintCallable, Category = Framing)
+		void ClearFramingTargets();
+
+	/**
+	 * Furthest the arm puts its socket from its origin through TargetArmLength, any of its Rigs or FramingMaxArmLength,
+	 * with the largest socket and target offset among them. Ignores lag, and the framing origin moving to a group.
+	 */
+	float GetMaxReach() const;
+
+	UFUNCTION(BlueprintCallable, Category = Framing)
+		bool IsFramingGroup() const { return GroupFraming.Num() > 0; }
+
+	/** Runtime state of this arm, rewritten every update and never shared with other arms */
+	FCameraSpringArmState ArmState;
+
+	/** Owners hook per-frame camera work that changes the arm's inputs in here, such as ACameraProjectCharacter's transitions */
+	FOnCameraArmPrepareFrame OnPrepareFrame;
+
+	/**
+	 * Gives the arm the timing of this frame's control rotation input, so rotation lag substeps can follow it.
+	 * Only used with bUsePawnControlRotation, and cleared once the frame is committed.
+	 */
+	void SetInputCurve(const FCameraInputCurve& Curve);
+
+	/**
+	 * Stamps the look input applied this frame for Camera.LatencyTracking: InputTime is when it arrived and AppliedTime
+	 * when the owner added it to the controller. Stamping more than once a frame keeps the earliest arrival.
+	 */
+	void SetLatencyStamp(double InputTime, double AppliedTime)
+	{
+		if (!PendingLatencyStamp.IsValid() || InputTime < PendingLatencyStamp.InputTime)
+		{
+			PendingLatencyStamp.InputTime = InputTime;
+		}
+		PendingLatencyStamp.AppliedTime = FMath::Max(PendingLatencyStamp.AppliedTime, AppliedTime);
+	}
+
+	/** Runs OnPrepareFrame and reads the framed group. Always on the game thread, and always before GatherFrame. */
+	void PrepareFrame(float DeltaTime);
+
+	/**
+	 * The stages of UpdateDesiredArmLocation, split out so they can run away from the component's own tick.
+	 * Everything before CommitFrame only reads the world and writes this arm's ArmState, so it may run on a
+	 * worker thread alongside other arms; CommitFrame moves the children and must run on the game thread.
+	 */
+	void GatherFrame(FCameraArmFrame& Frame, bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime) const;
+
+	/** GatherFrame with the trace and lag flags taken from the rig settings */
+	void GatherRigFrame(FCameraArmFrame& Frame, float DeltaTime) const;
+	void SolveFrameLag(FCameraArmFrame& Frame);
+	void QueryFrameCollision(FCameraArmFrame& Frame);
+	void ResolveFrame(FCameraArmFrame& Frame);
+	void CommitFrame(const FCameraArmFrame& Frame);
+
+	/** Runs every stage up to the commit using the rig settings, as the batched update does */
+	void SolveFrame(FCameraArmFrame& Frame, float DeltaTime);
+
+	/**
+	 * Should this frame's update be skipped to stay within the camera budget? Time skipped is added to
+	 * InOutDeltaTime of the next update that runs, so lag still covers the whole interval.
+	 */
+	bool SkipForBudget(float& InOutDeltaTime);
 
 	FRotator ExtraArmRotation;
 	FVector ActualSocketOffset;
 
 	// UActorComponent interface
-	//virtual void OnRegister() override;
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	virtual void PostLoad() override;
+	virtual void BeginDestroy() override;
 	virtual void ApplyWorldOffset(const FVector& InOffset, bool bWorldShift) override;
 	// End of UActorComponent interface
 
+	// UObject interface
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	// End of UObject interface
+
 	// USceneComponent interface
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
 	virtual bool HasAnySockets() const override;
 	virtual FTransform GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace = RTS_World) const override;
 	virtual void QuerySupportedSockets(TArray<FComponentSocketDescription>& OutSockets) const override;
 	// End of USceneComponent interface
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	/** The name of the socket at the end of the spring arm (looking back towards the spring arm origin) */
 	static const FName SocketName;
 
@@ -166,6 +542,139 @@ protected:
 	/** Cached component-space socket rotation */
 	FQuat RelativeSocketRotation;
 
+	/** World space socket transform of the last commit, which the view reads directly with bDirectViewOutput */
+	FTransform CommittedSocketTransform;
+	bool bHasCommittedView = false;
+
+	/** Written at the end of every commit; shared so readers on other threads can outlive the arm */
+	TSharedPtr<FCameraPoseSnapshotBuffer, ESPMode::ThreadSafe> PoseSnapshot;
+
+	/** Fills in and publishes the pose of the commit of Frame, whose previous camera location was PreviousLocation */
+	void PublishPoseSnapshot(const FCameraArmFrame& Frame, const FVector& PreviousLocation, bool bHadPreviousView);
+
+	/** Set when a commit skipped moving the children */
+	bool bChildTransformsDirty = false;
+
+	/** See SetDirectViewComponent */
+	TWeakObjectPtr<USceneComponent> DirectViewComponent;
+
+	/** Where the arm was when it last committed, and on which frame, for ReadStaleTransform */
+	FVector CommitComponentLocation = FVector::ZeroVector;
+	uint64 CommitFrameNumber = 0;
+
+	/** Points into RigPreset, or into the shared pool when RigOverrides is not empty */
+	const FCameraRigSettings* ActiveRigSettings = nullptr;
+
+	/** Which values RigOverrides replaces, kept so lookups don't have to walk the array */
+	uint32 RigOverrideMask = 0;
+
+#if WITH_EDITORONLY_DATA
+	/** Preset revision ActiveRigSettings was resolved against, so edits to the preset show up while it is open */
+	uint32 ResolvedPresetRevision = 0;
+
+	/** In an editor world, the arm moved or its settings changed since it was last updated */
+	bool bEditorUpdatePending = true;
+#endif
+
+#if WITH_EDITOR
+	/**
+	 * Whether an editor world tick should update the arm, following Camera.EditorUpdatePolicy. bOutSettle is set
+	 * when the update is only to catch up with a change, which places the camera at rest rather than stepping lag.
+	 */
+	bool ShouldUpdateInEditor(bool& bOutSettle) const;
+#endif
+
+	/** Points ActiveRigSettings at the settings for the current preset and overrides */
+	void ResolveRigSettings();
+
+	/** Lag solvers for the active rig's settings, picked whenever they are resolved */
+	FCameraLagSolvers ActiveLagSolvers;
+
+	/** Picks ActiveLagSolvers and ActiveResolver for the resolved settings, and the outgoing rig's solvers */
+	void SelectSolvers();
+
+	/**
+	 * Resolve stage, specialized for whether BlendLocations is known to be this class's own, so the default blend
+	 * is inlined, or may be overridden and has to be called through the vtable
+	 */
+	template<bool bDefaultBlend>
+	void ResolveFrameSpecialized(FCameraArmFrame& Frame);
+
+	typedef void (UCameraSpringArm::*FCameraFrameResolver)(FCameraArmFrame& Frame);
+
+	/** Resolve stage picked with ActiveLagSolvers */
+	FCameraFrameResolver ActiveResolver;
+
+	/** Could this arm's class override BlendLocations? It isn't a UFUNCTION, so only native subclasses can */
+	bool MayOverrideBlendLocations() const;
+
+	FName ActiveRigName;
+
+	/** Outgoing rig, only allocated while SetActiveRig's blend runs and freed by the commit that finishes it */
+	TUniquePtr<FCameraRigBlend> RigBlend;
+
+	/** Measures how fast the committed view is moving, for PredictView */
+	void UpdateViewMotion(const FCameraArmFrame& Frame);
+
+	/** Constraint volume index of the arm's world, looked up once on register */
+	UCameraConstraintSubsystem* ConstraintSubsystem = nullptr;
+
+	/** Subsystem this arm is registered with, which also holds the budget governor */
+	UCameraArmSubsystem* ArmSubsystem = nullptr;
+
+	/** Frame time of the updates SkipForBudget skipped since the last one that ran */
+	float SkippedDeltaTime = 0.f;
+
+	/** Group being framed, empty when the arm follows its owner */
+	FCameraGroupFraming GroupFraming;
+
+	/** Camera attached to the arm, whose view the group is fitted to */
+	TWeakObjectPtr<UCameraComponent> FramingCamera;
+
+	/** Where framing puts the arm this frame, worked out on the game thread for GatherFrame to apply */
+	FVector FramingOrigin = FVector::ZeroVector;
+	float FramingArmLength = 0.f;
+
+	/** The arm length is still easing from the framing length back to TargetArmLength */
+	bool bFramingRelease = false;
+
+	/** Moves the group's bounds and fit on by one frame */
+	void UpdateGroupFraming(float DeltaTime);
+
+	/** Applies the camera constraint volumes containing the arm origin to the gathered inputs, before anything is swept */
+	void ApplyConstraints(FCameraArmFrame& Frame) const;
+
+	/** Input timing handed over by the owner for the next update, allocated the first time an owner hands any over */
+	TUniquePtr<FCameraInputCurve> PendingInputCurve;
+
+	/** Look input stamp handed over by the owner for the next update */
+	FCameraLatencyStamp PendingLatencyStamp;
+
+	/** Target rotation of the last commit, which the lag latency is measured against */
+	FRotator LatencyPreviousTargetRot = FRotator::ZeroRotator;
+
+	/** Query params for the collision test, built once on register since the owner they ignore never changes */
+	FCollisionQueryParams ProbeQueryParams;
+
+	/** Allocated on register when bRecordHistory is set, and added to on every commit */
+	TUniquePtr<FCameraHistory> History;
+
+	bool bHistoryPaused = false;
+
+	/** Primitives currently faded because they sit between the camera and the target */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> FadedOccluders;
+
+	/** Scratch list of this frame's occluders, reused every frame */
+	TArray<UPrimitiveComponent*> CurrentOccluders;
+
+	/** Diffs this frame's occluder hits against FadedOccluders and only touches the materials of primitives that entered or left */
+	void UpdateFadedOccluders();
+
+	/** Unfades every primitive this arm has faded */
+	void RestoreFadedOccluders();
+
+	void SetOccluderFaded(UPrimitiveComponent* Occluder, bool bFaded) const;
+
 protected:
 	UCameraSpringArm(const FObjectInitializer& ObjectInitializer);
 
@@ -175,6 +684,55 @@ protected:
 	/**
 	 * This function allows subclasses to blend the trace hit location with the desired arm location;
 	 * by default it returns bHitSomething ? TraceHitLocation : DesiredArmLocation
+	 * Overrides must be thread safe, as the batched update calls this from worker threads. Arms whose nearest native
+	 * class is UCameraSpringArm itself can't have an override, so they blend inline without calling this.
 	 */
 	virtual FVector BlendLocations(const FVector& DesiredArmLocation, const FVector& TraceHitLocation, bool bHitSomething, float DeltaTime);
+
+private:
+#if WITH_EDITORONLY_DATA
+	/** Moves tuning saved before rig presets existed into RigOverrides, for whatever differs from the defaults */
+	void MigrateDeprecatedRigProperties();
+
+	// Tuning that now lives in FCameraRigSettings. Only loaded from old data and moved into RigOverrides by PostLoad.
+	// Editor only, so cooked arms don't carry it: cooking loads and migrates the old data before saving RigOverrides.
+	UPROPERTY()
+		float ProbeSize_DEPRECATED;
+
+	UPROPERTY()
+		TEnumAsByte<ECollisionChannel> ProbeChannel_DEPRECATED;
+
+	UPROPERTY()
+		uint32 bDoCollisionTest_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bInheritPitch_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bInheritYaw_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bInheritRoll_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bEnableCameraLag_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bEnableCameraRotationLag_DEPRECATED : 1;
+
+	UPROPERTY()
+		uint32 bUseCameraLagSubstepping_DEPRECATED : 1;
+
+	UPROPERTY()
+		float CameraLagSpeed_DEPRECATED;
+
+	UPROPERTY()
+		float CameraRotationLagSpeed_DEPRECATED;
+
+	UPROPERTY()
+		float CameraLagMaxTimeStep_DEPRECATED;
+
+	UPROPERTY()
+		float CameraLagMaxDistance_DEPRECATED;
+#endif
 };
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraStreamingPrefetch.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "GameFramework/PlayerController.h"
+#include "CameraProjectPlayerController.h"
+#include "Camera/CameraTypes.h"
+#include "ContentStreaming.h"
+#include "UnrealClient.h"
+
+void FCameraStreamingPrefetch::RequestView(APlayerController* Viewer, const FMinimalViewInfo& View)
+{
+	check(IsInGameThread());
+	UWorld* World = Viewer ? Viewer->GetWorld() : nullptr;
+	if (!World) { return; }
+
+	// Texture and mesh streaming only need the view origin and how big the screen is
+	float ScreenSize = 1920.f;
+	if (GEngine && GEngine->GameViewport && GEngine->GameViewport->Viewport)
+	{
+		ScreenSize = FMath::Max(GEngine->GameViewport->Viewport->GetSizeXY().X, 1);
+	}
+	const float FOVScreenSize = ScreenSize / FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(View.FOV, 1.f, 170.f) * 0.5f));
+	// Requested again every frame, so only for the next streaming update rather than kept around for a duration
+	IStreamingManager::Get().AddViewInformation(View.Location, ScreenSize, FOVScreenSize, 1.f, false, 0.f);
+
+	// Streaming volumes are tested against the views rendered last frame; the list is rebuilt when the next frame is drawn
+	World->ViewLocationsRenderedLastFrame.Add(View.Location);
+
+	// World streaming asks the controller where to stream around in its own pass, rather than being run again from here
+	if (ACameraProjectPlayerController* CameraController = Cast<ACameraProjectPlayerController>(Viewer))
+	{
+		CameraController->SetStreamingPrefetchLocation(View.Location);
+	}
+}
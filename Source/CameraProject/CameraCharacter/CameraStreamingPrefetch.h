@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APlayerController;
+struct FMinimalViewInfo;
+
+/**
+ * Warms streaming for a view the camera is about to reach, on top of the views being rendered, so fast camera
+ * turns in large levels don't outrun texture, mesh and level streaming.
+ */
+struct CAMERAPROJECT_API FCameraStreamingPrefetch
+{
+	/**
+	 * Adds View, predicted for Viewer, to this frame's texture and mesh streaming views and to the view locations level
+	 * streaming volumes are tested against. If Viewer is an ACameraProjectPlayerController, its streaming source moves to
+	 * the view too, which world streaming picks up in its own update. Game thread only; call once a frame.
+	 */
+	static void RequestView(APlayerController* Viewer, const FMinimalViewInfo& View);
+};
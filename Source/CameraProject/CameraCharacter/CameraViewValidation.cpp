@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraViewValidation.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "CollisionQueryParams.h"
+#include "HAL/IConsoleManager.h"
+#include "CameraArmSubsystem.h"
+#include "CameraRigPreset.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraValidation, Log, All);
+
+static TAutoConsoleVariable<int32> CVarCameraViewValidation(
+	TEXT("Camera.ViewValidation"),
+	1,
+	TEXT("0: the server accepts every camera location clients report.\n")
+	TEXT("1: reported camera locations are checked against the reporting pawn's camera rig and the level's collision."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCameraViewValidationTolerance(
+	TEXT("Camera.ViewValidationTolerance"),
+	50.f,
+	TEXT("Distance a reported camera location may be off from what the pawn's camera rig allows before it is a violation."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCameraViewValidationLatency(
+	TEXT("Camera.ViewValidationLatency"),
+	0.25f,
+	TEXT("Seconds a reported camera location may lag behind the server's pawn; the pawn's speed over this long is added to the tolerance."),
+	ECVF_Default);
+
+/** Fraction of the arm's probe radius swept, so a camera resting against a wall doesn't graze it */
+static const float ProbeRadiusScale = 0.5f;
+
+void FCameraViewRig::SetRigSettings(const FCameraRigSettings& Rig)
+{
+	bLocationLag = Rig.bEnableCameraLag;
+	LagSpeed = Rig.CameraLagSpeed;
+	LagMaxDistance = Rig.CameraLagMaxDistance;
+
+	// Arms that fade occluders instead of pulling in may legitimately sit behind walls
+	bCheckOcclusion = Rig.bDoCollisionTest && Rig.CollisionResponse != ECameraCollisionResponse::FadeOccluders;
+	ProbeChannel = Rig.ProbeChannel;
+	ProbeSize = Rig.ProbeSize;
+}
+
+bool UCameraViewValidationSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && !IsRunningClientOnly();
+}
+
+void UCameraViewValidationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SweepDelegate.BindUObject(this, &UCameraViewValidationSubsystem::OnSweepDone);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCameraViewValidationSubsystem::OnWorldPostActorTick);
+}
+
+void UCameraViewValidationSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	Claims.Reset();
+	PendingSweeps.Reset();
+
+	Super::Deinitialize();
+}
+
+void UCameraViewValidationSubsystem::SubmitClaim(APawn* Pawn, const FCameraViewRig& Rig, const FVector& Location)
+{
+	if (!Pawn || CVarCameraViewValidation.GetValueOnGameThread() == 0) { return; }
+
+	FViewClaim* Claim = Claims.FindByPredicate([Pawn](const FViewClaim& Existing) { return Existing.Pawn == Pawn; });
+	if (!Claim)
+	{
+		Claim = &Claims.AddDefaulted_GetRef();
+		Claim->Pawn = Pawn;
+	}
+	Claim->Rig = Rig;
+	Claim->Location = Location;
+}
+
+void UCameraViewValidationSubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime)
+{
+	if (World != GetWorld() || Claims.Num() == 0) { return; }
+
+	// Listen servers also play, so checking claims shares their camera budget. If the governor ended its frame first, this counts towards the next one.
+	FCameraBudgetScope BudgetScope(this);
+
+	const float BaseTolerance = CVarCameraViewValidationTolerance.GetValueOnGameThread();
+	const float Latency = CVarCameraViewValidationLatency.GetValueOnGameThread();
+
+	for (const FViewClaim& Claim : Claims)
+	{
+		APawn* Pawn = Claim.Pawn.Get();
+		if (!Pawn) { continue; }
+
+		const FCameraViewRig& Rig = Claim.Rig;
+		const float Speed = Pawn->GetVelocity().Size();
+		const float Tolerance = BaseTolerance + Speed * Latency;
+
+		// Location lag trails by about speed over lag speed while catching up, never more than the lag's max distance
+		float LagAllowance = 0.f;
+		if (Rig.bLocationLag)
+		{
+			LagAllowance = Rig.LagSpeed > 0.f ? Speed / Rig.LagSpeed : 0.f;
+			if (Rig.LagMaxDistance > 0.f)
+			{
+				LagAllowance = FMath::Min(LagAllowance, Rig.LagMaxDistance);
+			}
+		}
+
+		const FVector ArmOrigin = Rig.ArmOrigin;
+		const float ClaimedDistance = FVector::Dist(ArmOrigin, Claim.Location);
+		const float Reach = Rig.MaxReach + LagAllowance + Tolerance;
+		if (ClaimedDistance > Reach)
+		{
+			ReportViolation(Pawn, ECameraViewViolation::OutOfReach, Claim.Location);
+			continue;
+		}
+
+		if (!Rig.bCheckOcclusion || ClaimedDistance <= Tolerance) { continue; }
+
+		const uint32 SweepId = NextSweepId++;
+		PendingSweeps.Add(SweepId, FClaimSweep{ Claim.Pawn, Claim.Location, ClaimedDistance, Tolerance });
+
+		const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CameraViewValidation), false, Pawn);
+		World->AsyncSweepByChannel(EAsyncTraceType::Single, ArmOrigin, Claim.Location, FQuat::Identity, Rig.ProbeChannel,
+			FCollisionShape::MakeSphere(Rig.ProbeSize * ProbeRadiusScale), QueryParams, FCollisionResponseParams::DefaultResponseParam,
+			&SweepDelegate, SweepId);
+	}
+
+	Claims.Reset();
+}
+
+void UCameraViewValidationSubsystem::OnSweepDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	FClaimSweep Sweep;
+	if (!PendingSweeps.RemoveAndCopyValue(Datum.UserData, Sweep)) { return; }
+
+	APawn* Pawn = Sweep.Pawn.Get();
+	if (!Pawn || Datum.OutHits.Num() == 0) { return; }
+
+	// An origin that starts inside geometry is the server's pawn overlapping something, not the client's doing
+	const FHitResult& Hit = Datum.OutHits[0];
+	if (Hit.bBlockingHit && !Hit.bStartPenetrating && Hit.Distance < Sweep.ClaimedDistance - Sweep.Tolerance)
+	{
+		ReportViolation(Pawn, ECameraViewViolation::Occluded, Sweep.Location);
+	}
+}
+
+void UCameraViewValidationSubsystem::ReportViolation(APawn* Pawn, ECameraViewViolation Violation, const FVector& Location)
+{
+	UE_LOG(LogCameraValidation, Log, TEXT("%s reported an %s camera at %s"), *GetNameSafe(Pawn),
+		Violation == ECameraViewViolation::OutOfReach ? TEXT("out of reach") : TEXT("occluded"), *Location.ToString());
+
+	OnViolation.Broadcast(Pawn, Violation, Location);
+}
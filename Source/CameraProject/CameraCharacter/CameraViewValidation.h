@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CameraViewValidation.generated.h"
+
+class APawn;
+struct FCameraRigSettings;
+
+/** Why the server rejected a camera location a client reported */
+enum class ECameraViewViolation : uint8
+{
+	/** Further from the arm origin than the rig's reach and lag allow */
+	OutOfReach,
+	/** Behind or inside geometry the arm's collision test would have pulled the camera in front of */
+	Occluded,
+};
+
+
+/**
+ * What view validation knows about a pawn's camera rig. Built from the pawn's own settings rather than its spring arm,
+ * which dedicated servers don't create and whose arm length and socket offset clients change without replicating.
+ */
+struct CAMERAPROJECT_API FCameraViewRig
+{
+	/** Where the arm starts, in world space */
+	FVector ArmOrigin = FVector::ZeroVector;
+
+	/** Furthest the end of the arm may get from ArmOrigin before lag, with arm length and socket offset at their limits */
+	float MaxReach = 0.f;
+
+	bool bLocationLag = false;
+	float LagSpeed = 0.f;
+	float LagMaxDistance = 0.f;
+
+	/** The arm pulls the camera in front of geometry, so a camera behind some is a violation */
+	bool bCheckOcclusion = false;
+	ECollisionChannel ProbeChannel = ECC_Camera;
+	float ProbeSize = 0.f;
+
+	/** Takes the lag and probe tuning from Rig */
+	void SetRigSettings(const FCameraRigSettings& Rig);
+};
+
+
+/** Broadcast on the game thread for every reported camera location that failed validation */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnCameraViewViolation, APawn* /*Pawn*/, ECameraViewViolation /*Violation*/, const FVector& /*ClaimedLocation*/);
+
+
+/**
+ * Checks the camera locations clients report against what their camera rig could actually reach, so servers of
+ * competitive modes can catch cameras pushed through walls. Claims are only queued as they arrive, keeping the
+ * latest one per pawn. Once a frame, after every actor has ticked, each claim is checked against the rig the pawn
+ * described with it: its reach and how far lag may trail. Claims within reach are then swept from the arm origin
+ * with the rig's probe, all of them as one batch of async traces, and the ones the probe could not have reached are
+ * reported through OnViolation once the traces finish the next frame. Nothing here needs the pawn's spring arm.
+ */
+UCLASS()
+class CAMERAPROJECT_API UCameraViewValidationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// USubsystem interface
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	/** Queues Location as where Rig put Pawn's camera, replacing any claim of Pawn's that hasn't been checked yet */
+	void SubmitClaim(APawn* Pawn, const FCameraViewRig& Rig, const FVector& Location);
+
+	/** Number of claim sweeps issued that haven't finished yet */
+	int32 GetNumPendingSweeps() const { return PendingSweeps.Num(); }
+
+	FOnCameraViewViolation OnViolation;
+
+private:
+	struct FViewClaim
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FCameraViewRig Rig;
+		FVector Location;
+	};
+
+	/** What a claim's sweep result is judged against once it finishes */
+	struct FClaimSweep
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FVector Location;
+		float ClaimedDistance;
+		float Tolerance;
+	};
+
+	/** Checks this frame's claims and issues the sweeps for the ones within reach */
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+
+	void OnSweepDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	void ReportViolation(APawn* Pawn, ECameraViewViolation Violation, const FVector& Location);
+
+	/** Latest unchecked claim of each pawn */
+	TArray<FViewClaim> Claims;
+
+	/** Sweeps in flight, by the id passed along as their user data */
+	TMap<uint32, FClaimSweep> PendingSweeps;
+
+	uint32 NextSweepId = 0;
+
+	FTraceDelegate SweepDelegate;
+
+	FDelegateHandle PostActorTickHandle;
+};
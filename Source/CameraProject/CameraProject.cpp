@@ -2,6 +2,34 @@
 
 #include "CameraProject.h"
 #include "Modules/ModuleManager.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/MovementComponent.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CameraProject, "CameraProject" );
+
+void AddCameraTickPrerequisites(FTickFunction& CameraTick, AActor* Owner)
+{
+	if (!Owner) { return; }
+
+	CameraTick.AddPrerequisite(Owner, Owner->PrimaryActorTick);
+
+	TInlineComponentArray<UMovementComponent*> MovementComponents(Owner);
+	for (UMovementComponent* Movement : MovementComponents)
+	{
+		CameraTick.AddPrerequisite(Movement, Movement->PrimaryComponentTick);
+	}
+}
+
+void RemoveCameraTickPrerequisites(FTickFunction& CameraTick, AActor* Owner)
+{
+	if (!Owner) { return; }
+
+	CameraTick.RemovePrerequisite(Owner, Owner->PrimaryActorTick);
+
+	TInlineComponentArray<UMovementComponent*> MovementComponents(Owner);
+	for (UMovementComponent* Movement : MovementComponents)
+	{
+		CameraTick.RemovePrerequisite(Movement, Movement->PrimaryComponentTick);
+	}
+}
  
\ No newline at end of file
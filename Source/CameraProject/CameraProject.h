@@ -3,3 +3,37 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CoreGlobals.h"
+#include "Engine/EngineBaseTypes.h"
+
+class AActor;
+
+/**
+ * Dedicated servers never view through a pawn's camera, so they skip creating camera components and the camera
+ * subsystems. Server targets compile the check down to false; the camera code itself is still built into them,
+ * it just never runs. What the skip saves is each pawn's camera component instances, their buffers and their ticks
+ * (CameraStress -MeasurePawnCost reports it); code size and the class default objects stay the same.
+ */
+inline bool ShouldCreateCameraComponents()
+{
+#if UE_SERVER
+	return false;
+#else
+	return !IsRunningDedicatedServer();
+#endif
+}
+
+/**
+ * Tick group of the camera phase. Camera updates run after the owner's actor tick and movement components have moved
+ * it for the frame, and before the player camera managers build the views once every tick group has run.
+ */
+static const ETickingGroup CameraTickGroup = TG_PostPhysics;
+
+/**
+ * Makes CameraTick wait for Owner's actor tick and every movement component on Owner, so the camera never reads the
+ * owner's transform from before this frame's movement, whatever groups those end up ticking in.
+ */
+CAMERAPROJECT_API void AddCameraTickPrerequisites(FTickFunction& CameraTick, AActor* Owner);
+
+/** Undoes AddCameraTickPrerequisites */
+CAMERAPROJECT_API void RemoveCameraTickPrerequisites(FTickFunction& CameraTick, AActor* Owner);
@@ -1,20 +1,40 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "CameraProjectCharacter.h"
+#include "CameraProject.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/Engine.h"
+#include "UnrealClient.h"
+#include "Framework/Application/SlateApplication.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "CameraCharacter/CameraSpringArm.h"
 #include "TimerManager.h"
+#include "CameraStats.h"
+#include "CameraCharacter/CameraLatency.h"
+#include "CameraCharacter/CameraStreamingPrefetch.h"
+#include "CameraCharacter/CameraViewValidation.h"
+#include "CameraCharacter/CameraArmSubsystem.h"
+#include "Camera/CameraTypes.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarCameraStreamingPrefetchMs(
+	TEXT("Camera.StreamingPrefetchMs"),
+	250.f,
+	TEXT("How far ahead, in milliseconds, locally controlled characters predict their camera and ask streaming to prepare for it. 0 disables."),
+	ECVF_Default);
 
 //////////////////////////////////////////////////////////////////////////
 // ACameraProjectCharacter
 
-ACameraProjectCharacter::ACameraProjectCharacter()
+ACameraProjectCharacter::ACameraProjectCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -35,20 +55,42 @@ ACameraProjectCharacter::ACameraProjectCharacter()
 	GetCharacterMovement()->JumpZVelocity = 600.f;
 	GetCharacterMovement()->AirControl = 0.2f;
 	
+	// Dedicated servers leave the camera out entirely, so every use of the boom below has to allow for it missing.
+	// Both are optional subobjects, so Blueprints and levels saved with them still load on a server without them.
+	if (!ShouldCreateCameraComponents())
+	{
+		ObjectInitializer.DoNotCreateDefaultSubobject(TEXT("CameraBoom")).DoNotCreateDefaultSubobject(TEXT("FollowCamera"));
+	}
+
+	const float BoomArmLength = 200.0f;
+
+	// Without the boom, so dedicated servers get the same value; PreSave takes it from the boom once that is edited
+	CameraViewReach = FMath::Max(BoomArmLength, GetDefault<UCameraSpringArm>()->FramingMaxArmLength) + CameraSocketOffset.Size();
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
-	OurCameraSpringArm = CreateDefaultSubobject<UCameraSpringArm>(TEXT("CameraBoom"));
-	OurCameraSpringArm->SetupAttachment(RootComponent);
-	OurCameraSpringArm->TargetArmLength = 200.0f; // The camera follows at this distance behind the character	
-	OurCameraSpringArm->SetRelativeLocation(CameraArmLocation);
-	OurCameraSpringArm->ActualSocketOffset = CameraSocketOffset;
-	OurCameraSpringArm->ExtraArmRotation = CameraExtraRotation;
-	OurCameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
-	
+	OurCameraSpringArm = CreateOptionalDefaultSubobject<UCameraSpringArm>(TEXT("CameraBoom"));
+	if (OurCameraSpringArm)
+	{
+		OurCameraSpringArm->SetupAttachment(RootComponent);
+		OurCameraSpringArm->TargetArmLength = BoomArmLength; // The camera follows at this distance behind the character	
+		OurCameraSpringArm->SetRelativeLocation(CameraArmLocation);
+		OurCameraSpringArm->ActualSocketOffset = CameraSocketOffset;
+		OurCameraSpringArm->ExtraArmRotation = CameraExtraRotation;
+		OurCameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+		OurCameraSpringArm->bDirectViewOutput = true; // The view comes from CalcCamera, so the follow camera only moves when GetUpdatedFollowCamera is called
+	}
 
 	// Create a follow camera
-	OurCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-	OurCamera->SetupAttachment(OurCameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-	OurCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	OurCamera = CreateOptionalDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
+	if (OurCamera)
+	{
+		OurCamera->SetupAttachment(OurCameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+		OurCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+		if (OurCameraSpringArm)
+		{
+			OurCameraSpringArm->SetDirectViewComponent(OurCamera);
+		}
+	}
 	
 	bUseControllerRotationYaw = true;
 
@@ -92,21 +134,214 @@ void ACameraProjectCharacter::SetupPlayerInputComponent(class UInputComponent* P
 	PlayerInputComponent->BindAction("ResetVR", IE_Pressed, this, &ACameraProjectCharacter::OnResetVR);
 }
 
+void ACameraProjectCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+	UpdateHistoryRecording();
+}
+
+void ACameraProjectCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+	UpdateHistoryRecording();
+}
+
+void ACameraProjectCharacter::OnRep_Controller()
+{
+	Super::OnRep_Controller();
+	UpdateHistoryRecording();
+}
+
+void ACameraProjectCharacter::UpdateHistoryRecording()
+{
+	// Keep the last 30 seconds of camera for instant replays, but only for the player at this machine; every other pawn would pay for a buffer nobody replays
+	if (OurCameraSpringArm)
+	{
+		OurCameraSpringArm->SetRecordHistory(IsLocallyControlled() && IsPlayerControlled());
+	}
+}
+
+void ACameraProjectCharacter::PreSave(const ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+
+	if (OurCameraSpringArm)
+	{
+		CameraViewReach = OurCameraSpringArm->GetMaxReach();
+	}
+}
+
+void ACameraProjectCharacter::PostLoad()
+{
+	Super::PostLoad();
+
+#if WITH_EDITORONLY_DATA
+	FCameraAutoCorrectSettings Migrated;
+	Migrated.AutoAdjustTime = AutoAdjustTime_DEPRECATED;
+	Migrated.AutoTurnRate = AutoTurnRate_DEPRECATED;
+	Migrated.AutoMoveRate = AutoMoveRate_DEPRECATED;
+	Migrated.bAutoCorrectCameraRotationYaw = bAutoCorrectCameraRotationYaw_DEPRECATED;
+	Migrated.bAutoCorrectCameraRotationPitch = bAutoCorrectCameraRotationPitch_DEPRECATED;
+	Migrated.bAutoCorrectCameraRotationRoll = bAutoCorrectCameraRotationRoll_DEPRECATED;
+	Migrated.AutoCorrectCameraLocation = AutoCorrectCameraLocation_DEPRECATED;
+	Migrated.AutoCorrectSocketOffset = AutoCorrectSocketOffset_DEPRECATED;
+
+	const FCameraAutoCorrectSettings& Defaults = UCameraRigPreset::GetDefaultAutoCorrect();
+	const bool bTuned =
+		Migrated.AutoAdjustTime != Defaults.AutoAdjustTime ||
+		Migrated.AutoTurnRate != Defaults.AutoTurnRate ||
+		Migrated.AutoMoveRate != Defaults.AutoMoveRate ||
+		Migrated.bAutoCorrectCameraRotationYaw != Defaults.bAutoCorrectCameraRotationYaw ||
+		Migrated.bAutoCorrectCameraRotationPitch != Defaults.bAutoCorrectCameraRotationPitch ||
+		Migrated.bAutoCorrectCameraRotationRoll != Defaults.bAutoCorrectCameraRotationRoll ||
+		Migrated.AutoCorrectCameraLocation != Defaults.AutoCorrectCameraLocation ||
+		Migrated.AutoCorrectSocketOffset != Defaults.AutoCorrectSocketOffset;
+
+	if (!bTuned || !OurCameraSpringArm)
+	{
+		return;
+	}
+
+	// A boom that already has a preset was set up after the move; its shared asset isn't ours to change
+	if (OurCameraSpringArm->RigPreset)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s: auto correct tuning saved on the character is ignored, the camera boom already uses preset %s"), *GetPathName(), *OurCameraSpringArm->RigPreset->GetName());
+		return;
+	}
+
+	// Give the boom a preset of its own, saved with this character, holding the old tuning on top of the default rig
+	UCameraRigPreset* MigratedPreset = NewObject<UCameraRigPreset>(this);
+	MigratedPreset->Settings = UCameraRigPreset::GetDefaultSettings();
+	MigratedPreset->AutoCorrect = Migrated;
+	OurCameraSpringArm->SetRigPreset(MigratedPreset);
+#endif
+}
+
 // Called when the game starts or when spawned
 void ACameraProjectCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (!OurCameraSpringArm) {
+	if (!OurCameraSpringArm && ShouldCreateCameraComponents()) {
 		UE_LOG(LogTemp, Error, TEXT("Spring Arm Failure"));
 		OurCameraSpringArm = FindComponentByClass<UCameraSpringArm>();
 	}
 	DesiredArmLocation = CameraArmLocation;
 	DesiredSocketOffset = CameraSocketOffset;
 
+	// Transitions run as the first stage of every camera update, so they always land in the frame they were computed for
+	if (OurCameraSpringArm) {
+		OurCameraSpringArm->OnPrepareFrame.AddUObject(this, &ACameraProjectCharacter::UpdateCameraTransition);
+	}
+
 	//GetWorldTimerManager().SetTimer(RandomChanges, this, &ACameraProjectCharacter::RandomlyChangeCamera, 3.f, true);
 }
 
+void ACameraProjectCharacter::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// The streaming prefetch and the view report are camera work too, so they count against the camera budget
+	FCameraBudgetScope BudgetScope(this);
+
+	// Only views someone is looking at need streaming warmed up
+	const float PrefetchSeconds = CVarCameraStreamingPrefetchMs.GetValueOnGameThread() * 0.001f;
+	if (PrefetchSeconds > 0.f && IsLocallyControlled() && IsPlayerControlled())
+	{
+		FMinimalViewInfo PredictedView;
+		if (GetPredictedView(PrefetchSeconds, PredictedView))
+		{
+			FCameraStreamingPrefetch::RequestView(Cast<APlayerController>(GetController()), PredictedView);
+		}
+	}
+
+	ReportCameraView();
+}
+
+void ACameraProjectCharacter::ReportCameraView()
+{
+	// Only remote clients report; a listen server's own camera has nobody to prove itself to
+	if (CameraViewReportInterval <= 0.f || !OurCameraSpringArm || HasAuthority() || !IsLocallyControlled()) { return; }
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastCameraViewReportTime < CameraViewReportInterval) { return; }
+
+	FTransform SocketTransform;
+	if (OurCameraSpringArm->GetCommittedView(SocketTransform))
+	{
+		LastCameraViewReportTime = Now;
+		ServerReportCameraView(SocketTransform.GetLocation());
+	}
+}
+
+bool ACameraProjectCharacter::ServerReportCameraView_Validate(FVector_NetQuantize CameraLocation)
+{
+	return !CameraLocation.ContainsNaN();
+}
+
+void ACameraProjectCharacter::ServerReportCameraView_Implementation(FVector_NetQuantize CameraLocation)
+{
+	FCameraBudgetScope BudgetScope(this);
+
+	if (UCameraViewValidationSubsystem* Validation = GetWorld()->GetSubsystem<UCameraViewValidationSubsystem>())
+	{
+		Validation->SubmitClaim(this, GetCameraViewRig(), CameraLocation);
+	}
+}
+
+bool ACameraProjectCharacter::GetPredictedView(float SecondsAhead, FMinimalViewInfo& OutView) const
+{
+	if (!OurCameraSpringArm || !OurCamera) { return false; }
+
+	FVector SocketLocation;
+	FRotator SocketRotation;
+	if (!OurCameraSpringArm->PredictView(SecondsAhead, SocketLocation, SocketRotation)) { return false; }
+
+	// Keep the camera's own settings and its offset from the end of the boom
+	OurCamera->GetCameraView(0.f, OutView);
+	OutView.Location = SocketLocation + SocketRotation.RotateVector(OurCamera->GetRelativeLocation());
+	OutView.Rotation = (SocketRotation.Quaternion() * OurCamera->GetRelativeRotation().Quaternion()).Rotator();
+	return true;
+}
+
+void ACameraProjectCharacter::CalcCamera(float DeltaTime, FMinimalViewInfo& OutResult)
+{
+	FCameraBudgetScope BudgetScope(this);
+
+	FTransform SocketTransform;
+	if (!OurCameraSpringArm || !OurCamera || !OurCamera->IsActive() || !OurCameraSpringArm->GetCommittedView(SocketTransform))
+	{
+		Super::CalcCamera(DeltaTime, OutResult);
+		return;
+	}
+
+	// Keep the camera's own settings, but place it from the boom's pose rather than its possibly stale transform
+	OurCamera->GetCameraView(DeltaTime, OutResult);
+	const FTransform CameraTransform = FTransform(OurCamera->GetRelativeRotation(), OurCamera->GetRelativeLocation()) * SocketTransform;
+	OutResult.Location = CameraTransform.GetLocation();
+	OutResult.Rotation = CameraTransform.Rotator();
+}
+
+UCameraComponent* ACameraProjectCharacter::GetUpdatedFollowCamera()
+{
+	if (OurCameraSpringArm)
+	{
+		OurCameraSpringArm->FlushChildTransforms();
+	}
+	return OurCamera;
+}
+
+void ACameraProjectCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (MouseSampler.IsValid() && FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Get().UnregisterInputPreProcessor(MouseSampler);
+	}
+	MouseSampler.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ACameraProjectCharacter::OnResetVR()
 {
 	UHeadMountedDisplayFunctionLibrary::ResetOrientationAndPosition();
@@ -149,7 +384,7 @@ void ACameraProjectCharacter::MoveForward(float Value)
 			AddMovementInput(Direction, Value);
 		}
 	}
-	else
+	else if (OurCameraSpringArm)
 	{
 		OurCameraSpringArm->ActualSocketOffset += FVector(0, 0, Value);
 	}
@@ -171,7 +406,7 @@ void ACameraProjectCharacter::MoveRight(float Value)
 			AddMovementInput(Direction, Value);
 		}
 	}
-	else
+	else if (OurCameraSpringArm)
 	{
 		OurCameraSpringArm->ActualSocketOffset += FVector(0, Value, 0);
 	}
@@ -180,16 +415,94 @@ void ACameraProjectCharacter::MoveRight(float Value)
 
 void ACameraProjectCharacter::TurnRight(float Rate)
 {
+	if (ConsumeMouseSamples()) { return; }
+
 	//If the camera is relocating we may want to disable all player inputs to keep it from being interrupted
 
 	if (!bAllowPlayerInputs) { return; }
 	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+	StampLookInput(Rate);
 }
 
 void ACameraProjectCharacter::LookUp(float Rate)
 {
+	if (ConsumeMouseSamples()) { return; }
 	if (!bAllowPlayerInputs) { return; }
 	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
+	StampLookInput(Rate);
+}
+
+void ACameraProjectCharacter::StampLookInput(float Rate)
+{
+	if (Rate == 0.f || !OurCameraSpringArm || !FCameraLatencyTracker::IsEnabled()) { return; }
+
+	// Axis values carry no arrival time, so the input counts as arriving as it is applied
+	const double Now = FPlatformTime::Seconds();
+	OurCameraSpringArm->SetLatencyStamp(Now, Now);
+}
+
+bool ACameraProjectCharacter::ConsumeMouseSamples()
+{
+	if (!bUseRawMouseSamples || !OurCameraSpringArm) { return false; }
+
+	APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	if (!PlayerController || !PlayerController->IsLocalController()) { return false; }
+
+	if (!MouseSampler.IsValid())
+	{
+		if (!FSlateApplication::IsInitialized()) { return false; }
+
+		MouseSampler = MakeShared<FCameraMouseSampler>();
+		MouseSamples.Reserve(FCameraMouseSampler::MaxSamples);
+		FSlateApplication::Get().RegisterInputPreProcessor(MouseSampler);
+	}
+
+	// Turn and LookUp both land here; only the first call each frame does anything
+	if (LastMouseSampleFrame == GFrameCounter) { return bMouseSamplesApplied; }
+	LastMouseSampleFrame = GFrameCounter;
+	bMouseSamplesApplied = false;
+
+	MouseSampler->ConsumeSamples(MouseSamples);
+
+	// Slate sees the mouse even while it drives a menu, so only turn while the game has captured it.
+	// Samples are still drained otherwise, so they don't pile up and get applied all at once later.
+	const UGameViewportClient* GameViewport = GEngine ? GEngine->GameViewport : nullptr;
+	const bool bMouseCaptured = bAllowPlayerInputs && !PlayerController->ShouldShowMouseCursor() && GameViewport && GameViewport->Viewport && GameViewport->Viewport->HasMouseCapture();
+
+	FCameraInputCurve InputCurve;
+	if (bMouseCaptured && MouseSamples.Num() > 0)
+	{
+		// Slate handles the OS's mouse messages in one batch per frame and they carry no time of their own, so their
+		// handling times all sit at the end of the frame. Spread them evenly over it instead, in the order they came.
+		// The curve only holds so many knots, so busy frames get one every few samples rather than piling up at the end.
+		const int32 NumSamples = MouseSamples.Num();
+		const int32 KnotStride = FMath::DivideAndRoundUp(NumSamples, FCameraInputCurve::MaxKnots);
+
+		FVector2D TotalDelta = FVector2D::ZeroVector;
+		for (int32 SampleIndex = 0; SampleIndex < NumSamples; ++SampleIndex)
+		{
+			TotalDelta += MouseSamples[SampleIndex].Delta;
+			if ((SampleIndex + 1) % KnotStride != 0 && SampleIndex != NumSamples - 1) { continue; }
+
+			// Screen space Y grows downwards, which is already the sign AddControllerPitchInput expects from a mouse
+			const FRotator Offset(TotalDelta.Y * MouseSampleScale * PlayerController->InputPitchScale, TotalDelta.X * MouseSampleScale * PlayerController->InputYawScale, 0.f);
+			InputCurve.AddKnot((float)(SampleIndex + 1) / NumSamples, Offset);
+		}
+
+		AddControllerYawInput(TotalDelta.X * MouseSampleScale);
+		AddControllerPitchInput(TotalDelta.Y * MouseSampleScale);
+
+		// Timed from when Slate handled the oldest sample; the OS may have had it up to a frame earlier
+		if (FCameraLatencyTracker::IsEnabled())
+		{
+			OurCameraSpringArm->SetLatencyStamp(MouseSamples[0].Time, FPlatformTime::Seconds());
+		}
+
+		bMouseSamplesApplied = true;
+	}
+
+	OurCameraSpringArm->SetInputCurve(InputCurve);
+	return bMouseSamplesApplied;
 }
 
 void ACameraProjectCharacter::ZoomIn(float Rate)
@@ -197,7 +510,7 @@ void ACameraProjectCharacter::ZoomIn(float Rate)
 	if (!bAllowPlayerInputs) { return; }
 
 	// Move camera spring arm socket forward
-	if (bControllingCamera) { OurCameraSpringArm->ActualSocketOffset += FVector(Rate * 10, 0, 0); }
+	if (bControllingCamera && OurCameraSpringArm) { OurCameraSpringArm->ActualSocketOffset += FVector(Rate * 10, 0, 0); }
 }
 
 void ACameraProjectCharacter::ZoomOut(float Rate)
@@ -205,7 +518,7 @@ void ACameraProjectCharacter::ZoomOut(float Rate)
 	if (!bAllowPlayerInputs) { return; }
 
 	// Move camera spring arm socket back
-	if (bControllingCamera) { OurCameraSpringArm->ActualSocketOffset += FVector(Rate * 10, 0, 0); }
+	if (bControllingCamera && OurCameraSpringArm) { OurCameraSpringArm->ActualSocketOffset += FVector(Rate * 10, 0, 0); }
 }
 
 void ACameraProjectCharacter::ToggleCameraControlOn()
@@ -216,12 +529,14 @@ void ACameraProjectCharacter::ToggleCameraControlOn()
 
 void ACameraProjectCharacter::ToggleCameraControlOff()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	// Restore player options and move the camera back to where we want it
 	//ToggleCharacterSettings(false, false, false);
 
 	CalculateLongestTime();
-	if (AutoAdjustTime > 0) { CalculateSpeedNeeded(-1); }
-	GetWorldTimerManager().SetTimer(AdjustCameraTimer, this, &ACameraProjectCharacter::CorrectCameraTransform, GetWorld()->GetDeltaSeconds(), true);
+	if (AutoCorrect.AutoAdjustTime > 0) { CalculateSpeedNeeded(-1); }
+	bCameraTransitionActive = true;
 }
 
 void ACameraProjectCharacter::ToggleCharacterSettings(bool bAllowInputs, bool bControlCamera, bool bUseControllerRotation)
@@ -233,6 +548,8 @@ void ACameraProjectCharacter::ToggleCharacterSettings(bool bAllowInputs, bool bC
 
 void ACameraProjectCharacter::ToggleCameraSide()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	// Change both the camera spring's arm's relative location, as well as where it's socket offset will be
 	// Need to add some slight rotational input to get the socket offset to move properly
 
@@ -250,19 +567,43 @@ void ACameraProjectCharacter::ToggleCameraSide()
 	}
 
 	CalculateLongestTime();
-	if (AutoAdjustTime > 0) { CalculateSpeedNeeded(-1); }
-	GetWorldTimerManager().SetTimer(AdjustCameraTimer, this, &ACameraProjectCharacter::CorrectCameraTransform, GetWorld()->GetDeltaSeconds(), true);
+	if (AutoCorrect.AutoAdjustTime > 0) { CalculateSpeedNeeded(-1); }
+	bCameraTransitionActive = true;
+}
+
+void ACameraProjectCharacter::UpdateCameraTransition(float DeltaTime)
+{
+	if (bCameraTransitionActive) { CorrectCameraTransform(); }
+}
+
+FCameraViewRig ACameraProjectCharacter::GetCameraViewRig() const
+{
+	FCameraViewRig ViewRig;
+	ViewRig.SetRigSettings(ViewValidationRig ? ViewValidationRig->Settings : UCameraRigPreset::GetDefaultSettings());
+
+	// Shoulder swaps mirror the boom sideways, so it is taken from the centre line and the sideways offset added to its reach
+	const FVector ArmLocation(CameraArmLocation.X, 0.f, CameraArmLocation.Z);
+	ViewRig.ArmOrigin = GetActorLocation() + GetActorQuat().RotateVector(ArmLocation);
+	ViewRig.MaxReach = CameraViewReach + MaxCameraDistance + FMath::Abs(CameraArmLocation.Y);
+	return ViewRig;
+}
+
+const FCameraAutoCorrectSettings& ACameraProjectCharacter::GetAutoCorrectSettings() const
+{
+	return OurCameraSpringArm ? OurCameraSpringArm->GetAutoCorrectSettings() : UCameraRigPreset::GetDefaultAutoCorrect();
 }
 
 void ACameraProjectCharacter::CorrectCameraTransform()
 {
+	CAMERA_STAGE_SCOPE(Transition);
+
 	if (!OurCameraSpringArm) { UE_LOG(LogTemp, Error, TEXT("Camera Spring Arm Vanished")); }
 	else {
 		ChangesNeeded = 0 + CorrectCameraRotation() + CorrectCameraLocation() + CorrectSocketLocation() + CorrectExtraRotation();
 
 		if (ChangesNeeded == 0) {
 			ToggleCharacterSettings(true, false, true);
-			GetWorldTimerManager().ClearTimer(AdjustCameraTimer);
+			bCameraTransitionActive = false;
 		}
 	}
 }
@@ -270,29 +611,31 @@ void ACameraProjectCharacter::CorrectCameraTransform()
 // Figure out what change to our camera's transform will take the longest
 void ACameraProjectCharacter::CalculateLongestTime()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	// If we don't want to correct every aspect of a rotation, remove those differences from our calculations
 
 	FRotator DifferenceInRotation = (Controller->GetDesiredRotation() - GetActorRotation()).GetNormalized();
-	if (!bAutoCorrectCameraRotationPitch) { DifferenceInRotation.Pitch = 0; }
-	if (!bAutoCorrectCameraRotationYaw) { DifferenceInRotation.Yaw = 0; }
-	if (!bAutoCorrectCameraRotationRoll) { DifferenceInRotation.Pitch = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationPitch) { DifferenceInRotation.Pitch = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationYaw) { DifferenceInRotation.Yaw = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationRoll) { DifferenceInRotation.Pitch = 0; }
 
 	// Divide the total distance by the speed at which each change will happen
 
 	float RotationalDifferenceTotal = FMath::Abs(DifferenceInRotation.Pitch) + FMath::Abs(DifferenceInRotation.Yaw) + FMath::Abs(DifferenceInRotation.Roll);
-	TimeToRotate = RotationalDifferenceTotal / (AutoTurnRate * BaseTurnRate * .75f);
+	TimeToRotate = RotationalDifferenceTotal / (AutoCorrect.AutoTurnRate * BaseTurnRate * .75f);
 
-	FVector LocationDifference = (DesiredArmLocation - OurCameraSpringArm->GetRelativeLocation()) * AutoCorrectCameraLocation;
+	FVector LocationDifference = (DesiredArmLocation - OurCameraSpringArm->GetRelativeLocation()) * AutoCorrect.AutoCorrectCameraLocation;
 	float LocationDistance = FVector::Dist(FVector::ZeroVector, LocationDifference);
-	TimeToMove = LocationDistance / (AutoMoveRate * .75f);
+	TimeToMove = LocationDistance / (AutoCorrect.AutoMoveRate * .75f);
 
-	FVector OffsetDifference = (DesiredSocketOffset - OurCameraSpringArm->ActualSocketOffset) * AutoCorrectSocketOffset;
+	FVector OffsetDifference = (DesiredSocketOffset - OurCameraSpringArm->ActualSocketOffset) * AutoCorrect.AutoCorrectSocketOffset;
 	float OffsetDistance = FVector::Dist(FVector::ZeroVector, OffsetDifference);
-	TimeToShift = OffsetDistance / (AutoMoveRate * .75f);
+	TimeToShift = OffsetDistance / (AutoCorrect.AutoMoveRate * .75f);
 
 	FRotator DifferenceInExtraRotation = (CameraExtraRotation - OurCameraSpringArm->ExtraArmRotation).GetNormalized();
 	float ExtraRotationDifferenceTotal = FMath::Abs(DifferenceInExtraRotation.Pitch) + FMath::Abs(DifferenceInExtraRotation.Yaw) + FMath::Abs(DifferenceInExtraRotation.Roll);
-	TimeToChange = ExtraRotationDifferenceTotal / (AutoTurnRate * BaseTurnRate * .75f);
+	TimeToChange = ExtraRotationDifferenceTotal / (AutoCorrect.AutoTurnRate * BaseTurnRate * .75f);
 
 	if (TimeToRotate > LongestTimeNeeded) { LongestTimeNeeded = TimeToRotate; }
 	if (TimeToMove > LongestTimeNeeded) { LongestTimeNeeded = TimeToMove; }
@@ -303,24 +646,28 @@ void ACameraProjectCharacter::CalculateLongestTime()
 // If we want to adjust our camera's transform in a set amount of time, adjust our movement speed to finish in the allotted time
 void ACameraProjectCharacter::CalculateSpeedNeeded(float DesiredTime)
 {
-	float RequiredTime = (DesiredTime > 0) ? DesiredTime : AutoAdjustTime;
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
+	float RequiredTime = (DesiredTime > 0) ? DesiredTime : AutoCorrect.AutoAdjustTime;
 	SpeedNeeded = LongestTimeNeeded / RequiredTime;
 }
 
 int ACameraProjectCharacter::CorrectCameraRotation()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	// If we don't want to change part of the rotation, remove it from the equation
 
 	FRotator DifferenceInRotation = (Controller->GetDesiredRotation() - GetActorRotation()).GetNormalized();
-	if (!bAutoCorrectCameraRotationPitch) { DifferenceInRotation.Pitch = 0; }
-	if (!bAutoCorrectCameraRotationYaw) { DifferenceInRotation.Yaw = 0; }
-	if (!bAutoCorrectCameraRotationRoll) { DifferenceInRotation.Pitch = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationPitch) { DifferenceInRotation.Pitch = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationYaw) { DifferenceInRotation.Yaw = 0; }
+	if (!AutoCorrect.bAutoCorrectCameraRotationRoll) { DifferenceInRotation.Pitch = 0; }
 
 	float RotationalDifferenceTotal = FMath::Abs(DifferenceInRotation.Pitch) + FMath::Abs(DifferenceInRotation.Yaw) + FMath::Abs(DifferenceInRotation.Roll);
 
 	// If we're close enough, set the rotation to exactly what we want
 
-	if (RotationalDifferenceTotal <= (AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToRotate * SpeedNeeded) / LongestTimeNeeded)
+	if (RotationalDifferenceTotal <= (AutoCorrect.AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToRotate * SpeedNeeded) / LongestTimeNeeded)
 	{
 		Controller->SetControlRotation(GetActorRotation().GetNormalized());
 	}
@@ -332,11 +679,9 @@ int ACameraProjectCharacter::CorrectCameraRotation()
 		// We need to change the control rotation, rather than adding the value inputs, in order to get it to sync with our other changes correctly
 		// By multiplying by TimeToRotate and dividing by LongestTimeNeeded we'll ensure movement and rotation finishes at the same time
 
-		float MovementAmount = (AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToRotate * SpeedNeeded * .75f) / LongestTimeNeeded;
+		float MovementAmount = (AutoCorrect.AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToRotate * SpeedNeeded * .75f) / LongestTimeNeeded;
 		FRotator AddedRotation = (FRotator(-PitchRatio, -YawRatio, RollRatio) * MovementAmount).GetNormalized();
 
-		UE_LOG(LogTemp, Warning, TEXT("%f   %f   %f"), TimeToRotate, SpeedNeeded, LongestTimeNeeded);
-
 		Controller->SetControlRotation(Controller->GetDesiredRotation() + AddedRotation);
 		return 1;
 	}
@@ -345,18 +690,20 @@ int ACameraProjectCharacter::CorrectCameraRotation()
 
 int ACameraProjectCharacter::CorrectCameraLocation()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	//Again, if we don't want to automatically fix a portion of our camera's offset, then remove it from the calculations
 
 	FVector CurrentPosition = OurCameraSpringArm->GetRelativeLocation();
 	FVector PositionDifference = DesiredArmLocation - CurrentPosition;
-	FVector DesiredPosition = CurrentPosition + (PositionDifference * AutoCorrectCameraLocation);
+	FVector DesiredPosition = CurrentPosition + (PositionDifference * AutoCorrect.AutoCorrectCameraLocation);
 
 	float Distance = FVector::Dist(DesiredPosition, CurrentPosition);
 
 	// If we're close enough, set the location to exactly what we want
 	// Need to make sure distance isn't really small since sometimes TimeToMove will get set to 0 for some odd reason
 
-	if ((Distance <= (AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToMove * SpeedNeeded) / LongestTimeNeeded) || (Distance < .1f))
+	if ((Distance <= (AutoCorrect.AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToMove * SpeedNeeded) / LongestTimeNeeded) || (Distance < .1f))
 	{
 		OurCameraSpringArm->SetRelativeLocation(DesiredArmLocation);
 	}
@@ -365,7 +712,7 @@ int ACameraProjectCharacter::CorrectCameraLocation()
 
 		// By multiplying by TimeToMove and dividing by LongestTimeNeeded we'll ensure movement and rotation finishes at the same time
 		
-		float MovementAmount = ((AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToMove * SpeedNeeded * .75f) / LongestTimeNeeded);
+		float MovementAmount = ((AutoCorrect.AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToMove * SpeedNeeded * .75f) / LongestTimeNeeded);
 		FVector NewPosition = CurrentPosition + (Direction * MovementAmount);
 
 		OurCameraSpringArm->SetRelativeLocation(NewPosition);
@@ -376,23 +723,23 @@ int ACameraProjectCharacter::CorrectCameraLocation()
 
 int ACameraProjectCharacter::CorrectSocketLocation()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	FVector CurrentPosition = OurCameraSpringArm->ActualSocketOffset;
 	FVector PositionDifference = DesiredSocketOffset - CurrentPosition;
-	FVector DesiredPosition = CurrentPosition + (PositionDifference * AutoCorrectSocketOffset);
+	FVector DesiredPosition = CurrentPosition + (PositionDifference * AutoCorrect.AutoCorrectSocketOffset);
 
 	float Distance = FVector::Dist(DesiredPosition, CurrentPosition);
-	if ((Distance <= (AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToShift * SpeedNeeded) / LongestTimeNeeded) || (Distance < .1f))
+	if ((Distance <= (AutoCorrect.AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToShift * SpeedNeeded) / LongestTimeNeeded) || (Distance < .1f))
 	{
 		OurCameraSpringArm->ActualSocketOffset = DesiredSocketOffset;
 	}
 	else {
 		FVector Direction = (DesiredPosition - CurrentPosition).GetSafeNormal();
-		float MovementAmount = (AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToShift * SpeedNeeded * .75f) / LongestTimeNeeded;
+		float MovementAmount = (AutoCorrect.AutoMoveRate * GetWorld()->GetDeltaSeconds() * TimeToShift * SpeedNeeded * .75f) / LongestTimeNeeded;
 
 		FVector NewPosition = CurrentPosition + (Direction * MovementAmount);
 
-		UE_LOG(LogTemp, Warning, TEXT("%f   %f   %f"), TimeToShift, SpeedNeeded, LongestTimeNeeded);
-
 		OurCameraSpringArm->ActualSocketOffset = NewPosition;
 		return 1;
 	}
@@ -401,10 +748,12 @@ int ACameraProjectCharacter::CorrectSocketLocation()
 
 int ACameraProjectCharacter::CorrectExtraRotation()
 {
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	FRotator DifferenceInRotation = (CameraExtraRotation - OurCameraSpringArm->ExtraArmRotation).GetNormalized();
 	float ExtraRotationDifferenceTotal = FMath::Abs(DifferenceInRotation.Pitch) + FMath::Abs(DifferenceInRotation.Yaw) + FMath::Abs(DifferenceInRotation.Roll);
 
-	if (ExtraRotationDifferenceTotal <= (AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToChange * SpeedNeeded) / LongestTimeNeeded)
+	if (ExtraRotationDifferenceTotal <= (AutoCorrect.AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToChange * SpeedNeeded) / LongestTimeNeeded)
 	{
 		OurCameraSpringArm->ExtraArmRotation = CameraExtraRotation;
 	}
@@ -412,7 +761,7 @@ int ACameraProjectCharacter::CorrectExtraRotation()
 		float PitchRatio = (DifferenceInRotation.Pitch / ExtraRotationDifferenceTotal);
 		float YawRatio   = (DifferenceInRotation.Yaw   / ExtraRotationDifferenceTotal);
 		float RollRation = (DifferenceInRotation.Roll  / ExtraRotationDifferenceTotal);
-		float MovementAmount = (AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToChange * SpeedNeeded * .75f) / LongestTimeNeeded;
+		float MovementAmount = (AutoCorrect.AutoTurnRate * BaseTurnRate * GetWorld()->GetDeltaSeconds() * TimeToChange * SpeedNeeded * .75f) / LongestTimeNeeded;
 
 		FRotator Rotation = (FRotator(PitchRatio, YawRatio, RollRation) * MovementAmount).GetNormalized();
 		OurCameraSpringArm->ExtraArmRotation += Rotation;
@@ -423,41 +772,72 @@ int ACameraProjectCharacter::CorrectExtraRotation()
 
 void ACameraProjectCharacter::ChangeCameraSocketLocation(FVector NewLocation, bool bIsRelative, float DesiredMovementTime, bool bTakeControl)
 {
+	if (!OurCameraSpringArm) { return; }
+
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	// If there is any reason oo change the camera's position (relative or otherwise) this makes it easy
 	// The camera will move smoothly to it's new location and rotation after this is called
 
 	DesiredSocketOffset = (bIsRelative) ? NewLocation : NewLocation - OurCameraSpringArm->GetComponentLocation();
 
 	CalculateLongestTime();
-	if (AutoAdjustTime > 0 || DesiredMovementTime > 0) { CalculateSpeedNeeded(DesiredMovementTime); }
+	if (AutoCorrect.AutoAdjustTime > 0 || DesiredMovementTime > 0) { CalculateSpeedNeeded(DesiredMovementTime); }
 	ToggleCharacterSettings(false, true, false);
 
 	CalculateLongestTime();
-	GetWorldTimerManager().SetTimer(AdjustCameraTimer, this, &ACameraProjectCharacter::CorrectCameraTransform, GetWorld()->GetDeltaSeconds(), true);
+	bCameraTransitionActive = true;
 }
 
 void ACameraProjectCharacter::ChangeCameraArmRotation(FRotator NewRotation, bool bIsRelative, float DesiredRotationTime, bool bTakeControl)
 {
+	if (!OurCameraSpringArm) { return; }
+
+	const FCameraAutoCorrectSettings& AutoCorrect = GetAutoCorrectSettings();
+
 	CameraExtraRotation = (bIsRelative) ? NewRotation : NewRotation - Controller->GetDesiredRotation();
 
 	CalculateLongestTime();
-	if (AutoAdjustTime > 0 || DesiredRotationTime > 0) { CalculateSpeedNeeded(DesiredRotationTime); }
+	if (AutoCorrect.AutoAdjustTime > 0 || DesiredRotationTime > 0) { CalculateSpeedNeeded(DesiredRotationTime); }
 	ToggleCharacterSettings(false, true, false);
 
 	CalculateLongestTime();
-	GetWorldTimerManager().SetTimer(AdjustCameraTimer, this, &ACameraProjectCharacter::CorrectCameraTransform, GetWorld()->GetDeltaSeconds(), true);
+	bCameraTransitionActive = true;
+}
+
+void ACameraProjectCharacter::StartRandomCameraChanges(int32 Seed, float Interval)
+{
+	if (!OurCameraSpringArm) { return; }
+
+	RandomCameraStream.Initialize(Seed);
+	GetWorldTimerManager().SetTimer(RandomChanges, this, &ACameraProjectCharacter::RandomlyChangeCamera, Interval, true);
+}
+
+void ACameraProjectCharacter::StopRandomCameraChanges()
+{
+	GetWorldTimerManager().ClearTimer(RandomChanges);
 }
 
 void ACameraProjectCharacter::RandomlyChangeCamera()
 {
-	float RanX = FMath::RandRange(-120, 120);
-	float RanY = FMath::RandRange(-120, 120);
-	float RanZ = FMath::RandRange(-120, 120);
+	// Transitions measure rotation against the controller, so there is nothing to do until we're possessed
+	if (!Controller) { return; }
 
-	float RanPitch = FMath::RandRange(-120, 120);
-	float RanYaw = FMath::RandRange(-120, 120);
-	float RanRoll = FMath::RandRange(-120, 120);
+	// Swap shoulders every so often, otherwise move the socket and arm rotation somewhere new
+	if (RandomCameraStream.FRand() < .25f)
+	{
+		ToggleCameraSide();
+		return;
+	}
+
+	float RanX = RandomCameraStream.RandRange(-120, 120);
+	float RanY = RandomCameraStream.RandRange(-120, 120);
+	float RanZ = RandomCameraStream.RandRange(-120, 120);
+
+	float RanPitch = RandomCameraStream.RandRange(-120, 120);
+	float RanYaw = RandomCameraStream.RandRange(-120, 120);
+	float RanRoll = RandomCameraStream.RandRange(-120, 120);
 
 	ChangeCameraArmRotation(FRotator(RanPitch, RanYaw, RanRoll).GetNormalized());
 	ChangeCameraSocketLocation(FVector(RanX, RanY, RanZ));
-}
\ No newline at end of file
+}
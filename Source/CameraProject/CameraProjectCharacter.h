@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "Engine/NetSerialization.h"
+#include "CameraCharacter/CameraMouseSampler.h"
 #include "CameraProjectCharacter.generated.h"
 
 UCLASS(config=Game)
@@ -23,8 +25,30 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Moves auto correct tuning saved on the character before rig presets existed onto the camera boom */
+	virtual void PostLoad() override;
+
+	/** Records the camera boom's reach in CameraViewReach */
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+
+	// APawn interface
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void OnRep_Controller() override;
+	// End of APawn interface
+
+	/** Records camera history only while a local player controls this character */
+	void UpdateHistoryRecording();
+
+	/** Builds the view from the camera boom's committed pose, so the follow camera doesn't have to be moved every frame */
+	virtual void CalcCamera(float DeltaTime, struct FMinimalViewInfo& OutResult) override;
+
 public:
-	ACameraProjectCharacter();
+	ACameraProjectCharacter(const FObjectInitializer& ObjectInitializer);
 
 	void ToggleCameraControlOn();
 
@@ -34,6 +58,24 @@ public:
 
 	void ToggleCameraSide();
 
+	/** Starts seeded random camera transitions and shoulder swaps every Interval seconds, used to put load on the camera system */
+	void StartRandomCameraChanges(int32 Seed, float Interval);
+
+	void StopRandomCameraChanges();
+
+	/**
+	 * Where the follow camera is expected to be SecondsAhead from now, extrapolated by the camera boom.
+	 * Returns false if the boom hasn't been updated yet.
+	 */
+	bool GetPredictedView(float SecondsAhead, struct FMinimalViewInfo& OutView) const;
+
+	/**
+	 * The camera rig servers validate this character's reported views against. Built from the character's own settings,
+	 * so it is the same on dedicated servers, which have no camera boom, and on listen servers, whose copy of a remote
+	 * player's boom never sees that player's zoom or shoulder swaps.
+	 */
+	struct FCameraViewRig GetCameraViewRig() const;
+
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category= "Camera")
 	float BaseTurnRate;
@@ -42,15 +84,18 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
 	float BaseLookUpRate;
 
-	// If we want to move in a set amount of time, set this value to 0 or greater; otherwise, the transform will change at an adjustable speed
+	/**
+	 * Turn with the raw mouse movements received between frames instead of the per-frame Turn and LookUp axis values.
+	 * Mouse movement is applied as a distance rather than scaled by the frame time, and its order is passed on to the
+	 * camera boom so rotation lag follows it across long frames. Off by default, since it changes how mouse
+	 * sensitivity feels at anything but 60 fps; MouseSampleScale sets it.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
-		float AutoAdjustTime = -1;
+		bool bUseRawMouseSamples = false;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
-		float AutoTurnRate = 5;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
-		float AutoMoveRate = 700;
+	/** Controller input per raw mouse count; the default matches the axis path at 60 fps with the default mouse sensitivity */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (editcondition = "bUseRawMouseSamples"))
+		float MouseSampleScale = 0.05f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
 		FRotator CameraExtraRotation = FRotator(0, 0, 0);
@@ -61,24 +106,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
 		FVector CameraSocketOffset = FVector(0, 60, 20);
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	/**
+	 * How much further than CameraViewReach zooming and moving the socket while controlling the camera may take it.
+	 * Not enforced on the client; servers validating reported camera views allow this much on top of the boom's reach.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (ClampMin = "0.0"))
 		float MaxCameraDistance = 500;
 
-	/**    */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Auto Correct")
-		bool bAutoCorrectCameraRotationYaw = true;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Auto Correct")
-		bool bAutoCorrectCameraRotationPitch = true;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Auto Correct")
-		bool bAutoCorrectCameraRotationRoll = true;
+	/**
+	 * Furthest the camera boom puts the camera from its origin, over its own arm length, its rigs and group framing.
+	 * Recorded from the boom whenever the character is saved, so servers that never create the boom still know it.
+	 */
+	UPROPERTY(VisibleDefaultsOnly, AdvancedDisplay, Category = "Camera")
+		float CameraViewReach;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Auto Correct")
-		FVector AutoCorrectCameraLocation = FVector(1, 1, 1);
+	/** Lag and probe tuning servers validate reported camera views with; should match the camera boom's preset. Defaults if empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Camera")
+		class UCameraRigPreset* ViewValidationRig;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Auto Correct")
-		FVector AutoCorrectSocketOffset = FVector(1, 1, 1);
+	/**
+	 * How often a client reports the end of its camera boom to the server, in seconds, for modes that validate camera
+	 * locations with UCameraViewValidationSubsystem. 0 never reports.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (ClampMin = "0.0"))
+		float CameraViewReportInterval = 0.f;
 
 	bool bControllingCamera = false;
 	bool bAllowPlayerInputs = true;
@@ -110,6 +161,16 @@ protected:
 
 	void LookUpAtRate(float Rate);
 
+	/** Stamps look input applied through the axis path for Camera.LatencyTracking */
+	void StampLookInput(float Rate);
+
+	/**
+	 * Applies the raw mouse samples recorded since the last frame and hands their timing to the camera boom.
+	 * Runs once a frame however many axes call it. Returns true only if the game has the mouse captured and samples
+	 * turned the camera this frame; otherwise the axis values, which also carry gamepad input, should be used.
+	 */
+	bool ConsumeMouseSamples();
+
 	void ZoomIn(float Rate);
 
 	void ZoomOut(float Rate);
@@ -122,6 +183,12 @@ protected:
 
 	void CorrectCameraTransform();
 
+	/** Steps an active camera transition; bound to the camera boom so it runs at the start of each camera update */
+	void UpdateCameraTransition(float DeltaTime);
+
+	/** Auto correct tuning shared through the camera boom's rig preset */
+	const struct FCameraAutoCorrectSettings& GetAutoCorrectSettings() const;
+
 	void CalculateLongestTime();
 
 	void CalculateSpeedNeeded(float DesiredTime);
@@ -138,13 +205,37 @@ protected:
 
 	void ChangeCameraArmRotation(FRotator NewRotation, bool bIsRelative = true, float DesiredRotationTime = -1, bool bTakeControl = true);
 
+	/** Sends the end of the camera boom to the server every CameraViewReportInterval */
+	void ReportCameraView();
+
+	/** Hands a client's reported camera location to the server's view validation */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerReportCameraView(FVector_NetQuantize CameraLocation);
+
+	float LastCameraViewReportTime = 0.f;
+
 	FTimerHandle RandomChanges;
 	void RandomlyChangeCamera();
 
+	/** Stream behind RandomlyChangeCamera, so a given seed always produces the same sequence of changes */
+	FRandomStream RandomCameraStream;
+
 	FVector DesiredSocketOffset;
 	FVector DesiredArmLocation;
 
-	FTimerHandle AdjustCameraTimer;
+	/** Records raw mouse movement for a locally controlled character; created on first use */
+	TSharedPtr<FCameraMouseSampler> MouseSampler;
+
+	/** Reused every frame so consuming samples doesn't allocate */
+	TArray<FCameraMouseSample> MouseSamples;
+
+	uint64 LastMouseSampleFrame = 0;
+
+	/** Did LastMouseSampleFrame's ConsumeMouseSamples turn the camera from samples? */
+	bool bMouseSamplesApplied = false;
+
+	/** Set while CorrectCameraTransform still has changes to make to the camera */
+	bool bCameraTransitionActive = false;
 
 	bool bUsingRightSide = true;
 
@@ -166,7 +257,38 @@ protected:
 public:
 	/** Returns CameraBoom subobject **/
 	FORCEINLINE class UCameraSpringArm* GetCameraBoom() const { return OurCameraSpringArm; }
-	/** Returns FollowCamera subobject **/
+	/** Returns FollowCamera subobject; its transform may trail the view, which comes from the boom's committed pose **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return OurCamera; }
+	/** Returns FollowCamera subobject after moving it to the boom's committed pose, for code reading its transform **/
+	class UCameraComponent* GetUpdatedFollowCamera();
+
+private:
+#if WITH_EDITORONLY_DATA
+	// Auto correct tuning that now lives in the rig preset. Only loaded from old data and moved by PostLoad.
+	// Editor only, so cooked characters don't carry it: cooking saves the migrated preset instead.
+	UPROPERTY()
+		float AutoAdjustTime_DEPRECATED = -1;
+
+	UPROPERTY()
+		float AutoTurnRate_DEPRECATED = 5;
+
+	UPROPERTY()
+		float AutoMoveRate_DEPRECATED = 700;
+
+	UPROPERTY()
+		bool bAutoCorrectCameraRotationYaw_DEPRECATED = true;
+
+	UPROPERTY()
+		bool bAutoCorrectCameraRotationPitch_DEPRECATED = true;
+
+	UPROPERTY()
+		bool bAutoCorrectCameraRotationRoll_DEPRECATED = true;
+
+	UPROPERTY()
+		FVector AutoCorrectCameraLocation_DEPRECATED = FVector(1, 1, 1);
+
+	UPROPERTY()
+		FVector AutoCorrectSocketOffset_DEPRECATED = FVector(1, 1, 1);
+#endif
 };
 
@@ -2,6 +2,7 @@
 
 #include "CameraProjectGameMode.h"
 #include "CameraProjectCharacter.h"
+#include "CameraProjectPlayerController.h"
 #include "UObject/ConstructorHelpers.h"
 
 ACameraProjectGameMode::ACameraProjectGameMode()
@@ -12,4 +13,7 @@ ACameraProjectGameMode::ACameraProjectGameMode()
 	{
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
+
+	// Lets the camera's predicted view lead world streaming
+	PlayerControllerClass = ACameraProjectPlayerController::StaticClass();
 }
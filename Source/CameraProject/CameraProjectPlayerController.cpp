@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraProjectPlayerController.h"
+
+void ACameraProjectPlayerController::SetStreamingPrefetchLocation(const FVector& Location)
+{
+	StreamingPrefetchLocation = Location;
+	StreamingPrefetchFrame = GFrameCounter;
+}
+
+void ACameraProjectPlayerController::GetStreamingSourceLocationAndRotation(FVector& OutLocation, FRotator& OutRotation) const
+{
+	Super::GetStreamingSourceLocationAndRotation(OutLocation, OutRotation);
+
+	// Streaming may run before or after the character ticks, so last frame's prediction still counts
+	if (StreamingPrefetchFrame > 0 && GFrameCounter - StreamingPrefetchFrame <= 1)
+	{
+		OutLocation = StreamingPrefetchLocation;
+	}
+}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "CameraProjectPlayerController.generated.h"
+
+/**
+ * Player controller that lets the camera lead world streaming: while the possessed character predicts where its
+ * camera is heading, streaming is centred on that point instead of on the current view.
+ */
+UCLASS()
+class CAMERAPROJECT_API ACameraProjectPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	/** Streams around Location instead of the view point until a frame goes by without it being set again */
+	void SetStreamingPrefetchLocation(const FVector& Location);
+
+	// APlayerController interface
+	virtual void GetStreamingSourceLocationAndRotation(FVector& OutLocation, FRotator& OutRotation) const override;
+	// End of APlayerController interface
+
+private:
+	FVector StreamingPrefetchLocation = FVector::ZeroVector;
+
+	/** GFrameCounter when StreamingPrefetchLocation was last set */
+	uint64 StreamingPrefetchFrame = 0;
+};
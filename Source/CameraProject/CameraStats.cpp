@@ -0,0 +1,260 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraStats.h"
+#include "HAL/PlatformAtomics.h"
+#include "HAL/MemoryBase.h"
+
+DEFINE_STAT(STAT_CameraGather);
+DEFINE_STAT(STAT_CameraLag);
+DEFINE_STAT(STAT_CameraCollision);
+DEFINE_STAT(STAT_CameraResolve);
+DEFINE_STAT(STAT_CameraCommit);
+DEFINE_STAT(STAT_CameraTransition);
+DEFINE_STAT(STAT_CameraFraming);
+DEFINE_STAT(STAT_CameraProbeLine);
+DEFINE_STAT(STAT_CameraProbePartial);
+DEFINE_STAT(STAT_CameraProbeSphere);
+DEFINE_STAT(STAT_CameraProbeRefresh);
+DEFINE_STAT(STAT_CameraProbeReused);
+DEFINE_STAT(STAT_CameraProbeFallback);
+DEFINE_STAT(STAT_CameraStaleReads);
+DEFINE_STAT(STAT_CameraBudgetLevel);
+DEFINE_STAT(STAT_CameraFrameCost);
+
+volatile int64 FCameraStageTimings::StageCycles[(int32)ECameraStage::Num] = {};
+volatile int32 FCameraProbeCounters::TierCounts[(int32)ECameraProbeTier::Num] = {};
+volatile int32 FCameraProbeCounters::FallbackCount = 0;
+
+void FCameraStageTimings::Add(ECameraStage Stage, uint64 Cycles)
+{
+	FPlatformAtomics::InterlockedAdd(&StageCycles[(int32)Stage], (int64)Cycles);
+}
+
+uint64 FCameraStageTimings::Get(ECameraStage Stage)
+{
+	return (uint64)FPlatformAtomics::AtomicRead(&StageCycles[(int32)Stage]);
+}
+
+void FCameraStageTimings::Reset()
+{
+	for (int32 StageIndex = 0; StageIndex < (int32)ECameraStage::Num; ++StageIndex)
+	{
+		FPlatformAtomics::InterlockedExchange(&StageCycles[StageIndex], 0);
+	}
+}
+
+const TCHAR* FCameraStageTimings::GetStageName(ECameraStage Stage)
+{
+	switch (Stage)
+	{
+	case ECameraStage::Gather:		return TEXT("Gather");
+	case ECameraStage::Lag:			return TEXT("Lag");
+	case ECameraStage::Collision:	return TEXT("Collision");
+	case ECameraStage::Resolve:		return TEXT("Resolve");
+	case ECameraStage::Commit:		return TEXT("Commit");
+	case ECameraStage::Transition:	return TEXT("Transition");
+	case ECameraStage::Framing:		return TEXT("Framing");
+	default:						return TEXT("Unknown");
+	}
+}
+
+void FCameraProbeCounters::Add(ECameraProbeTier Tier)
+{
+	FPlatformAtomics::InterlockedIncrement(&TierCounts[(int32)Tier]);
+
+	switch (Tier)
+	{
+	case ECameraProbeTier::Line:	INC_DWORD_STAT(STAT_CameraProbeLine); break;
+	case ECameraProbeTier::Partial:	INC_DWORD_STAT(STAT_CameraProbePartial); break;
+	case ECameraProbeTier::Sphere:	INC_DWORD_STAT(STAT_CameraProbeSphere); break;
+	case ECameraProbeTier::Refresh:	INC_DWORD_STAT(STAT_CameraProbeRefresh); break;
+	case ECameraProbeTier::Reused:	INC_DWORD_STAT(STAT_CameraProbeReused); break;
+	default: break;
+	}
+}
+
+void FCameraProbeCounters::AddFallback()
+{
+	FPlatformAtomics::InterlockedIncrement(&FallbackCount);
+	INC_DWORD_STAT(STAT_CameraProbeFallback);
+}
+
+uint32 FCameraProbeCounters::Get(ECameraProbeTier Tier)
+{
+	return (uint32)FPlatformAtomics::AtomicRead(&TierCounts[(int32)Tier]);
+}
+
+uint32 FCameraProbeCounters::GetFallbacks()
+{
+	return (uint32)FPlatformAtomics::AtomicRead(&FallbackCount);
+}
+
+void FCameraProbeCounters::Reset()
+{
+	for (int32 TierIndex = 0; TierIndex < (int32)ECameraProbeTier::Num; ++TierIndex)
+	{
+		FPlatformAtomics::InterlockedExchange(&TierCounts[TierIndex], 0);
+	}
+	FPlatformAtomics::InterlockedExchange(&FallbackCount, 0);
+}
+
+const TCHAR* FCameraProbeCounters::GetTierName(ECameraProbeTier Tier)
+{
+	switch (Tier)
+	{
+	case ECameraProbeTier::Line:	return TEXT("Line");
+	case ECameraProbeTier::Partial:	return TEXT("Partial");
+	case ECameraProbeTier::Sphere:	return TEXT("Sphere");
+	case ECameraProbeTier::Refresh:	return TEXT("Refresh");
+	case ECameraProbeTier::Reused:	return TEXT("Reused");
+	default:						return TEXT("Unknown");
+	}
+}
+
+#if CAMERA_STAGE_TIMINGS
+namespace CameraAllocations
+{
+	/** One count per stage, then one for allocations made in a frame outside every stage */
+	static volatile int32 StageCounts[(int32)ECameraStage::Num + 1] = {};
+
+	/** Stage the current thread is in; Num while outside every camera stage */
+	static thread_local ECameraStage CurrentStage = ECameraStage::Num;
+
+	/** How many camera frames the current thread is inside */
+	static thread_local int32 FrameDepth = 0;
+
+	/** Read by every allocation on every thread, so only ever changed atomically */
+	static volatile int32 bCounting = 0;
+
+	/** Passes everything through to the allocator it wraps, counting allocations made inside camera stages */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		FMalloc* Inner = nullptr;
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("CameraCountingMalloc"); }
+
+	private:
+		static void CountAllocation()
+		{
+			if (FPlatformAtomics::AtomicRead_Relaxed(&bCounting) == 0) { return; }
+
+			// Worker threads never begin a frame themselves; they take part through the stage scopes of the tasks they run
+			const ECameraStage Stage = CurrentStage;
+			if (Stage != ECameraStage::Num || FrameDepth > 0)
+			{
+				FPlatformAtomics::InterlockedIncrement(&StageCounts[(int32)Stage]);
+			}
+		}
+	};
+
+	/** Never destroyed or uninstalled, since other threads may be calling through it at any time */
+	static FCountingMalloc CountingMalloc;
+
+	static void InstallCountingMalloc()
+	{
+		static bool bInstalled = false;
+		if (bInstalled) { return; }
+		bInstalled = true;
+
+		// Other threads keep allocating while GMalloc changes, so the proxy has to be complete before any of them can see it.
+		// Threads that still hold the old GMalloc are fine: the proxy forwards to that same allocator.
+		CountingMalloc.Inner = GMalloc;
+		FPlatformMisc::MemoryBarrier();
+		FPlatformAtomics::InterlockedExchangePtr((void**)&GMalloc, &CountingMalloc);
+	}
+}
+
+void FCameraAllocationTracker::Start()
+{
+	check(IsInGameThread());
+
+	CameraAllocations::InstallCountingMalloc();
+	Reset();
+	FPlatformAtomics::InterlockedExchange(&CameraAllocations::bCounting, 1);
+}
+
+void FCameraAllocationTracker::Stop()
+{
+	check(IsInGameThread());
+	FPlatformAtomics::InterlockedExchange(&CameraAllocations::bCounting, 0);
+}
+
+uint32 FCameraAllocationTracker::GetCount(ECameraStage Stage)
+{
+	return (uint32)FPlatformAtomics::AtomicRead(&CameraAllocations::StageCounts[(int32)Stage]);
+}
+
+uint32 FCameraAllocationTracker::GetUnstagedCount()
+{
+	return (uint32)FPlatformAtomics::AtomicRead(&CameraAllocations::StageCounts[(int32)ECameraStage::Num]);
+}
+
+uint32 FCameraAllocationTracker::GetTotalCount()
+{
+	uint32 Total = 0;
+	for (int32 StageIndex = 0; StageIndex <= (int32)ECameraStage::Num; ++StageIndex)
+	{
+		Total += (uint32)FPlatformAtomics::AtomicRead(&CameraAllocations::StageCounts[StageIndex]);
+	}
+	return Total;
+}
+
+void FCameraAllocationTracker::Reset()
+{
+	for (int32 StageIndex = 0; StageIndex <= (int32)ECameraStage::Num; ++StageIndex)
+	{
+		FPlatformAtomics::InterlockedExchange(&CameraAllocations::StageCounts[StageIndex], 0);
+	}
+}
+
+void FCameraAllocationTracker::BeginFrame()
+{
+	++CameraAllocations::FrameDepth;
+}
+
+void FCameraAllocationTracker::EndFrame()
+{
+	CameraAllocations::FrameDepth = FMath::Max(CameraAllocations::FrameDepth - 1, 0);
+}
+
+ECameraStage FCameraAllocationTracker::EnterStage(ECameraStage Stage)
+{
+	const ECameraStage PreviousStage = CameraAllocations::CurrentStage;
+	CameraAllocations::CurrentStage = Stage;
+	return PreviousStage;
+}
+
+void FCameraAllocationTracker::LeaveStage(ECameraStage PreviousStage)
+{
+	CameraAllocations::CurrentStage = PreviousStage;
+}
+#endif
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("Camera"), STATGROUP_Camera, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather Inputs"), STAT_CameraGather, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve Lag"), STAT_CameraLag, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Query Collision"), STAT_CameraCollision, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve"), STAT_CameraResolve, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Commit"), STAT_CameraCommit, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Transitions"), STAT_CameraTransition, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Group Framing"), STAT_CameraFraming, STATGROUP_Camera, CAMERAPROJECT_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Line Probes"), STAT_CameraProbeLine, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Partial Sweeps"), STAT_CameraProbePartial, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sphere Sweeps"), STAT_CameraProbeSphere, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Refresh Sweeps"), STAT_CameraProbeRefresh, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Reused Sweeps"), STAT_CameraProbeReused, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Fallback Sweeps"), STAT_CameraProbeFallback, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Stale Transform Reads"), STAT_CameraStaleReads, STATGROUP_Camera, CAMERAPROJECT_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Budget Level"), STAT_CameraBudgetLevel, STATGROUP_Camera, CAMERAPROJECT_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Frame Cost (ms)"), STAT_CameraFrameCost, STATGROUP_Camera, CAMERAPROJECT_API);
+
+/** Stages of a camera update, in the order they run each frame */
+enum class ECameraStage : uint8
+{
+	Gather,
+	Lag,
+	Collision,
+	Resolve,
+	Commit,
+	Transition,
+	Framing,
+	Num
+};
+
+/**
+ * Running cycle totals for each camera stage, summed over every arm and thread.
+ * Stat captures aren't available to commandlets, so tools read these directly.
+ */
+struct CAMERAPROJECT_API FCameraStageTimings
+{
+	static void Add(ECameraStage Stage, uint64 Cycles);
+
+	static uint64 Get(ECameraStage Stage);
+
+	static void Reset();
+
+	static const TCHAR* GetStageName(ECameraStage Stage);
+
+private:
+	static volatile int64 StageCycles[(int32)ECameraStage::Num];
+};
+
+/** Queries the spring arm collision test can pick, cheapest first */
+enum class ECameraProbeTier : uint8
+{
+	/** Line trace along the arm while the last refresh found nothing near it */
+	Line,
+	/** Sphere sweep of only the part of the arm in front of last frame's hit */
+	Partial,
+	/** Sphere sweep of the whole arm */
+	Sphere,
+	/** Sphere sweep of the whole arm, inflated by the clearance threshold to measure the free space around it */
+	Refresh,
+	/** No query; the last one's result is reused because camera work is over budget */
+	Reused,
+	Num
+};
+
+/** Running count of each probe tier over every arm, readable in all builds so production captures can confirm the savings */
+struct CAMERAPROJECT_API FCameraProbeCounters
+{
+	/** Counts one arm's probe for the frame, both here and in the matching stat */
+	static void Add(ECameraProbeTier Tier);
+
+	/** Counts an exact sweep run because a Line or Refresh probe found geometry; not a probe of its own */
+	static void AddFallback();
+
+	static uint32 Get(ECameraProbeTier Tier);
+
+	static uint32 GetFallbacks();
+
+	static void Reset();
+
+	static const TCHAR* GetTierName(ECameraProbeTier Tier);
+
+private:
+	static volatile int32 TierCounts[(int32)ECameraProbeTier::Num];
+	static volatile int32 FallbackCount;
+};
+
+#define CAMERA_STAGE_TIMINGS !UE_BUILD_SHIPPING
+
+#if CAMERA_STAGE_TIMINGS
+/**
+ * Counts heap allocations made by the camera update. The first Start wraps GMalloc in a counting proxy that stays
+ * installed for the rest of the run; Start and Stop only switch counting on and off. While counting, every allocation
+ * a thread makes between the start and end of a camera frame is counted, then charged to the stage the thread was in,
+ * or to the frame itself if it was outside every stage. The steady-state camera update is expected not to allocate
+ * at all; the stress commandlet's -CheckAllocations and the Camera.Allocations automation test fail if it does.
+ */
+struct CAMERAPROJECT_API FCameraAllocationTracker
+{
+	/** Starts counting, installing the proxy the first time. Game thread only, and must be paired with Stop. */
+	static void Start();
+	static void Stop();
+
+	static uint32 GetCount(ECameraStage Stage);
+
+	/** Allocations made during a camera frame but outside every stage, e.g. in PrepareFrame or its delegates */
+	static uint32 GetUnstagedCount();
+
+	/** Every allocation counted, staged or not */
+	static uint32 GetTotalCount();
+
+	static void Reset();
+
+	/** Marks this thread as running a camera frame; frames may nest, and only the outermost one ends the count */
+	static void BeginFrame();
+	static void EndFrame();
+
+	/** Makes Stage the one this thread's allocations are charged to, returning the stage to restore on leaving */
+	static ECameraStage EnterStage(ECameraStage Stage);
+	static void LeaveStage(ECameraStage PreviousStage);
+};
+
+/** Counts allocations made anywhere in its scope as part of a camera frame */
+struct FCameraAllocationFrameScope
+{
+	FCameraAllocationFrameScope() { FCameraAllocationTracker::BeginFrame(); }
+	~FCameraAllocationFrameScope() { FCameraAllocationTracker::EndFrame(); }
+};
+
+#define CAMERA_FRAME_SCOPE() \
+	FCameraAllocationFrameScope CameraAllocationFrameScope
+
+/** Adds the time spent in its scope to one camera stage, and charges any allocations made in it to that stage */
+struct FCameraStageScope
+{
+	explicit FCameraStageScope(ECameraStage InStage)
+		: Stage(InStage)
+		, PreviousStage(FCameraAllocationTracker::EnterStage(InStage))
+		, StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FCameraStageScope()
+	{
+		FCameraStageTimings::Add(Stage, FPlatformTime::Cycles64() - StartCycles);
+		FCameraAllocationTracker::LeaveStage(PreviousStage);
+	}
+
+private:
+	ECameraStage Stage;
+	ECameraStage PreviousStage;
+	uint64 StartCycles;
+};
+
+#define CAMERA_STAGE_SCOPE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_Camera##Stage); \
+	FCameraStageScope CameraStageScope_##Stage(ECameraStage::Stage)
+#else
+#define CAMERA_STAGE_SCOPE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_Camera##Stage)
+#define CAMERA_FRAME_SCOPE()
+#endif
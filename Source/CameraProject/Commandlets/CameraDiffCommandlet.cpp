@@ -0,0 +1,502 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraDiffCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "CameraCharacter/CameraSpringArm.h"
+#include "CameraCharacter/CameraCollisionProxy.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraDiff, Log, All);
+
+namespace CameraDiff
+{
+	/** Console variables every run starts from, which together select the reference path */
+	static const TCHAR* ReferenceConsoleVariables[][2] =
+	{
+		{ TEXT("Camera.ParallelUpdate"), TEXT("0") },
+		{ TEXT("Camera.AdaptiveProbe"), TEXT("0") },
+		{ TEXT("Camera.BudgetMs"), TEXT("0") },
+		{ TEXT("Camera.CollisionProxies"), TEXT("0") },
+		{ TEXT("Camera.FastTrig"), TEXT("0") },
+		{ TEXT("Camera.SpecializedSolvers"), TEXT("0") },
+	};
+
+	/** Sets console variables for one run and puts back what they were when it goes out of scope */
+	class FScopedConsoleVariables
+	{
+	public:
+		~FScopedConsoleVariables()
+		{
+			for (int32 Index = Saved.Num() - 1; Index >= 0; --Index)
+			{
+				Saved[Index].Key->Set(*Saved[Index].Value);
+			}
+			IConsoleManager::Get().CallAllConsoleVariableSinks();
+		}
+
+		void Set(const TCHAR* Name, const TCHAR* Value)
+		{
+			IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+			if (!Variable)
+			{
+				UE_LOG(LogCameraDiff, Warning, TEXT("No console variable %s"), Name);
+				return;
+			}
+
+			Saved.Emplace(Variable, Variable->GetString());
+			Variable->Set(Value);
+
+			// Commandlets never tick the engine loop that runs sinks, and the camera picks its solvers in one
+			IConsoleManager::Get().CallAllConsoleVariableSinks();
+		}
+
+	private:
+		TArray<TPair<IConsoleVariable*, FString>> Saved;
+	};
+}
+
+void UCameraDiffCommandlet::FDiffSettings::Parse(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("Obstacles="), NumObstacles);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("PositionTolerance="), PositionTolerance);
+	FParse::Value(*Params, TEXT("RotationTolerance="), RotationTolerance);
+	FParse::Value(*Params, TEXT("Variants="), VariantFilter);
+	FParse::Value(*Params, TEXT("Trace="), TraceFile);
+	FParse::Value(*Params, TEXT("SaveTrace="), SaveTraceFile);
+	FParse::Value(*Params, TEXT("Csv="), CsvFile);
+
+	NumFrames = FMath::Max(NumFrames, 1);
+	NumObstacles = FMath::Max(NumObstacles, 0);
+	DeltaTime = FMath::Max(DeltaTime, KINDA_SMALL_NUMBER);
+}
+
+UCameraDiffCommandlet::UCameraDiffCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+TArray<UCameraDiffCommandlet::FVariant> UCameraDiffCommandlet::GetVariants()
+{
+	TArray<FVariant> Variants;
+
+	// Only threading changes, so these have to match to float precision
+	FVariant& ParallelFor = Variants.AddDefaulted_GetRef();
+	ParallelFor.Name = TEXT("ParallelFor");
+	ParallelFor.ConsoleVariables.Emplace(TEXT("Camera.ParallelUpdate"), TEXT("1"));
+	ParallelFor.PositionTolerance = .01f;
+	ParallelFor.RotationTolerance = .001f;
+
+	FVariant& Pipelined = Variants.AddDefaulted_GetRef();
+	Pipelined.Name = TEXT("Pipelined");
+	Pipelined.ConsoleVariables.Emplace(TEXT("Camera.ParallelUpdate"), TEXT("2"));
+	Pipelined.PositionTolerance = .01f;
+	Pipelined.RotationTolerance = .001f;
+
+	// Same arithmetic as the generic solver with the flags folded in, so only the compiler's reordering may differ
+	FVariant& SpecializedSolvers = Variants.AddDefaulted_GetRef();
+	SpecializedSolvers.Name = TEXT("SpecializedSolvers");
+	SpecializedSolvers.ConsoleVariables.Emplace(TEXT("Camera.SpecializedSolvers"), TEXT("1"));
+	SpecializedSolvers.PositionTolerance = .01f;
+	SpecializedSolvers.RotationTolerance = .001f;
+
+	FVariant& DirectView = Variants.AddDefaulted_GetRef();
+	DirectView.Name = TEXT("DirectView");
+	DirectView.bDirectViewOutput = true;
+	DirectView.PositionTolerance = .01f;
+	DirectView.RotationTolerance = .001f;
+
+	// Cheaper queries may place a hit slightly differently, but must never miss one the full sweep finds
+	FVariant& AdaptiveProbe = Variants.AddDefaulted_GetRef();
+	AdaptiveProbe.Name = TEXT("AdaptiveProbe");
+	AdaptiveProbe.ConsoleVariables.Emplace(TEXT("Camera.AdaptiveProbe"), TEXT("1"));
+	AdaptiveProbe.PositionTolerance = 1.f;
+	AdaptiveProbe.RotationTolerance = .001f;
+
+	// The obstacles are boxes already, so proxies only differ where small ones were merged
+	FVariant& CollisionProxies = Variants.AddDefaulted_GetRef();
+	CollisionProxies.Name = TEXT("CollisionProxies");
+	CollisionProxies.ConsoleVariables.Emplace(TEXT("Camera.CollisionProxies"), TEXT("1"));
+	CollisionProxies.bCollisionProxies = true;
+	CollisionProxies.PositionTolerance = 10.f;
+	CollisionProxies.RotationTolerance = .001f;
+
+	// Rotations are within thousandths of a degree; a probe grazing an edge may still land a little differently
+	FVariant& FastTrig = Variants.AddDefaulted_GetRef();
+	FastTrig.Name = TEXT("FastTrig");
+	FastTrig.ConsoleVariables.Emplace(TEXT("Camera.FastTrig"), TEXT("1"));
+	FastTrig.PositionTolerance = 1.f;
+	FastTrig.RotationTolerance = .01f;
+
+	// A budget nothing fits in drives the governor all the way down: no substeps, reused sweeps, throttled updates
+	FVariant& Degraded = Variants.AddDefaulted_GetRef();
+	Degraded.Name = TEXT("BudgetDegraded");
+	Degraded.ConsoleVariables.Emplace(TEXT("Camera.BudgetMs"), TEXT("0.0001"));
+	Degraded.PositionTolerance = 25.f;
+	Degraded.RotationTolerance = 2.f;
+
+	return Variants;
+}
+
+int32 UCameraDiffCommandlet::Main(const FString& Params)
+{
+	FDiffSettings Settings;
+	Settings.Parse(Params);
+
+	TArray<FTraceFrame> Trace;
+	if (!Settings.TraceFile.IsEmpty())
+	{
+		if (!LoadTrace(Settings.TraceFile, Trace))
+		{
+			UE_LOG(LogCameraDiff, Error, TEXT("Failed to load a trace from %s"), *Settings.TraceFile);
+			return 1;
+		}
+	}
+	else
+	{
+		FRandomStream Stream(Settings.Seed);
+		BuildRandomTrace(Stream, Settings, Trace);
+	}
+
+	if (!Settings.SaveTraceFile.IsEmpty() && !SaveTrace(Settings.SaveTraceFile, Trace))
+	{
+		UE_LOG(LogCameraDiff, Warning, TEXT("Failed to save the trace to %s"), *Settings.SaveTraceFile);
+	}
+
+	TArray<FVariant> Variants = GetVariants();
+	if (!Settings.VariantFilter.IsEmpty())
+	{
+		TArray<FString> Wanted;
+		Settings.VariantFilter.ParseIntoArray(Wanted, TEXT(","));
+		Variants.RemoveAll([&Wanted](const FVariant& Variant) { return !Wanted.Contains(Variant.Name); });
+	}
+
+	UE_LOG(LogCameraDiff, Display, TEXT("Camera diff: %d frames from %s, %d obstacles, seed %d, %d variants"),
+		Trace.Num(), Settings.TraceFile.IsEmpty() ? TEXT("a random trace") : *Settings.TraceFile, Settings.NumObstacles, Settings.Seed, Variants.Num());
+
+	FVariant Reference;
+	Reference.Name = TEXT("Reference");
+
+	FViewTrack ReferenceViews;
+	if (!RunTrace(Reference, Trace, Settings, ReferenceViews))
+	{
+		UE_LOG(LogCameraDiff, Error, TEXT("Failed to run the reference path"));
+		return 1;
+	}
+
+	// Divergence of every variant that ran on every frame, for the CSV
+	TArray<const TCHAR*> ComparedNames;
+	TArray<TArray<float>> PositionErrors;
+	TArray<TArray<float>> RotationErrors;
+
+	int32 NumFailed = 0;
+	for (const FVariant& Variant : Variants)
+	{
+		FViewTrack Views;
+		if (!RunTrace(Variant, Trace, Settings, Views))
+		{
+			UE_LOG(LogCameraDiff, Error, TEXT("%-16s failed to run"), Variant.Name);
+			++NumFailed;
+			continue;
+		}
+
+		ComparedNames.Add(Variant.Name);
+		TArray<float>& Positions = PositionErrors.AddDefaulted_GetRef();
+		TArray<float>& Rotations = RotationErrors.AddDefaulted_GetRef();
+		Positions.SetNumZeroed(Trace.Num());
+		Rotations.SetNumZeroed(Trace.Num());
+
+		float MaxPosition = 0.f;
+		float MaxRotation = 0.f;
+		int32 MaxPositionFrame = 0;
+		int32 MaxRotationFrame = 0;
+		double TotalPosition = 0.0;
+		for (int32 FrameIndex = 0; FrameIndex < Trace.Num(); ++FrameIndex)
+		{
+			const FTransform& Reference = ReferenceViews[FrameIndex];
+			const FTransform& View = Views[FrameIndex];
+
+			Positions[FrameIndex] = FVector::Dist(Reference.GetLocation(), View.GetLocation());
+			Rotations[FrameIndex] = FMath::RadiansToDegrees(Reference.GetRotation().AngularDistance(View.GetRotation()));
+			TotalPosition += Positions[FrameIndex];
+
+			if (Positions[FrameIndex] > MaxPosition)
+			{
+				MaxPosition = Positions[FrameIndex];
+				MaxPositionFrame = FrameIndex;
+			}
+			if (Rotations[FrameIndex] > MaxRotation)
+			{
+				MaxRotation = Rotations[FrameIndex];
+				MaxRotationFrame = FrameIndex;
+			}
+		}
+
+		const float PositionTolerance = Settings.PositionTolerance >= 0.f ? Settings.PositionTolerance : Variant.PositionTolerance;
+		const float RotationTolerance = Settings.RotationTolerance >= 0.f ? Settings.RotationTolerance : Variant.RotationTolerance;
+		const bool bPassed = MaxPosition <= PositionTolerance && MaxRotation <= RotationTolerance;
+		if (!bPassed)
+		{
+			++NumFailed;
+		}
+
+		UE_LOG(LogCameraDiff, Display, TEXT("%-16s %s   position max %8.3f (frame %5d, limit %.3f) mean %8.3f   rotation max %7.4f deg (frame %5d, limit %.4f)"),
+			Variant.Name, bPassed ? TEXT("PASS") : TEXT("FAIL"), MaxPosition, MaxPositionFrame, PositionTolerance, TotalPosition / Trace.Num(),
+			MaxRotation, MaxRotationFrame, RotationTolerance);
+	}
+
+	if (!Settings.CsvFile.IsEmpty())
+	{
+		FString Csv = TEXT("Frame,DeltaTime");
+		for (const TCHAR* Name : ComparedNames)
+		{
+			Csv += FString::Printf(TEXT(",%sPosition,%sRotation"), Name, Name);
+		}
+		Csv += LINE_TERMINATOR;
+
+		for (int32 FrameIndex = 0; FrameIndex < Trace.Num(); ++FrameIndex)
+		{
+			Csv += FString::Printf(TEXT("%d,%.5f"), FrameIndex, Trace[FrameIndex].DeltaTime);
+			for (int32 VariantIndex = 0; VariantIndex < PositionErrors.Num(); ++VariantIndex)
+			{
+				Csv += FString::Printf(TEXT(",%.4f,%.5f"), PositionErrors[VariantIndex][FrameIndex], RotationErrors[VariantIndex][FrameIndex]);
+			}
+			Csv += LINE_TERMINATOR;
+		}
+
+		if (!FFileHelper::SaveStringToFile(Csv, *Settings.CsvFile))
+		{
+			UE_LOG(LogCameraDiff, Warning, TEXT("Failed to write %s"), *Settings.CsvFile);
+		}
+	}
+
+	return NumFailed;
+}
+
+bool UCameraDiffCommandlet::RunTrace(const FVariant& Variant, const TArray<FTraceFrame>& Trace, const FDiffSettings& Settings, FViewTrack& OutViews) const
+{
+	CameraDiff::FScopedConsoleVariables ConsoleVariables;
+	for (const auto& Reference : CameraDiff::ReferenceConsoleVariables)
+	{
+		ConsoleVariables.Set(Reference[0], Reference[1]);
+	}
+	for (const TPair<const TCHAR*, const TCHAR*>& Override : Variant.ConsoleVariables)
+	{
+		ConsoleVariables.Set(Override.Key, Override.Value);
+	}
+
+	UWorld* World = CreateDiffWorld(Settings);
+	if (!World) { return false; }
+
+	if (Variant.bCollisionProxies)
+	{
+		// The obstacles are movable so the stress tests can share them, which proxies normally leave out
+		FCameraProxyBuildSettings BuildSettings;
+		BuildSettings.bIncludeMovable = true;
+		if (!ACameraCollisionProxy::Generate(World->PersistentLevel, BuildSettings))
+		{
+			DestroyDiffWorld(World);
+			return false;
+		}
+	}
+
+	USceneComponent* View = nullptr;
+	UCameraSpringArm* Arm = SpawnArm(World, Trace[0], Variant.bDirectViewOutput, View);
+	if (!Arm)
+	{
+		DestroyDiffWorld(World);
+		return false;
+	}
+
+	AActor* Owner = Arm->GetOwner();
+	OutViews.Reset(Trace.Num());
+	for (const FTraceFrame& Frame : Trace)
+	{
+		Owner->SetActorLocationAndRotation(Frame.Location, Frame.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+		World->Tick(LEVELTICK_All, Frame.DeltaTime);
+
+		// What the view would see: the committed pose with direct output, the camera's own transform otherwise
+		FTransform ViewTransform = View->GetComponentTransform();
+		if (Variant.bDirectViewOutput)
+		{
+			Arm->GetCommittedView(ViewTransform);
+		}
+		OutViews.Add(ViewTransform);
+	}
+
+	DestroyDiffWorld(World);
+	return true;
+}
+
+UWorld* UCameraDiffCommandlet::CreateDiffWorld(const FDiffSettings& Settings) const
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CameraDiffWorld"));
+	if (!World) { return nullptr; }
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!CubeMesh)
+	{
+		UE_LOG(LogCameraDiff, Warning, TEXT("Couldn't load the engine cube, running without obstacles"));
+		return World;
+	}
+
+	// Same seed for every run, so every variant sees the same field whatever trace it follows
+	FRandomStream Stream(Settings.Seed);
+	const float Extent = GetFieldExtent(Settings);
+
+	auto SpawnBox = [World, CubeMesh](const FVector& Location, const FRotator& Rotation, const FVector& Scale)
+	{
+		AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Location, Rotation);
+		UStaticMeshComponent* BoxMesh = Box->GetStaticMeshComponent();
+		BoxMesh->SetMobility(EComponentMobility::Movable);
+		BoxMesh->SetStaticMesh(CubeMesh);
+		BoxMesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Box->SetActorScale3D(Scale);
+	};
+
+	SpawnBox(FVector(0.f, 0.f, -50.f), FRotator::ZeroRotator, FVector(Extent / 50.f, Extent / 50.f, 1.f));
+
+	for (int32 Index = 0; Index < Settings.NumObstacles; ++Index)
+	{
+		const FVector Scale(Stream.FRandRange(.5f, 6.f), Stream.FRandRange(.5f, 6.f), Stream.FRandRange(1.f, 8.f));
+		const FVector Location(Stream.FRandRange(-Extent, Extent), Stream.FRandRange(-Extent, Extent), Scale.Z * 50.f);
+		SpawnBox(Location, FRotator(0.f, Stream.FRandRange(0.f, 360.f), 0.f), Scale);
+	}
+
+	return World;
+}
+
+void UCameraDiffCommandlet::DestroyDiffWorld(UWorld* World) const
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+UCameraSpringArm* UCameraDiffCommandlet::SpawnArm(UWorld* World, const FTraceFrame& Start, bool bDirectViewOutput, USceneComponent*& OutView) const
+{
+	AActor* Owner = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Start.Rotation, Start.Location));
+	if (!Owner) { return nullptr; }
+
+	USceneComponent* Root = NewObject<USceneComponent>(Owner, TEXT("Root"));
+	Owner->SetRootComponent(Root);
+	Root->RegisterComponent();
+	Owner->SetActorLocationAndRotation(Start.Location, Start.Rotation);
+
+	// The owner's rotation stands in for the control rotation, so lag and every probe tier get exercised
+	UCameraSpringArm* Arm = NewObject<UCameraSpringArm>(Owner, TEXT("Arm"));
+	Arm->SetupAttachment(Root);
+	Arm->TargetArmLength = 400.f;
+	Arm->ActualSocketOffset = FVector(0.f, 60.f, 60.f);
+	Arm->bDirectViewOutput = bDirectViewOutput;
+	Arm->SetRigOverride(ECameraRigOverride::EnableCameraLag, 1.f);
+	Arm->SetRigOverride(ECameraRigOverride::EnableCameraRotationLag, 1.f);
+	Arm->RegisterComponent();
+
+	OutView = NewObject<USceneComponent>(Owner, TEXT("View"));
+	OutView->SetupAttachment(Arm, UCameraSpringArm::SocketName);
+	OutView->RegisterComponent();
+
+	return Arm;
+}
+
+float UCameraDiffCommandlet::GetFieldExtent(const FDiffSettings& Settings)
+{
+	// About the density of the stress test field
+	return FMath::Sqrt((float)FMath::Max(Settings.NumObstacles, 1)) * 250.f;
+}
+
+void UCameraDiffCommandlet::BuildRandomTrace(FRandomStream& Stream, const FDiffSettings& Settings, TArray<FTraceFrame>& OutTrace) const
+{
+	const float Extent = GetFieldExtent(Settings);
+
+	FVector Location(0.f, 0.f, 180.f);
+	float Heading = Stream.FRandRange(0.f, 360.f);
+	float LookYaw = 0.f;
+	float LookPitch = -10.f;
+
+	OutTrace.Reset(Settings.NumFrames);
+	for (int32 FrameIndex = 0; FrameIndex < Settings.NumFrames; ++FrameIndex)
+	{
+		// Frame times jitter a little, and now and then a hitch is long enough to need several lag substeps
+		float DeltaTime = Settings.DeltaTime * Stream.FRandRange(.8f, 1.2f);
+		if (Stream.FRand() < .03f)
+		{
+			DeltaTime = Settings.DeltaTime * Stream.FRandRange(3.f, 8.f);
+		}
+
+		// Wander, turning back towards the middle near the edge of the field
+		Heading += Stream.FRandRange(-60.f, 60.f) * DeltaTime;
+		if (FMath::Abs(Location.X) > Extent * .9f || FMath::Abs(Location.Y) > Extent * .9f)
+		{
+			Heading = FMath::RadiansToDegrees(FMath::Atan2(-Location.Y, -Location.X));
+		}
+		Location += FRotator(0.f, Heading, 0.f).Vector() * Stream.FRandRange(300.f, 600.f) * DeltaTime;
+
+		// Flick the view now and then, and drift it the rest of the time
+		const bool bFlick = Stream.FRand() < .01f;
+		LookYaw += bFlick ? Stream.FRandRange(-120.f, 120.f) : Stream.FRandRange(-90.f, 90.f) * DeltaTime;
+		LookPitch = FMath::Clamp(LookPitch + Stream.FRandRange(-30.f, 30.f) * DeltaTime, -45.f, 30.f);
+
+		FTraceFrame& Frame = OutTrace.AddDefaulted_GetRef();
+		Frame.DeltaTime = DeltaTime;
+		Frame.Location = Location;
+		Frame.Rotation = FRotator(LookPitch, Heading + LookYaw, 0.f);
+	}
+}
+
+bool UCameraDiffCommandlet::LoadTrace(const FString& Filename, TArray<FTraceFrame>& OutTrace) const
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Filename)) { return false; }
+
+	OutTrace.Reset(Lines.Num());
+	TArray<FString> Fields;
+	for (const FString& Line : Lines)
+	{
+		Line.ParseIntoArray(Fields, TEXT(","));
+
+		// Skips headers and comments along with anything malformed
+		if (Fields.Num() != 7 || !Fields[0].IsNumeric()) { continue; }
+
+		FTraceFrame& Frame = OutTrace.AddDefaulted_GetRef();
+		Frame.DeltaTime = FMath::Max(FCString::Atof(*Fields[0]), KINDA_SMALL_NUMBER);
+		Frame.Location = FVector(FCString::Atof(*Fields[1]), FCString::Atof(*Fields[2]), FCString::Atof(*Fields[3]));
+		Frame.Rotation = FRotator(FCString::Atof(*Fields[4]), FCString::Atof(*Fields[5]), FCString::Atof(*Fields[6]));
+	}
+
+	return OutTrace.Num() > 0;
+}
+
+bool UCameraDiffCommandlet::SaveTrace(const FString& Filename, const TArray<FTraceFrame>& Trace) const
+{
+	FString Csv = TEXT("DeltaTime,X,Y,Z,Pitch,Yaw,Roll");
+	Csv += LINE_TERMINATOR;
+	for (const FTraceFrame& Frame : Trace)
+	{
+		Csv += FString::Printf(TEXT("%.6f,%.3f,%.3f,%.3f,%.4f,%.4f,%.4f"), Frame.DeltaTime,
+			Frame.Location.X, Frame.Location.Y, Frame.Location.Z, Frame.Rotation.Pitch, Frame.Rotation.Yaw, Frame.Rotation.Roll);
+		Csv += LINE_TERMINATOR;
+	}
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
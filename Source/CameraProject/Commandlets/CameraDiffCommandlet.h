@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CameraDiffCommandlet.generated.h"
+
+class UWorld;
+class AActor;
+class USceneComponent;
+class UCameraSpringArm;
+
+/**
+ * Differential test for the camera's fast paths. Drives one spring arm along an input trace through an obstacle
+ * field with the reference path (per component tick, every probe a full sweep, no budget, no proxies, precise
+ * trigonometry, the generic lag solver and BlendLocations called through the vtable), then again with each
+ * alternative path, and compares the view each run produced frame by frame. Reports the largest position and
+ * rotation divergence of every variant and returns the number of variants that went over their tolerance.
+ *
+ * UE4Editor-Cmd CameraProject -run=CameraDiff -nullrhi -Frames=1800 -Seed=1
+ *
+ * Optional: -Variants=ParallelFor,AdaptiveProbe -Obstacles=N -DeltaTime=Seconds
+ * -PositionTolerance=Units -RotationTolerance=Degrees to hold every variant to the same bounds
+ *
+ * -Trace=File.csv replays a recorded trace instead of a random one, one frame per line as
+ * DeltaTime,X,Y,Z,Pitch,Yaw,Roll of the arm's owner. -SaveTrace=File.csv writes the trace used out in that format.
+ * -Csv=File.csv writes the position and rotation divergence of every variant on every frame.
+ */
+UCLASS()
+class UCameraDiffCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCameraDiffCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+private:
+	struct FDiffSettings
+	{
+		int32 NumFrames = 1800;
+		int32 NumObstacles = 200;
+		int32 Seed = 1;
+		float DeltaTime = 1.f / 60.f;
+		float PositionTolerance = -1.f;
+		float RotationTolerance = -1.f;
+		FString VariantFilter;
+		FString TraceFile;
+		FString SaveTraceFile;
+		FString CsvFile;
+
+		void Parse(const FString& Params);
+	};
+
+	/** Where the arm's owner is and how long the frame that put it there took */
+	struct FTraceFrame
+	{
+		float DeltaTime;
+		FVector Location;
+		FRotator Rotation;
+	};
+
+	/** A way of running the camera that should match the reference, and how closely it is expected to */
+	struct FVariant
+	{
+		const TCHAR* Name = nullptr;
+		/** Console variables set on top of the reference ones */
+		TArray<TPair<const TCHAR*, const TCHAR*>> ConsoleVariables;
+		bool bDirectViewOutput = false;
+		bool bCollisionProxies = false;
+		float PositionTolerance = 0.f;
+		float RotationTolerance = 0.f;
+	};
+
+	/** View of one run on every frame of the trace */
+	typedef TArray<FTransform> FViewTrack;
+
+	static TArray<FVariant> GetVariants();
+
+	/** Random walk through the obstacle field with look input and the odd hitch */
+	void BuildRandomTrace(FRandomStream& Stream, const FDiffSettings& Settings, TArray<FTraceFrame>& OutTrace) const;
+
+	bool LoadTrace(const FString& Filename, TArray<FTraceFrame>& OutTrace) const;
+	bool SaveTrace(const FString& Filename, const TArray<FTraceFrame>& Trace) const;
+
+	/** Runs the whole trace in a fresh world with Variant's settings on top of the reference ones */
+	bool RunTrace(const FVariant& Variant, const TArray<FTraceFrame>& Trace, const FDiffSettings& Settings, FViewTrack& OutViews) const;
+
+	UWorld* CreateDiffWorld(const FDiffSettings& Settings) const;
+	void DestroyDiffWorld(UWorld* World) const;
+
+	/** Actor with the arm under test, and a component on the arm's socket standing in for the camera */
+	UCameraSpringArm* SpawnArm(UWorld* World, const FTraceFrame& Start, bool bDirectViewOutput, USceneComponent*& OutView) const;
+
+	/** Half the width of the square area the obstacles and the trace are in */
+	static float GetFieldExtent(const FDiffSettings& Settings);
+};
@@ -0,0 +1,321 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraProxyCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/LevelStreaming.h"
+#include "Components/StaticMeshComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraProxy, Log, All);
+
+UCameraProxyCommandlet::UCameraProxyCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCameraProxyCommandlet::Main(const FString& Params)
+{
+	FCameraProxyBuildSettings BuildSettings;
+	FParse::Value(*Params, TEXT("MinSize="), BuildSettings.MinSize);
+	FParse::Value(*Params, TEXT("MergeSize="), BuildSettings.MergeSize);
+	FParse::Value(*Params, TEXT("MinFillRatio="), BuildSettings.MinFillRatio);
+
+	FBenchmarkSettings BenchmarkSettings;
+	FParse::Value(*Params, TEXT("Sweeps="), BenchmarkSettings.NumSweeps);
+	FParse::Value(*Params, TEXT("Seed="), BenchmarkSettings.Seed);
+	FParse::Value(*Params, TEXT("ProbeSize="), BenchmarkSettings.ProbeSize);
+	FParse::Value(*Params, TEXT("ArmLength="), BenchmarkSettings.ArmLength);
+	BenchmarkSettings.NumSweeps = FMath::Max(BenchmarkSettings.NumSweeps, 1);
+
+	FString ClutterMeshes;
+	if (FParse::Value(*Params, TEXT("ClutterMeshes="), ClutterMeshes, false))
+	{
+		ClutterMeshes.ParseIntoArray(BenchmarkSettings.ClutterMeshes, TEXT("+"));
+	}
+
+	const bool bBenchmark = FParse::Param(*Params, TEXT("Benchmark"));
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+
+	FString MapName;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	if (MapName.IsEmpty() && !bBenchmark)
+	{
+		UE_LOG(LogCameraProxy, Error, TEXT("Usage: -run=CameraProxy -Map=/Game/Maps/Level [-Benchmark] [-NoSave]"));
+		return 1;
+	}
+
+	UWorld* World = MapName.IsEmpty() ? CreateClutterWorld(BenchmarkSettings) : LoadMap(MapName);
+	if (!World)
+	{
+		UE_LOG(LogCameraProxy, Error, TEXT("Failed to load %s"), MapName.IsEmpty() ? TEXT("the clutter world") : *MapName);
+		return 1;
+	}
+
+	// Movable clutter is all the generated world has, and its proxies are never saved
+	BuildSettings.bIncludeMovable = MapName.IsEmpty();
+
+	// Each level gets its own proxy, so levels streamed in without one keep their own collision
+	TArray<ACameraCollisionProxy*> Proxies;
+	for (ULevel* Level : World->GetLevels())
+	{
+		const FString LevelName = Level->GetOutermost()->GetName();
+		ACameraCollisionProxy* Proxy = ACameraCollisionProxy::Generate(Level, BuildSettings);
+		if (!Proxy)
+		{
+			UE_LOG(LogCameraProxy, Display, TEXT("%s: nothing blocking the camera to proxy"), *LevelName);
+			continue;
+		}
+
+		Proxies.Add(Proxy);
+		UE_LOG(LogCameraProxy, Display, TEXT("%s: %d camera blocking meshes covered by %d proxy boxes"),
+			*LevelName, Proxy->GetProxiedComponents().Num(), Proxy->GetProxyComponent()->Boxes.Num());
+	}
+
+	if (bBenchmark)
+	{
+		RunBenchmark(World, Proxies, BenchmarkSettings);
+	}
+
+	// Levels left without anything to proxy still lost their old proxy, so every level is saved
+	int32 Result = 0;
+	if (!MapName.IsEmpty() && bSave)
+	{
+		for (ULevel* Level : World->GetLevels())
+		{
+			if (!SaveLevel(Level))
+			{
+				UE_LOG(LogCameraProxy, Error, TEXT("Failed to save %s"), *Level->GetOutermost()->GetName());
+				Result = 1;
+			}
+		}
+	}
+
+	DestroyWorld(World);
+	return Result;
+}
+
+UWorld* UCameraProxyCommandlet::LoadMap(const FString& MapName) const
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World) { return nullptr; }
+
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitWorld(UWorld::InitializationValues()
+		.AllowAudioPlayback(false)
+		.CreatePhysicsScene(true)
+		.RequiresHitProxies(false)
+		.CreateNavigation(false)
+		.CreateAISystem(false)
+		.ShouldSimulatePhysics(false)
+		.SetTransactional(false));
+	World->UpdateWorldComponents(true, false);
+
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		if (StreamingLevel)
+		{
+			StreamingLevel->SetShouldBeLoaded(true);
+			StreamingLevel->SetShouldBeVisible(true);
+		}
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	return World;
+}
+
+UWorld* UCameraProxyCommandlet::CreateClutterWorld(const FBenchmarkSettings& Settings) const
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CameraProxyWorld"));
+	if (!World) { return nullptr; }
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->AddToRoot();
+
+	// Dense engine meshes unless the project's own art is given; the basic shapes' simple collision would flatter the original
+	TArray<FString> MeshPaths = Settings.ClutterMeshes;
+	if (MeshPaths.Num() == 0)
+	{
+		MeshPaths.Add(TEXT("/Engine/EngineMeshes/SM_MatPreviewMesh_02.SM_MatPreviewMesh_02"));
+		MeshPaths.Add(TEXT("/Engine/EngineMeshes/Sphere.Sphere"));
+	}
+
+	TArray<UStaticMesh*> Meshes;
+	for (const FString& MeshPath : MeshPaths)
+	{
+		UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, *MeshPath);
+		UBodySetup* BodySetup = Mesh ? Mesh->GetBodySetup() : nullptr;
+		if (!BodySetup)
+		{
+			UE_LOG(LogCameraProxy, Warning, TEXT("Couldn't load %s with collision, leaving it out of the clutter"), *MeshPath);
+			continue;
+		}
+
+		// Swept against its triangles, like art without simple collision; the mesh is never saved
+		BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		BodySetup->InvalidatePhysicsData();
+		BodySetup->CreatePhysicsMeshes();
+		Meshes.Add(Mesh);
+	}
+	if (Meshes.Num() == 0)
+	{
+		UE_LOG(LogCameraProxy, Warning, TEXT("Couldn't load any clutter meshes, the clutter world is empty"));
+		return World;
+	}
+
+	// Clusters of overlapping rocks and props, each piece far smaller than the cluster
+	FRandomStream Stream(Settings.Seed);
+	const int32 NumClusters = 200;
+	const int32 PiecesPerCluster = 40;
+	const float FieldExtent = 10000.f;
+	for (int32 ClusterIndex = 0; ClusterIndex < NumClusters; ++ClusterIndex)
+	{
+		const FVector ClusterCenter(Stream.FRandRange(-FieldExtent, FieldExtent), Stream.FRandRange(-FieldExtent, FieldExtent), 100.f);
+		for (int32 PieceIndex = 0; PieceIndex < PiecesPerCluster; ++PieceIndex)
+		{
+			const FVector Location = ClusterCenter + FVector(Stream.FRandRange(-150.f, 150.f), Stream.FRandRange(-150.f, 150.f), Stream.FRandRange(-100.f, 100.f));
+			AStaticMeshActor* Piece = World->SpawnActor<AStaticMeshActor>(Location, FRotator(Stream.FRandRange(0.f, 360.f), Stream.FRandRange(0.f, 360.f), 0.f));
+			UStaticMeshComponent* PieceMesh = Piece->GetStaticMeshComponent();
+			PieceMesh->SetMobility(EComponentMobility::Movable);
+			PieceMesh->SetStaticMesh(Meshes[Stream.RandHelper(Meshes.Num())]);
+			PieceMesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			Piece->SetActorScale3D(FVector(Stream.FRandRange(.3f, 1.2f)));
+		}
+	}
+
+	return World;
+}
+
+void UCameraProxyCommandlet::DestroyWorld(UWorld* World) const
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+bool UCameraProxyCommandlet::SaveLevel(ULevel* Level) const
+{
+#if WITH_EDITOR
+	UPackage* Package = Level->GetOutermost();
+	UWorld* LevelWorld = UWorld::FindWorldInPackage(Package);
+	if (!LevelWorld) { return false; }
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetMapPackageExtension());
+	return UPackage::SavePackage(Package, LevelWorld, RF_NoFlags, *Filename, GError, nullptr, false, true, SAVE_NoError);
+#else
+	return false;
+#endif
+}
+
+void UCameraProxyCommandlet::RunBenchmark(UWorld* World, const TArray<ACameraCollisionProxy*>& Proxies, const FBenchmarkSettings& Settings) const
+{
+	// Sweep where the proxied geometry is, since sweeps through empty space cost the same either way
+	FBox SceneBounds(ForceInit);
+	for (const ACameraCollisionProxy* Proxy : Proxies)
+	{
+		for (const UStaticMeshComponent* Component : Proxy->GetProxiedComponents())
+		{
+			if (Component)
+			{
+				SceneBounds += Component->Bounds.GetBox();
+			}
+		}
+	}
+	if (!SceneBounds.IsValid)
+	{
+		UE_LOG(LogCameraProxy, Warning, TEXT("Nothing blocks the camera, skipping the benchmark"));
+		return;
+	}
+
+	FRandomStream Stream(Settings.Seed);
+	TArray<FVector> Starts;
+	TArray<FVector> Ends;
+	for (int32 Index = 0; Index < Settings.NumSweeps; ++Index)
+	{
+		const FVector Start(
+			Stream.FRandRange(SceneBounds.Min.X, SceneBounds.Max.X),
+			Stream.FRandRange(SceneBounds.Min.Y, SceneBounds.Max.Y),
+			Stream.FRandRange(SceneBounds.Min.Z, SceneBounds.Max.Z));
+		Starts.Add(Start);
+		Ends.Add(Start + Stream.VRand() * Settings.ArmLength);
+	}
+
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(Settings.ProbeSize);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CameraProxyBenchmark), false);
+
+	// The same probe the spring arms run, so whatever the proxies don't cover is swept in both runs
+	auto RunSweeps = [World, &Proxies, &Starts, &Ends, &Shape, &QueryParams](bool bUseProxies, TArray<float>& OutHitTimes)
+	{
+		for (ACameraCollisionProxy* Proxy : Proxies)
+		{
+			Proxy->SetProxiesActive(bUseProxies);
+		}
+
+		FHitResult Hit;
+		OutHitTimes.SetNumUninitialized(Starts.Num());
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < Starts.Num(); ++Index)
+		{
+			const bool bHit = World->SweepSingleByChannel(Hit, Starts[Index], Ends[Index], FQuat::Identity, ECC_Camera, Shape, QueryParams);
+			OutHitTimes[Index] = bHit ? Hit.Time : 1.f;
+		}
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0 / Starts.Num();
+	};
+
+	TArray<float> OriginalTimes;
+	TArray<float> ProxyTimes;
+	const double OriginalMicroseconds = RunSweeps(false, OriginalTimes);
+	const double ProxyMicroseconds = RunSweeps(true, ProxyTimes);
+
+	// The meshes' own responses are what gets saved with the map
+	for (ACameraCollisionProxy* Proxy : Proxies)
+	{
+		Proxy->SetProxiesActive(false);
+	}
+
+	int32 Agreed = 0;
+	int32 ProxyOnly = 0;
+	int32 OriginalOnly = 0;
+	double PullInDifference = 0.0;
+	int32 BothHit = 0;
+	for (int32 Index = 0; Index < Settings.NumSweeps; ++Index)
+	{
+		const bool bOriginalHit = OriginalTimes[Index] < 1.f;
+		const bool bProxyHit = ProxyTimes[Index] < 1.f;
+		if (bOriginalHit == bProxyHit) { ++Agreed; }
+		else if (bProxyHit) { ++ProxyOnly; }
+		else { ++OriginalOnly; }
+
+		if (bOriginalHit && bProxyHit)
+		{
+			PullInDifference += (OriginalTimes[Index] - ProxyTimes[Index]) * Settings.ArmLength;
+			++BothHit;
+		}
+	}
+
+	UE_LOG(LogCameraProxy, Display, TEXT("%d sweeps, radius %.0f, length %.0f"), Settings.NumSweeps, Settings.ProbeSize, Settings.ArmLength);
+	UE_LOG(LogCameraProxy, Display, TEXT("Original collision %8.3f us per sweep"), OriginalMicroseconds);
+	UE_LOG(LogCameraProxy, Display, TEXT("Proxies            %8.3f us per sweep   %.2fx"), ProxyMicroseconds, ProxyMicroseconds > 0.0 ? OriginalMicroseconds / ProxyMicroseconds : 0.0);
+	UE_LOG(LogCameraProxy, Display, TEXT("Hits agree %.1f%%, proxy only %.1f%%, original only %.1f%%, proxies pull in %.1f units earlier on average"),
+		100.0 * Agreed / Settings.NumSweeps, 100.0 * ProxyOnly / Settings.NumSweeps, 100.0 * OriginalOnly / Settings.NumSweeps,
+		BothHit > 0 ? PullInDifference / BothHit : 0.0);
+}
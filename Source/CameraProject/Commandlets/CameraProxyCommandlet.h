@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CameraCharacter/CameraCollisionProxy.h"
+#include "CameraProxyCommandlet.generated.h"
+
+class UWorld;
+class ULevel;
+
+/**
+ * Generates camera collision proxies for a map and each of its sublevels, and saves each into its own level:
+ *
+ * UE4Editor-Cmd CameraProject -run=CameraProxy -Map=/Game/Maps/Level
+ *
+ * Optional: -MinSize=Units -MergeSize=Units -MinFillRatio=0..1 -NoSave
+ *
+ * -Benchmark compares camera probe sweeps against the map's own collision with the same sweeps once the proxies are
+ * swapped in, reporting the time per sweep and how often the two agree on a hit. Without -Map it builds a field of
+ * clustered clutter with per-poly collision to measure against. -Sweeps=N -Seed=N -ProbeSize=Units -ArmLength=Units
+ * -ClutterMeshes=/Game/Path/MeshA+/Game/Path/MeshB picks the clutter, best taken from the project's own art.
+ */
+UCLASS()
+class UCameraProxyCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCameraProxyCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+private:
+	struct FBenchmarkSettings
+	{
+		int32 NumSweeps = 10000;
+		int32 Seed = 1;
+		float ProbeSize = 12.f;
+		float ArmLength = 400.f;
+		TArray<FString> ClutterMeshes;
+	};
+
+	/** Loads MapName and all of its sublevels into an editor world with their collision registered */
+	UWorld* LoadMap(const FString& MapName) const;
+
+	/** Game world filled with clusters of small meshes swept per polygon, like a dense art area */
+	UWorld* CreateClutterWorld(const FBenchmarkSettings& Settings) const;
+
+	void DestroyWorld(UWorld* World) const;
+
+	/** Saves the package of Level, which is the map itself for the persistent level */
+	bool SaveLevel(ULevel* Level) const;
+
+	/** Times the same random camera sweeps on ECC_Camera with Proxies inactive, then active */
+	void RunBenchmark(UWorld* World, const TArray<ACameraCollisionProxy*>& Proxies, const FBenchmarkSettings& Settings) const;
+};
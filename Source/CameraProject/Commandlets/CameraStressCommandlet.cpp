@@ -0,0 +1,482 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraStressCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "GameFramework/Character.h"
+#include "AIController.h"
+#include "CameraProjectCharacter.h"
+#include "CameraCharacter/CameraCharacter.h"
+#include "CameraStats.h"
+#include "CameraCharacter/CameraArmSubsystem.h"
+#include "CameraArmComponent.h"
+#include "Camera/CameraComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCameraStress, Log, All);
+
+namespace CameraStress
+{
+	/** Value at Percentile (0..1) of an already sorted array */
+	static double GetPercentile(const TArray<double>& SortedValues, double Percentile)
+	{
+		if (SortedValues.Num() == 0) { return 0.0; }
+
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * SortedValues.Num()) - 1, 0, SortedValues.Num() - 1);
+		return SortedValues[Index];
+	}
+
+	static double GetMean(const TArray<double>& Values)
+	{
+		double Total = 0.0;
+		for (double Value : Values) { Total += Value; }
+		return Values.Num() > 0 ? Total / Values.Num() : 0.0;
+	}
+
+	static void LogDistribution(const TCHAR* Label, TArray<double>& Values)
+	{
+		Values.Sort();
+		UE_LOG(LogCameraStress, Display, TEXT("%-12s mean %8.3f ms   p50 %8.3f   p90 %8.3f   p99 %8.3f   max %8.3f"),
+			Label, GetMean(Values), GetPercentile(Values, .5), GetPercentile(Values, .9), GetPercentile(Values, .99), Values.Num() ? Values.Last() : 0.0);
+	}
+}
+
+void UCameraStressCommandlet::FStressSettings::Parse(const FString& Params)
+{
+	FParse::Value(*Params, TEXT("Pawns="), NumPawns);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	FParse::Value(*Params, TEXT("WarmupFrames="), WarmupFrames);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("ArmComponentRatio="), ArmComponentRatio);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+	FParse::Value(*Params, TEXT("ChangeInterval="), ChangeInterval);
+	FParse::Value(*Params, TEXT("UpdateMode="), UpdateMode);
+	bParallelScaling = FParse::Param(*Params, TEXT("ParallelScaling"));
+	bCheckAllocations = FParse::Param(*Params, TEXT("CheckAllocations"));
+	bMeasurePawnCost = FParse::Param(*Params, TEXT("MeasurePawnCost"));
+
+	// By default keep roughly the same obstacle density however many pawns there are
+	NumObstacles = NumPawns * 4;
+	FParse::Value(*Params, TEXT("Obstacles="), NumObstacles);
+
+	NumPawns = FMath::Max(NumPawns, 1);
+	NumFrames = FMath::Max(NumFrames, 1);
+	WarmupFrames = FMath::Max(WarmupFrames, 0);
+	ArmComponentRatio = FMath::Clamp(ArmComponentRatio, 0.f, 1.f);
+	DeltaTime = FMath::Max(DeltaTime, KINDA_SMALL_NUMBER);
+}
+
+UCameraStressCommandlet::UCameraStressCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCameraStressCommandlet::Main(const FString& Params)
+{
+	FStressSettings Settings;
+	Settings.Parse(Params);
+
+	UE_LOG(LogCameraStress, Display, TEXT("Camera stress: %d pawns, %d obstacles, %d frames at %.4fs, seed %d"),
+		Settings.NumPawns, Settings.NumObstacles, Settings.NumFrames, Settings.DeltaTime, Settings.Seed);
+
+	UWorld* World = CreateStressWorld();
+	if (!World)
+	{
+		UE_LOG(LogCameraStress, Error, TEXT("Failed to create the stress test world"));
+		return 1;
+	}
+
+	FRandomStream Stream(Settings.Seed);
+	BuildObstacleField(World, Stream, Settings);
+
+	TArray<APawn*> Pawns;
+	SpawnPawns(World, Stream, Settings, Pawns);
+
+	IConsoleVariable* ParallelUpdateVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Camera.ParallelUpdate"));
+	if (ParallelUpdateVar)
+	{
+		ParallelUpdateVar->Set(Settings.UpdateMode);
+	}
+
+	if (Settings.bParallelScaling)
+	{
+		RunParallelScaling(World, Pawns, Stream, Settings);
+		DestroyStressWorld(World);
+		return 0;
+	}
+
+	if (Settings.bMeasurePawnCost)
+	{
+		RunPawnCost(World, Pawns, Stream, Settings);
+		DestroyStressWorld(World);
+		return 0;
+	}
+
+	if (Settings.bCheckAllocations)
+	{
+		const uint32 NumAllocations = RunAllocationCheck(World, Pawns, Stream, Settings);
+		if (ParallelUpdateVar)
+		{
+			ParallelUpdateVar->Set(0);
+		}
+		DestroyStressWorld(World);
+		return NumAllocations > 0 ? 1 : 0;
+	}
+
+	UCameraArmSubsystem* ArmSubsystem = World->GetSubsystem<UCameraArmSubsystem>();
+
+	TArray<double> FrameTimes;
+	TArray<double> BatchTimes;
+	TArray<double> StageTimes[(int32)ECameraStage::Num];
+	uint64 ProbeTotals[(int32)ECameraProbeTier::Num] = {};
+	uint64 FallbackTotal = 0;
+	FrameTimes.Reserve(Settings.NumFrames);
+
+	const double MsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+
+	for (int32 Frame = 0; Frame < Settings.WarmupFrames + Settings.NumFrames; ++Frame)
+	{
+		const double FrameMs = TickFrame(World, Pawns, Stream, Settings);
+		if (Frame < Settings.WarmupFrames) { continue; }
+
+		FrameTimes.Add(FrameMs);
+		if (ArmSubsystem && ArmSubsystem->IsBatching())
+		{
+			BatchTimes.Add(ArmSubsystem->GetLastUpdateSeconds() * 1000.0);
+		}
+		for (int32 StageIndex = 0; StageIndex < (int32)ECameraStage::Num; ++StageIndex)
+		{
+			StageTimes[StageIndex].Add(FCameraStageTimings::Get((ECameraStage)StageIndex) * MsPerCycle);
+		}
+		for (int32 TierIndex = 0; TierIndex < (int32)ECameraProbeTier::Num; ++TierIndex)
+		{
+			ProbeTotals[TierIndex] += FCameraProbeCounters::Get((ECameraProbeTier)TierIndex);
+		}
+		FallbackTotal += FCameraProbeCounters::GetFallbacks();
+	}
+
+	UE_LOG(LogCameraStress, Display, TEXT("Results over %d frames (%d warmup frames skipped):"), FrameTimes.Num(), Settings.WarmupFrames);
+	CameraStress::LogDistribution(TEXT("Frame"), FrameTimes);
+	if (BatchTimes.Num() > 0)
+	{
+		// Wall time of the batched update; with the pipeline this is less than the sum of the stages below
+		CameraStress::LogDistribution(TEXT("Batch"), BatchTimes);
+	}
+	for (int32 StageIndex = 0; StageIndex < (int32)ECameraStage::Num; ++StageIndex)
+	{
+		CameraStress::LogDistribution(FCameraStageTimings::GetStageName((ECameraStage)StageIndex), StageTimes[StageIndex]);
+	}
+
+	uint64 ProbeCount = 0;
+	for (uint64 TierTotal : ProbeTotals)
+	{
+		ProbeCount += TierTotal;
+	}
+	for (int32 TierIndex = 0; TierIndex < (int32)ECameraProbeTier::Num; ++TierIndex)
+	{
+		UE_LOG(LogCameraStress, Display, TEXT("%-12s %10.1f probes per frame   %5.1f%%"), FCameraProbeCounters::GetTierName((ECameraProbeTier)TierIndex),
+			(double)ProbeTotals[TierIndex] / FrameTimes.Num(), ProbeCount > 0 ? 100.0 * ProbeTotals[TierIndex] / ProbeCount : 0.0);
+	}
+	UE_LOG(LogCameraStress, Display, TEXT("%-12s %10.1f sweeps per frame   %5.1f%% of probes needed the exact sweep after all"), TEXT("Fallback"),
+		(double)FallbackTotal / FrameTimes.Num(), ProbeCount > 0 ? 100.0 * FallbackTotal / ProbeCount : 0.0);
+
+	if (ParallelUpdateVar)
+	{
+		ParallelUpdateVar->Set(0);
+	}
+
+	DestroyStressWorld(World);
+	return 0;
+}
+
+double UCameraStressCommandlet::TickFrame(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const
+{
+	DrivePawns(Pawns, Stream, Settings.DeltaTime);
+
+	FCameraStageTimings::Reset();
+	FCameraProbeCounters::Reset();
+	const double StartTime = FPlatformTime::Seconds();
+
+	World->Tick(LEVELTICK_All, Settings.DeltaTime);
+	++GFrameCounter;
+
+	return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+}
+
+void UCameraStressCommandlet::RunParallelScaling(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const
+{
+	UCameraArmSubsystem* ArmSubsystem = World->GetSubsystem<UCameraArmSubsystem>();
+	IConsoleVariable* ParallelUpdateVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Camera.ParallelUpdate"));
+	IConsoleVariable* ParallelWorkersVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Camera.ParallelWorkers"));
+	if (!ArmSubsystem || !ParallelUpdateVar || !ParallelWorkersVar)
+	{
+		UE_LOG(LogCameraStress, Error, TEXT("Parallel camera update isn't available"));
+		return;
+	}
+
+	ParallelUpdateVar->Set(Settings.UpdateMode > 0 ? Settings.UpdateMode : 1);
+
+	TArray<int32> WorkerCounts;
+	const int32 NumCores = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	for (int32 Workers = 1; Workers < NumCores; Workers *= 2)
+	{
+		WorkerCounts.Add(Workers);
+	}
+	WorkerCounts.Add(NumCores);
+
+	UE_LOG(LogCameraStress, Display, TEXT("Parallel scaling over %d arms, %d frames per worker count:"), ArmSubsystem->GetArms().Num(), Settings.NumFrames);
+
+	double SingleWorkerMs = 0.0;
+	for (int32 Workers : WorkerCounts)
+	{
+		ParallelWorkersVar->Set(Workers);
+
+		TArray<double> UpdateTimes;
+		for (int32 Frame = 0; Frame < Settings.WarmupFrames + Settings.NumFrames; ++Frame)
+		{
+			TickFrame(World, Pawns, Stream, Settings);
+			if (Frame >= Settings.WarmupFrames)
+			{
+				UpdateTimes.Add(ArmSubsystem->GetLastUpdateSeconds() * 1000.0);
+			}
+		}
+
+		const double MeanMs = CameraStress::GetMean(UpdateTimes);
+		if (Workers == 1) { SingleWorkerMs = MeanMs; }
+
+		UpdateTimes.Sort();
+		UE_LOG(LogCameraStress, Display, TEXT("%3d workers: mean %8.3f ms   p99 %8.3f ms   speedup %5.2fx"),
+			Workers, MeanMs, CameraStress::GetPercentile(UpdateTimes, .99), MeanMs > 0.0 ? SingleWorkerMs / MeanMs : 0.0);
+	}
+
+	ParallelUpdateVar->Set(0);
+}
+
+void UCameraStressCommandlet::RunPawnCost(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const
+{
+	if (Pawns.Num() == 0) { return; }
+
+	auto IsCameraComponent = [](const UActorComponent* Component)
+	{
+		return Component->IsA<UCameraSpringArm>() || Component->IsA<UCameraArmComponent>() || Component->IsA<UCameraComponent>();
+	};
+
+	// The object itself plus whatever it allocates, after the warmup has sized every buffer
+	for (int32 Frame = 0; Frame < Settings.WarmupFrames; ++Frame)
+	{
+		TickFrame(World, Pawns, Stream, Settings);
+	}
+
+	SIZE_T CameraBytes = 0;
+	for (const APawn* Pawn : Pawns)
+	{
+		for (UActorComponent* Component : Pawn->GetComponents())
+		{
+			if (IsCameraComponent(Component))
+			{
+				CameraBytes += Component->GetClass()->GetStructureSize() + Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+		}
+	}
+
+	auto MeasureFrames = [this, World, &Pawns, &Stream, &Settings]()
+	{
+		TArray<double> FrameTimes;
+		FrameTimes.Reserve(Settings.NumFrames);
+		for (int32 Frame = 0; Frame < Settings.NumFrames; ++Frame)
+		{
+			FrameTimes.Add(TickFrame(World, Pawns, Stream, Settings));
+		}
+		return CameraStress::GetMean(FrameTimes);
+	};
+
+	const double WithCameraMs = MeasureFrames();
+
+	// Stand in for a server: back to per component updates so the batch lets go of the arms, then nothing camera ticks
+	IConsoleVariable* ParallelUpdateVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Camera.ParallelUpdate"));
+	if (ParallelUpdateVar)
+	{
+		ParallelUpdateVar->Set(0);
+		TickFrame(World, Pawns, Stream, Settings);
+	}
+	for (APawn* Pawn : Pawns)
+	{
+		if (ACameraProjectCharacter* CameraCharacter = Cast<ACameraProjectCharacter>(Pawn))
+		{
+			CameraCharacter->StopRandomCameraChanges();
+		}
+		for (UActorComponent* Component : Pawn->GetComponents())
+		{
+			if (IsCameraComponent(Component))
+			{
+				Component->SetComponentTickEnabled(false);
+			}
+		}
+	}
+	for (int32 Frame = 0; Frame < Settings.WarmupFrames; ++Frame)
+	{
+		TickFrame(World, Pawns, Stream, Settings);
+	}
+
+	const double WithoutCameraMs = MeasureFrames();
+
+	UE_LOG(LogCameraStress, Display, TEXT("Camera components: %.0f B per pawn"), (double)CameraBytes / Pawns.Num());
+	UE_LOG(LogCameraStress, Display, TEXT("Frame time: %.3f ms with cameras, %.3f ms without, %.2f us per pawn"),
+		WithCameraMs, WithoutCameraMs, (WithCameraMs - WithoutCameraMs) * 1000.0 / Pawns.Num());
+}
+
+uint32 UCameraStressCommandlet::RunAllocationCheck(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const
+{
+#if CAMERA_STAGE_TIMINGS
+	// Caches, hit buffers and material instances are all filled in during the warmup
+	for (int32 Frame = 0; Frame < Settings.WarmupFrames; ++Frame)
+	{
+		TickFrame(World, Pawns, Stream, Settings);
+	}
+
+	FCameraAllocationTracker::Start();
+	for (int32 Frame = 0; Frame < Settings.NumFrames; ++Frame)
+	{
+		TickFrame(World, Pawns, Stream, Settings);
+	}
+	FCameraAllocationTracker::Stop();
+
+	for (int32 StageIndex = 0; StageIndex < (int32)ECameraStage::Num; ++StageIndex)
+	{
+		UE_LOG(LogCameraStress, Display, TEXT("%-12s %8u allocations"), FCameraStageTimings::GetStageName((ECameraStage)StageIndex), FCameraAllocationTracker::GetCount((ECameraStage)StageIndex));
+	}
+	UE_LOG(LogCameraStress, Display, TEXT("%-12s %8u allocations outside every stage"), TEXT("Frame"), FCameraAllocationTracker::GetUnstagedCount());
+
+	const uint32 NumAllocations = FCameraAllocationTracker::GetTotalCount();
+
+	if (NumAllocations > 0)
+	{
+		UE_LOG(LogCameraStress, Error, TEXT("Steady-state camera update made %u heap allocations over %d frames"), NumAllocations, Settings.NumFrames);
+	}
+	else
+	{
+		UE_LOG(LogCameraStress, Display, TEXT("Steady-state camera update made no heap allocations over %d frames"), Settings.NumFrames);
+	}
+	return NumAllocations;
+#else
+	UE_LOG(LogCameraStress, Warning, TEXT("Allocation tracking is compiled out of this build"));
+	return 0;
+#endif
+}
+
+UWorld* UCameraStressCommandlet::CreateStressWorld() const
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CameraStressWorld"));
+	if (!World) { return nullptr; }
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+
+	return World;
+}
+
+void UCameraStressCommandlet::DestroyStressWorld(UWorld* World) const
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+float UCameraStressCommandlet::GetFieldExtent(const FStressSettings& Settings)
+{
+	// Give each pawn about 10m x 10m to move around in
+	return FMath::Sqrt((float)Settings.NumPawns) * 500.f;
+}
+
+void UCameraStressCommandlet::BuildObstacleField(UWorld* World, FRandomStream& Stream, const FStressSettings& Settings) const
+{
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!CubeMesh)
+	{
+		UE_LOG(LogCameraStress, Warning, TEXT("Couldn't load the engine cube, running without obstacles"));
+		return;
+	}
+
+	const float Extent = GetFieldExtent(Settings);
+
+	auto SpawnBox = [World, CubeMesh](const FVector& Location, const FRotator& Rotation, const FVector& Scale)
+	{
+		AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Location, Rotation);
+		UStaticMeshComponent* BoxMesh = Box->GetStaticMeshComponent();
+		BoxMesh->SetMobility(EComponentMobility::Movable);
+		BoxMesh->SetStaticMesh(CubeMesh);
+		BoxMesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Box->SetActorScale3D(Scale);
+	};
+
+	// The engine cube is 1m across, so scale is in metres and the floor covers the whole field
+	SpawnBox(FVector(0.f, 0.f, -50.f), FRotator::ZeroRotator, FVector(Extent / 50.f, Extent / 50.f, 1.f));
+
+	for (int32 Index = 0; Index < Settings.NumObstacles; ++Index)
+	{
+		const FVector Scale(Stream.FRandRange(.5f, 6.f), Stream.FRandRange(.5f, 6.f), Stream.FRandRange(1.f, 8.f));
+		const FVector Location(Stream.FRandRange(-Extent, Extent), Stream.FRandRange(-Extent, Extent), Scale.Z * 50.f);
+		SpawnBox(Location, FRotator(0.f, Stream.FRandRange(0.f, 360.f), 0.f), Scale);
+	}
+}
+
+void UCameraStressCommandlet::SpawnPawns(UWorld* World, FRandomStream& Stream, const FStressSettings& Settings, TArray<APawn*>& OutPawns) const
+{
+	const float Extent = GetFieldExtent(Settings);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	OutPawns.Reserve(Settings.NumPawns);
+	for (int32 Index = 0; Index < Settings.NumPawns; ++Index)
+	{
+		const FVector Location(Stream.FRandRange(-Extent, Extent), Stream.FRandRange(-Extent, Extent), 200.f);
+		const FRotator Rotation(0.f, Stream.FRandRange(0.f, 360.f), 0.f);
+
+		const bool bUseArmComponent = Stream.FRand() < Settings.ArmComponentRatio;
+		UClass* PawnClass = bUseArmComponent ? ACameraCharacter::StaticClass() : ACameraProjectCharacter::StaticClass();
+
+		APawn* Pawn = World->SpawnActor<APawn>(PawnClass, Location, Rotation, SpawnParams);
+		if (!Pawn) { continue; }
+
+		AAIController* Controller = World->SpawnActor<AAIController>(Location, Rotation);
+		Controller->Possess(Pawn);
+
+		if (ACameraProjectCharacter* CameraCharacter = Cast<ACameraProjectCharacter>(Pawn))
+		{
+			// Stagger the first change so every pawn doesn't start a transition on the same frame
+			CameraCharacter->StartRandomCameraChanges(Settings.Seed + Index, Settings.ChangeInterval * Stream.FRandRange(.5f, 1.5f));
+		}
+
+		OutPawns.Add(Pawn);
+	}
+}
+
+void UCameraStressCommandlet::DrivePawns(const TArray<APawn*>& Pawns, FRandomStream& Stream, float DeltaTime) const
+{
+	for (APawn* Pawn : Pawns)
+	{
+		AController* Controller = Pawn->GetController();
+		if (!Controller) { continue; }
+
+		// Turn the view a little every frame so the arms keep sweeping new space, and walk the way we face
+		FRotator ControlRotation = Controller->GetControlRotation();
+		ControlRotation.Yaw += Stream.FRandRange(-90.f, 90.f) * DeltaTime;
+		ControlRotation.Pitch = FMath::Clamp(ControlRotation.Pitch + Stream.FRandRange(-30.f, 30.f) * DeltaTime, -45.f, 30.f);
+		Controller->SetControlRotation(ControlRotation);
+
+		Pawn->AddMovementInput(FRotator(0.f, ControlRotation.Yaw, 0.f).Vector(), 1.f);
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CameraStressCommandlet.generated.h"
+
+class UWorld;
+class APawn;
+
+/**
+ * Headless load generator for the camera system. Builds a procedural obstacle field, spawns camera pawns that
+ * wander through it with seeded random camera transitions and shoulder swaps, ticks the world for a fixed
+ * number of frames and reports frame time percentiles along with the time spent in each camera stage and how
+ * often each collision probe tier was used.
+ *
+ * UE4Editor-Cmd CameraProject -run=CameraStress -nullrhi -Pawns=500 -Frames=1000 -Seed=1
+ *
+ * Optional: -Obstacles=N -ArmComponentRatio=0..1 -DeltaTime=Seconds -ChangeInterval=Seconds -WarmupFrames=N
+ *
+ * -UpdateMode=N sets Camera.ParallelUpdate for the run (0 per component, 1 ParallelFor, 2 task pipeline); the
+ * batched modes also report the wall time of the whole camera update.
+ *
+ * -ParallelScaling times the batched spring arm update (UpdateMode, or 1 if unset) at 1, 2, 4... workers
+ * up to the core count and reports the speedup of each over a single worker.
+ *
+ * -MeasurePawnCost measures what the camera costs each pawn, which is what a dedicated server saves by leaving it out:
+ * the memory of each pawn's camera components, and the frame time with and without them ticking.
+ *
+ * -CheckAllocations counts heap allocations made by the camera update after the warmup frames, by stage and outside
+ * them, and returns a non-zero exit code if there are any, so the steady-state camera update can be kept allocation-free in CI.
+ */
+UCLASS()
+class UCameraStressCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCameraStressCommandlet();
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+private:
+	struct FStressSettings
+	{
+		int32 NumPawns = 100;
+		int32 NumFrames = 1000;
+		int32 WarmupFrames = 30;
+		int32 NumObstacles = 0;
+		int32 Seed = 1;
+		float ArmComponentRatio = 0.f;
+		float DeltaTime = 1.f / 60.f;
+		float ChangeInterval = 3.f;
+		int32 UpdateMode = 0;
+		bool bParallelScaling = false;
+		bool bCheckAllocations = false;
+		bool bMeasurePawnCost = false;
+
+		void Parse(const FString& Params);
+	};
+
+	UWorld* CreateStressWorld() const;
+	void DestroyStressWorld(UWorld* World) const;
+
+	/** Scatters boxes of random size over the area the pawns wander in, on top of a floor */
+	void BuildObstacleField(UWorld* World, FRandomStream& Stream, const FStressSettings& Settings) const;
+
+	void SpawnPawns(UWorld* World, FRandomStream& Stream, const FStressSettings& Settings, TArray<APawn*>& OutPawns) const;
+
+	/** Feeds each pawn seeded movement and look input for the next frame */
+	void DrivePawns(const TArray<APawn*>& Pawns, FRandomStream& Stream, float DeltaTime) const;
+
+	/** Drives the pawns and ticks the world once, returning how long the tick took in milliseconds */
+	double TickFrame(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const;
+
+	/** Times the batched arm update at increasing worker counts and logs the speedup over a single worker */
+	void RunParallelScaling(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const;
+
+	/** Logs the camera components' memory per pawn and the frame time they add per pawn */
+	void RunPawnCost(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const;
+
+	/** Ticks past the warmup with camera allocations counted, returning the number of allocations found */
+	uint32 RunAllocationCheck(UWorld* World, const TArray<APawn*>& Pawns, FRandomStream& Stream, const FStressSettings& Settings) const;
+
+	/** Half the width of the square area pawns and obstacles are placed in */
+	static float GetFieldExtent(const FStressSettings& Settings);
+};
@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "AIController.h"
+#include "HAL/IConsoleManager.h"
+#include "CameraProjectCharacter.h"
+#include "CameraStats.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && CAMERA_STAGE_TIMINGS
+
+namespace CameraAllocationTests
+{
+	static const int32 NumPawns = 16;
+	static const int32 WarmupFrames = 30;
+	static const int32 CheckedFrames = 60;
+	static const float DeltaTime = 1.f / 60.f;
+
+	/** Makes one heap allocation that the counting proxy sees */
+	static void Allocate()
+	{
+		void* Memory = FMemory::Malloc(64);
+		FMemory::Free(Memory);
+	}
+
+	static UWorld* CreateWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CameraAllocationTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		const FURL URL;
+		World->InitializeActorsForPlay(URL);
+		World->BeginPlay();
+		return World;
+	}
+
+	static void DestroyWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	/** A floor and a ring of boxes around the pawns, so the arms have something to collide with */
+	static void BuildObstacles(UWorld* World)
+	{
+		UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (!CubeMesh) { return; }
+
+		auto SpawnBox = [World, CubeMesh](const FVector& Location, const FVector& Scale)
+		{
+			AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator);
+			UStaticMeshComponent* BoxMesh = Box->GetStaticMeshComponent();
+			BoxMesh->SetMobility(EComponentMobility::Movable);
+			BoxMesh->SetStaticMesh(CubeMesh);
+			BoxMesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+			Box->SetActorScale3D(Scale);
+		};
+
+		SpawnBox(FVector(0.f, 0.f, -50.f), FVector(40.f, 40.f, 1.f));
+		for (int32 Index = 0; Index < 12; ++Index)
+		{
+			const FVector Direction = FRotator(0.f, Index * 30.f, 0.f).Vector();
+			SpawnBox(Direction * 800.f + FVector(0.f, 0.f, 200.f), FVector(2.f, 2.f, 4.f));
+		}
+	}
+
+	static void SpawnPawns(UWorld* World, TArray<APawn*>& OutPawns)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+		for (int32 Index = 0; Index < NumPawns; ++Index)
+		{
+			const FVector Location = FRotator(0.f, Index * 360.f / NumPawns, 0.f).Vector() * 400.f + FVector(0.f, 0.f, 200.f);
+			APawn* Pawn = World->SpawnActor<ACameraProjectCharacter>(Location, FRotator::ZeroRotator, SpawnParams);
+			if (!Pawn) { continue; }
+
+			World->SpawnActor<AAIController>(Location, FRotator::ZeroRotator)->Possess(Pawn);
+			OutPawns.Add(Pawn);
+		}
+	}
+
+	static void TickFrame(UWorld* World, const TArray<APawn*>& Pawns)
+	{
+		// Keep the views turning so the arms sweep new space every frame
+		for (APawn* Pawn : Pawns)
+		{
+			if (AController* Controller = Pawn->GetController())
+			{
+				FRotator ControlRotation = Controller->GetControlRotation();
+				ControlRotation.Yaw += 45.f * DeltaTime;
+				Controller->SetControlRotation(ControlRotation);
+				Pawn->AddMovementInput(FRotator(0.f, ControlRotation.Yaw, 0.f).Vector(), 1.f);
+			}
+		}
+
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCameraAllocationTrackerTest, "CameraProject.Camera.AllocationTracker",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FCameraAllocationTrackerTest::RunTest(const FString& Parameters)
+{
+	using namespace CameraAllocationTests;
+
+	FCameraAllocationTracker::Start();
+
+	Allocate();
+	TestEqual(TEXT("Allocations outside a camera frame aren't counted"), FCameraAllocationTracker::GetTotalCount(), 0u);
+
+	{
+		CAMERA_FRAME_SCOPE();
+		Allocate();
+		{
+			CAMERA_STAGE_SCOPE(Gather);
+			Allocate();
+		}
+	}
+	TestEqual(TEXT("Allocations in a stage are charged to it"), FCameraAllocationTracker::GetCount(ECameraStage::Gather), 1u);
+	TestEqual(TEXT("Allocations in a frame outside every stage are counted on their own"), FCameraAllocationTracker::GetUnstagedCount(), 1u);
+
+	FCameraAllocationTracker::Stop();
+
+	{
+		CAMERA_FRAME_SCOPE();
+		Allocate();
+	}
+	TestEqual(TEXT("Nothing is counted once tracking stops"), FCameraAllocationTracker::GetTotalCount(), 2u);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCameraSteadyStateAllocationTest, "CameraProject.Camera.SteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FCameraSteadyStateAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace CameraAllocationTests;
+
+	IConsoleVariable* ParallelUpdateVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Camera.ParallelUpdate"));
+	if (!TestNotNull(TEXT("Camera.ParallelUpdate"), ParallelUpdateVar)) { return false; }
+
+	const int32 OriginalMode = ParallelUpdateVar->GetInt();
+
+	UWorld* World = CreateWorld();
+	BuildObstacles(World);
+
+	TArray<APawn*> Pawns;
+	SpawnPawns(World, Pawns);
+	TestEqual(TEXT("Spawned pawns"), Pawns.Num(), NumPawns);
+
+	// Per component, ParallelFor and the task pipeline each have their own buffers to fill during the warmup
+	for (int32 UpdateMode = 0; UpdateMode <= 2; ++UpdateMode)
+	{
+		ParallelUpdateVar->Set(UpdateMode);
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			TickFrame(World, Pawns);
+		}
+
+		FCameraAllocationTracker::Start();
+		for (int32 Frame = 0; Frame < CheckedFrames; ++Frame)
+		{
+			TickFrame(World, Pawns);
+		}
+		FCameraAllocationTracker::Stop();
+
+		for (int32 StageIndex = 0; StageIndex < (int32)ECameraStage::Num; ++StageIndex)
+		{
+			TestEqual(FString::Printf(TEXT("Mode %d, %s allocations"), UpdateMode, FCameraStageTimings::GetStageName((ECameraStage)StageIndex)),
+				FCameraAllocationTracker::GetCount((ECameraStage)StageIndex), 0u);
+		}
+		TestEqual(FString::Printf(TEXT("Mode %d, allocations outside every stage"), UpdateMode), FCameraAllocationTracker::GetUnstagedCount(), 0u);
+	}
+
+	ParallelUpdateVar->Set(OriginalMode);
+	DestroyWorld(World);
+	return true;
+}
+
+#endif
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/CollisionProfile.h"
+#include "Components/StaticMeshComponent.h"
+#include "CameraProject.h"
+#include "CameraProjectCharacter.h"
+#include "CameraCharacter/CameraSpringArm.h"
+#include "CameraCharacter/CameraViewValidation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CameraViewValidationTests
+{
+	static const float DeltaTime = 1.f / 60.f;
+
+	/** Frames ticked after submitting, covering the check and the async traces finishing the frame after */
+	static const int32 SettleFrames = 3;
+
+	static UWorld* CreateWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("CameraViewValidationTestWorld"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		const FURL URL;
+		World->InitializeActorsForPlay(URL);
+		World->BeginPlay();
+		return World;
+	}
+
+	static void DestroyWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	static ACameraProjectCharacter* SpawnCharacter(UWorld* World, const FVector& Location)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		return World->SpawnActor<ACameraProjectCharacter>(Location, FRotator::ZeroRotator, SpawnParams);
+	}
+
+	static bool SpawnWall(UWorld* World, const FVector& Location)
+	{
+		UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (!CubeMesh) { return false; }
+
+		AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(Location, FRotator::ZeroRotator);
+		UStaticMeshComponent* WallMesh = Wall->GetStaticMeshComponent();
+		WallMesh->SetMobility(EComponentMobility::Movable);
+		WallMesh->SetStaticMesh(CubeMesh);
+		WallMesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Wall->SetActorScale3D(FVector(0.2f, 4.f, 4.f));
+		return true;
+	}
+}
+
+/**
+ * Validates reported views the way a dedicated server does. Run with ServerContext it goes through a real dedicated
+ * server, where the characters have no camera boom; elsewhere the booms exist but validation must not look at them.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCameraViewValidationServerTest, "CameraProject.Camera.ViewValidationServer",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::ProductFilter)
+
+bool FCameraViewValidationServerTest::RunTest(const FString& Parameters)
+{
+	using namespace CameraViewValidationTests;
+
+	UWorld* World = CreateWorld();
+
+	UCameraViewValidationSubsystem* Validation = World->GetSubsystem<UCameraViewValidationSubsystem>();
+	ACameraProjectCharacter* InReach = SpawnCharacter(World, FVector(0.f, 0.f, 200.f));
+	ACameraProjectCharacter* OutOfReach = SpawnCharacter(World, FVector(0.f, 1000.f, 200.f));
+	ACameraProjectCharacter* Occluded = SpawnCharacter(World, FVector(0.f, 2000.f, 200.f));
+	if (!TestNotNull(TEXT("View validation"), Validation) || !InReach || !OutOfReach || !Occluded)
+	{
+		DestroyWorld(World);
+		return false;
+	}
+
+	if (!ShouldCreateCameraComponents())
+	{
+		TestNull(TEXT("Camera boom on a dedicated server"), InReach->FindComponentByClass<UCameraSpringArm>());
+	}
+
+	const FCameraViewRig OccludedRig = Occluded->GetCameraViewRig();
+	if (!SpawnWall(World, OccludedRig.ArmOrigin - FVector(150.f, 0.f, 0.f)))
+	{
+		AddError(TEXT("Couldn't load the cube mesh for the wall"));
+		DestroyWorld(World);
+		return false;
+	}
+
+	TMap<APawn*, ECameraViewViolation> Violations;
+	const FDelegateHandle ViolationHandle = Validation->OnViolation.AddLambda([&Violations](APawn* Pawn, ECameraViewViolation Violation, const FVector&)
+	{
+		Violations.Add(Pawn, Violation);
+	});
+
+	// Behind each character at the default arm length; the far one well past its rig's reach, the occluded one behind the wall
+	const FCameraViewRig InReachRig = InReach->GetCameraViewRig();
+	Validation->SubmitClaim(InReach, InReachRig, InReachRig.ArmOrigin + FVector(-200.f, 60.f, 20.f));
+
+	const FCameraViewRig OutOfReachRig = OutOfReach->GetCameraViewRig();
+	Validation->SubmitClaim(OutOfReach, OutOfReachRig, OutOfReachRig.ArmOrigin - FVector(OutOfReachRig.MaxReach * 2.f, 0.f, 0.f));
+
+	Validation->SubmitClaim(Occluded, OccludedRig, OccludedRig.ArmOrigin - FVector(300.f, 0.f, 0.f));
+
+	for (int32 Frame = 0; Frame < SettleFrames; ++Frame)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+		++GFrameCounter;
+	}
+
+	TestFalse(TEXT("Claim within reach is accepted"), Violations.Contains(InReach));
+	const ECameraViewViolation* OutOfReachViolation = Violations.Find(OutOfReach);
+	TestTrue(TEXT("Claim past the rig's reach is out of reach"), OutOfReachViolation && *OutOfReachViolation == ECameraViewViolation::OutOfReach);
+	const ECameraViewViolation* OccludedViolation = Violations.Find(Occluded);
+	TestTrue(TEXT("Claim behind a wall is occluded"), OccludedViolation && *OccludedViolation == ECameraViewViolation::Occluded);
+
+	Validation->OnViolation.Remove(ViolationHandle);
+	DestroyWorld(World);
+	return true;
+}
+
+#endif